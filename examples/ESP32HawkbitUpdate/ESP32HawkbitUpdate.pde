@@ -96,6 +96,12 @@ void setup() {
   configDataDocument["version"] = VERSION;
   serializeJson(configDataDocument, configData);
   hawkbit.setConfigData(configData);
+  // Send all requests of a poll cycle over one connection
+  hawkbit.setKeepAlive(true);
+  // Overlap flash writes with the download of the next block
+  hawkbit.setDownloadPipeline(true);
+  // Report the download progress to the server
+  hawkbit.setProgressFeedback(true);
   hawkbit.begin(client);
 }
 
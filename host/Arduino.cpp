@@ -0,0 +1,144 @@
+/**
+
+   @file Arduino.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include <Arduino.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+HardwareSerial Serial;
+
+static unsigned long long monotonicMicros() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (unsigned long long)now.tv_sec * 1000000ULL + now.tv_nsec / 1000;
+}
+
+/* Like on the devices the counters start at boot and wrap around at 32 bit */
+static const unsigned long long bootMicros = monotonicMicros();
+
+unsigned long millis() {
+  return (uint32_t)((monotonicMicros() - bootMicros) / 1000ULL);
+}
+
+unsigned long micros() {
+  return (uint32_t)(monotonicMicros() - bootMicros);
+}
+
+void delay(unsigned long ms) {
+  usleep(ms * 1000UL);
+}
+
+void yield() {
+  sched_yield();
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+  size_t written = 0;
+  while (written < size && this->write(buffer[written]) == 1) {
+    written++;
+  }
+  return written;
+}
+
+size_t Print::print(long value) {
+  char digits[24];
+  snprintf(digits, sizeof(digits), "%ld", value);
+  return this->write(digits);
+}
+
+/* Formats into a small stack buffer and only allocates for longer output,
+   the same as the ESP32 core */
+size_t Print::printf(const char *format, ...) {
+  char buffer[64];
+  char *text = buffer;
+  va_list args;
+  int length;
+  size_t written;
+  va_start(args, format);
+  length = vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+  if (length < 0) {
+    return 0;
+  }
+  if ((size_t)length >= sizeof(buffer)) {
+    text = (char *)malloc(length + 1);
+    if (text == NULL) {
+      return 0;
+    }
+    va_start(args, format);
+    vsnprintf(text, length + 1, format, args);
+    va_end(args);
+  }
+  written = this->write((const uint8_t *)text, length);
+  if (text != buffer) {
+    free(text);
+  }
+  return written;
+}
+
+int Stream::timedRead() {
+  unsigned long start = millis();
+  int c;
+  do {
+    c = this->read();
+    if (c >= 0) {
+      return c;
+    }
+    yield();
+  } while (millis() - start < this->_timeout);
+  return -1;
+}
+
+size_t Stream::readBytes(char *buffer, size_t length) {
+  size_t count = 0;
+  int c;
+  while (count < length) {
+    c = this->timedRead();
+    if (c < 0) {
+      break;
+    }
+    buffer[count++] = (char)c;
+  }
+  return count;
+}
+
+String Stream::readStringUntil(char terminator) {
+  String result;
+  int c = this->timedRead();
+  while (c >= 0 && c != terminator) {
+    result += (char)c;
+    c = this->timedRead();
+  }
+  return result;
+}
+
+size_t HardwareSerial::write(uint8_t data) {
+  return fwrite(&data, 1, 1, stdout);
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size) {
+  return fwrite(buffer, 1, size, stdout);
+}
@@ -0,0 +1,183 @@
+/**
+
+   @file Arduino.h
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#ifndef ___HAWKBIT_HOST_ARDUINO_H___
+#define ___HAWKBIT_HOST_ARDUINO_H___
+
+/* Minimal Arduino core to build the library on a Linux host for tests and
+   benchmarks. It only has what the library itself uses */
+
+#include <ctype.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <string>
+
+#define F(text) (text)
+#define PROGMEM
+
+typedef uint8_t byte;
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+void yield(void);
+
+class String
+{
+  public:
+    String(const char *text = "") : _text(text != NULL ? text : "") {}
+
+    const char *c_str() const {
+      return this->_text.c_str();
+    }
+
+    unsigned int length() const {
+      return this->_text.length();
+    }
+
+    bool operator==(const String &other) const {
+      return this->_text == other._text;
+    }
+
+    String &operator+=(const String &other) {
+      this->_text += other._text;
+      return *this;
+    }
+
+    String &operator+=(char c) {
+      this->_text += c;
+      return *this;
+    }
+
+    friend String operator+(const String &left, const String &right) {
+      String result(left);
+      result += right;
+      return result;
+    }
+
+  private:
+    std::string _text;
+};
+
+class Print
+{
+  public:
+    virtual ~Print(void) {}
+
+    virtual size_t write(uint8_t data) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    virtual void flush() {}
+
+    size_t write(const char *text) {
+      return this->write((const uint8_t *)text, strlen(text));
+    }
+
+    size_t write(const char *buffer, size_t size) {
+      return this->write((const uint8_t *)buffer, size);
+    }
+
+    size_t print(const char *text) {
+      return this->write(text);
+    }
+
+    size_t print(const String &text) {
+      return this->write(text.c_str());
+    }
+
+    size_t print(long value);
+
+    size_t println(const char *text = "") {
+      return this->print(text) + this->write("\r\n");
+    }
+
+    size_t println(const String &text) {
+      return this->print(text) + this->write("\r\n");
+    }
+
+    size_t println(long value) {
+      return this->print(value) + this->write("\r\n");
+    }
+
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print
+{
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long timeout) {
+      this->_timeout = timeout;
+    }
+
+    /* Waits up to the timeout for the requested bytes like the Arduino core */
+    virtual size_t readBytes(char *buffer, size_t length);
+
+    size_t readBytes(uint8_t *buffer, size_t length) {
+      return this->readBytes((char *)buffer, length);
+    }
+
+    /* Read up to the terminator, which is dropped, or the timeout */
+    String readStringUntil(char terminator);
+
+  protected:
+    unsigned long _timeout = 1000;
+
+    int timedRead();
+};
+
+/* Standard output */
+class HardwareSerial : public Stream
+{
+  public:
+    void begin(unsigned long baud) {}
+
+    using Print::write;
+    size_t write(uint8_t data) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+
+    int available() override {
+      return 0;
+    }
+
+    int read() override {
+      return -1;
+    }
+
+    int peek() override {
+      return -1;
+    }
+};
+
+extern HardwareSerial Serial;
+
+#endif /* ___HAWKBIT_HOST_ARDUINO_H___ */
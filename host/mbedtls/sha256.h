@@ -0,0 +1,63 @@
+/**
+
+   @file sha256.h
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#ifndef ___HAWKBIT_HOST_MBEDTLS_SHA256_H___
+#define ___HAWKBIT_HOST_MBEDTLS_SHA256_H___
+
+/* The part of the mbedTLS sha256 API used by HawkbitHash, on top of OpenSSL */
+
+#include <stddef.h>
+#include <openssl/evp.h>
+
+typedef struct {
+  EVP_MD_CTX *md;
+} mbedtls_sha256_context;
+
+static inline void mbedtls_sha256_init(mbedtls_sha256_context *ctx) {
+  ctx->md = NULL;
+}
+
+static inline void mbedtls_sha256_free(mbedtls_sha256_context *ctx) {
+  EVP_MD_CTX_free(ctx->md);
+  ctx->md = NULL;
+}
+
+static inline int mbedtls_sha256_starts(mbedtls_sha256_context *ctx, int is224) {
+  ctx->md = EVP_MD_CTX_new();
+  if (ctx->md == NULL) {
+    return -1;
+  }
+  return EVP_DigestInit_ex(ctx->md, is224 ? EVP_sha224() : EVP_sha256(), NULL) == 1 ? 0 : -1;
+}
+
+static inline int mbedtls_sha256_update(mbedtls_sha256_context *ctx, const unsigned char *input, size_t len) {
+  return EVP_DigestUpdate(ctx->md, input, len) == 1 ? 0 : -1;
+}
+
+static inline int mbedtls_sha256_finish(mbedtls_sha256_context *ctx, unsigned char *output) {
+  return EVP_DigestFinal_ex(ctx->md, output, NULL) == 1 ? 0 : -1;
+}
+
+#endif /* ___HAWKBIT_HOST_MBEDTLS_SHA256_H___ */
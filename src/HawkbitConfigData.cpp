@@ -0,0 +1,121 @@
+/**
+
+   @file HawkbitConfigData.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "HawkbitConfigData.h"
+#include "HawkbitHttp.h"
+#include "HawkbitJson.h"
+
+#define HB_CONFIGDATA_UNKNOWN 0xff
+
+/* FNV-1a, continued from hash */
+static uint32_t hashString(uint32_t hash, const char *text, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    hash = (hash ^ (uint8_t)text[i]) * 16777619UL;
+  }
+  return hash;
+}
+
+void HawkbitConfigDataTracker::begin(HawkbitStorage *storage) {
+  this->_storage = storage;
+  this->_valid = storage != NULL &&
+                 storage->load("configdata", &this->_acked, sizeof(this->_acked)) == sizeof(this->_acked) &&
+                 (this->_acked.count <= HB_CONFIGDATA_KEYS || this->_acked.count == HB_CONFIGDATA_UNKNOWN);
+}
+
+HB_CONFIGDATA_CHANGE HawkbitConfigDataTracker::compare(const char *scope, const char *data, size_t length) {
+  t_config_fingerprint print;
+  HawkbitConfigDataTracker::fingerprint(scope, data, length, &print);
+  if (!this->_valid || print.scope != this->_acked.scope) {
+    return HB_CONFIGDATA_REPLACED;
+  }
+  if (print.hash == this->_acked.hash) {
+    return HB_CONFIGDATA_UNCHANGED;
+  }
+  if (print.count == HB_CONFIGDATA_UNKNOWN || this->_acked.count == HB_CONFIGDATA_UNKNOWN) {
+    return HB_CONFIGDATA_REPLACED;
+  }
+  /* A merge cannot remove attributes */
+  for (uint8_t i = 0; i < this->_acked.count; i++) {
+    if (HawkbitConfigDataTracker::find(&print, this->_acked.keys[i]) < 0) {
+      return HB_CONFIGDATA_REPLACED;
+    }
+  }
+  return HB_CONFIGDATA_CHANGED;
+}
+
+bool HawkbitConfigDataTracker::changed(const char *key, const char *value) {
+  int8_t index;
+  if (!this->_valid || this->_acked.count == HB_CONFIGDATA_UNKNOWN) {
+    return true;
+  }
+  index = HawkbitConfigDataTracker::find(&this->_acked, hashString(2166136261UL, key, strlen(key)));
+  return index < 0 || this->_acked.values[index] != hashString(2166136261UL, value, strlen(value));
+}
+
+void HawkbitConfigDataTracker::acknowledge(const char *scope, const char *data, size_t length) {
+  HawkbitConfigDataTracker::fingerprint(scope, data, length, &this->_acked);
+  this->_valid = true;
+  if (this->_storage != NULL) {
+    this->_storage->save("configdata", &this->_acked, sizeof(this->_acked));
+  }
+}
+
+uint32_t HawkbitConfigDataTracker::hash(const char *scope, const char *data, size_t length) {
+  return hashString(hashString(2166136261UL, scope, strlen(scope)), data, length);
+}
+
+void HawkbitConfigDataTracker::fingerprint(const char *scope, const char *data, size_t length, t_config_fingerprint *print) {
+  HawkbitBufferStream stream;
+  HawkbitJsonExtractor extractor;
+  memset(print, 0, sizeof(*print));
+  print->scope = hashString(2166136261UL, scope, strlen(scope));
+  print->hash = hashString(print->scope, data, length);
+  stream.begin(data, length);
+  if (!extractor.parse(stream, HawkbitConfigDataTracker::onValue, print)) {
+    print->count = HB_CONFIGDATA_UNKNOWN;
+  }
+}
+
+void HawkbitConfigDataTracker::onValue(void *context, const char *path, const char *value) {
+  t_config_fingerprint *print = (t_config_fingerprint *)context;
+  /* Only flat objects with few attributes are tracked individually */
+  if (print->count == HB_CONFIGDATA_UNKNOWN || print->count >= HB_CONFIGDATA_KEYS ||
+      path[0] == '\0' || strchr(path, '.') != NULL || strchr(path, '[') != NULL) {
+    print->count = HB_CONFIGDATA_UNKNOWN;
+    return;
+  }
+  print->keys[print->count] = hashString(2166136261UL, path, strlen(path));
+  print->values[print->count] = hashString(2166136261UL, value, strlen(value));
+  print->count++;
+}
+
+int8_t HawkbitConfigDataTracker::find(const t_config_fingerprint *print, uint32_t key) {
+  for (uint8_t i = 0; i < print->count && i < HB_CONFIGDATA_KEYS; i++) {
+    if (print->keys[i] == key) {
+      return i;
+    }
+  }
+  return -1;
+}
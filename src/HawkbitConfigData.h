@@ -0,0 +1,88 @@
+/**
+
+   @file HawkbitConfigData.h
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#ifndef ___HAWKBIT_CONFIG_DATA_H___
+#define ___HAWKBIT_CONFIG_DATA_H___
+
+#include <Arduino.h>
+#include "HawkbitPlatform.h"
+
+/* Attributes whose state is remembered, with more a change is always sent
+   as full replacement */
+#ifndef HB_CONFIGDATA_KEYS
+#define HB_CONFIGDATA_KEYS 16
+#endif
+
+enum HB_CONFIGDATA_CHANGE {
+  HB_CONFIGDATA_UNCHANGED,
+  /* Attributes were added or changed, a merge of those is enough */
+  HB_CONFIGDATA_CHANGED,
+  /* Attributes were removed or the acknowledged state is unknown */
+  HB_CONFIGDATA_REPLACED
+};
+
+/* Hashes of the attributes of a config data object */
+typedef struct str_config_fingerprint {
+  /* Hash of the controller id the attributes were sent for */
+  uint32_t scope;
+  uint32_t hash;
+  /* Number of attributes, 0xff if they are not known individually */
+  uint8_t count;
+  uint32_t keys[HB_CONFIGDATA_KEYS];
+  uint32_t values[HB_CONFIGDATA_KEYS];
+} t_config_fingerprint;
+
+/* Fingerprint of the config data last acknowledged by the server. It is kept
+   in storage, so unchanged attributes are not uploaded again after a reboot
+   and changes are sent as merge of the changed attributes only */
+class HawkbitConfigDataTracker
+{
+  public:
+    void begin(HawkbitStorage *storage);
+
+    /* Compare the config data with the acknowledged state */
+    HB_CONFIGDATA_CHANGE compare(const char *scope, const char *data, size_t length);
+
+    /* Whether an attribute differs from the acknowledged state */
+    bool changed(const char *key, const char *value);
+
+    /* Remember the config data as acknowledged by the server */
+    void acknowledge(const char *scope, const char *data, size_t length);
+
+    /* Hash of the config data for a scope, the compact alternative to the
+       fingerprint when many scopes are tracked */
+    static uint32_t hash(const char *scope, const char *data, size_t length);
+
+  private:
+    HawkbitStorage *_storage = NULL;
+    bool _valid = false;
+    t_config_fingerprint _acked;
+
+    static void fingerprint(const char *scope, const char *data, size_t length, t_config_fingerprint *print);
+    static void onValue(void *context, const char *path, const char *value);
+    static int8_t find(const t_config_fingerprint *print, uint32_t key);
+};
+
+#endif /* ___HAWKBIT_CONFIG_DATA_H___ */
@@ -24,26 +24,51 @@
 */
 
 #include "HawkbitDdi.h"
-#include <WiFiClientSecure.h>
-#include <ArduinoJson.h>
-#include <Update.h>
-
-// Allocate JsonBuffer for biggest possible JSON document in DDI API
-// Use arduinojson.org/assistant to compute the capacity.
-const size_t capacity = JSON_ARRAY_SIZE(1) + 3 * JSON_ARRAY_SIZE(2) + JSON_ARRAY_SIZE(3) + JSON_ARRAY_SIZE(5) +
-                        24 * JSON_OBJECT_SIZE(1) + 8 * JSON_OBJECT_SIZE(2) + JSON_OBJECT_SIZE(3) +
-                        15 * JSON_OBJECT_SIZE(4) + JSON_OBJECT_SIZE(5) + 4970;
-static DynamicJsonDocument jsonBuffer(capacity);
-#define HEADERSIZE 1024
-static char headers[HEADERSIZE];
-
-typedef struct str_href {
-  char href_server[64];
-  int16_t href_port;
-  char href_url[512];
-} t_href;
-
-t_href href_param;
+#include "HawkbitJson.h"
+#include "HawkbitHash.h"
+#include "HawkbitLog.h"
+#include "HawkbitUrl.h"
+
+/* Layout of the controller state kept in storage for a warm start, the
+   version has to change with it */
+#define HB_SNAPSHOT_VERSION 2
+
+typedef struct str_hb_snapshot {
+  uint8_t version;
+  int actionId;
+  uint8_t executionStatus;
+  uint8_t executionResult;
+  uint8_t deploymentMode;
+  uint32_t updateSize;
+  char artifactMd5[33];
+  char artifactSha1[41];
+  char artifactSha256[65];
+  /* Wall clock time of the next poll in s, 0 if the clock was not set */
+  uint32_t nextPoll;
+  t_hb_poll_cache poll;
+  HawkbitLinkStore links;
+} t_hb_snapshot;
+
+/* Marks a valid t_hb_retained_state, changes with its layout */
+#define HB_RETAINED_MAGIC 0x48425201UL
+
+/* Context of encoding the changed config data attributes */
+typedef struct str_config_merge {
+  HawkbitDdi *ddi;
+  HawkbitJsonWriter *json;
+  bool first;
+} t_config_merge;
+
+/* Wall clock times before are taken as not set */
+#define HB_TIME_VALID 1546300800L
+
+/* Download state kept in storage to continue after a reboot */
+typedef struct str_download_progress {
+  int actionId;
+  uint32_t size;
+  uint32_t offset;
+  char sha1[41];
+} t_download_progress;
 
 const char *HawkbitDdi::securityTypeString[HB_SEC_MAX] = {
   [HB_SEC_CLIENTCERTIFICATE] = NULL,
@@ -58,7 +83,8 @@ const char *HawkbitDdi::executionStatusString[HB_EX_MAX] = {
   [HB_EX_CLOSED] = "closed", // If update has been finished in success or failure state
   [HB_EX_PROCEEDING] = "proceeding", // During download/check/installation/verification
   [HB_EX_SCHEDULED] = "scheduled", // If update will be scheduled
-  [HB_EX_RESUMED] = "resumed" // If update has been resumed after scheduling
+  [HB_EX_RESUMED] = "resumed", // If update has been resumed after scheduling
+  [HB_EX_DOWNLOADED] = "downloaded" // If update has been downloaded and waits for installation
 };
 
 const char *HawkbitDdi::executionResultString[HB_RES_MAX] = {
@@ -80,16 +106,37 @@ const char *HawkbitDdi::deploymentModeString[HB_DEPLOYMENT_MAX] = {
   [HB_DEPLOYMENT_FORCE] = "forced" // server requests immediate update
 };
 
-/* Static definitions for GET requests to use in printf functions */
-const char *HawkbitDdi::_getRequest = "GET %s HTTP/1.1\r\n";
-const char *HawkbitDdi::_getRootController = "GET /%s/controller/v1/%s HTTP/1.1\r\n";
-const char *HawkbitDdi::_putConfigData = "PUT /%s/controller/v1/%s/configData HTTP/1.1\r\n";
-const char *HawkbitDdi::_postDeploymentBaseFeedback = "POST /%s/controller/v1/%s/deploymentBase/%d/feedback HTTP/1.1\r\n";
+const char *HawkbitDdi::requestTypeString[HB_REQ_MAX] = {
+  [HB_REQ_NONE] = NULL,
+  [HB_REQ_POLL] = "poll",
+  [HB_REQ_CONFIGDATA] = "configData",
+  [HB_REQ_DEPLOYMENTBASE] = "deploymentBase",
+  [HB_REQ_CANCELACTION] = "cancelAction",
+  [HB_REQ_FEEDBACK] = "feedback",
+  [HB_REQ_DOWNLOAD] = "download"
+};
+
+/* Static definitions for request paths below the controller resource */
+const char *HawkbitDdi::_configDataPath = "/configData";
+const char *HawkbitDdi::_deploymentBaseFeedbackPath = "/deploymentBase/%d/feedback";
+
 
-static void splitHref(char *href_string);
+/* FNV-1a hash to recognise an unchanged response body */
+static uint32_t hashBody(const char *body, size_t length) {
+  uint32_t hash = 2166136261UL;
+  for (size_t i = 0; i < length; i++) {
+    hash = (hash ^ (uint8_t)body[i]) * 16777619UL;
+  }
+  return hash;
+}
 
 HawkbitDdi::HawkbitDdi() {
-  
+  this->_connectedServer[0] = '\0';
+  this->_configData[0] = '\0';
+  this->resetStats();
+  this->_artifactSha1[0] = '\0';
+  this->_artifactMd5[0] = '\0';
+  this->_artifactSha256[0] = '\0';
 }
 
 HawkbitDdi::HawkbitDdi(String serverName, uint16_t serverPort, String tenantId, String controllerId, String securityToken, HB_SECURITY_TYPE securityType) {
@@ -99,151 +146,859 @@ HawkbitDdi::HawkbitDdi(String serverName, uint16_t serverPort, String tenantId,
   this->_controllerId = controllerId;
   this->_securityToken = securityToken;
   this->_securityType = securityType;
+  this->_connectedServer[0] = '\0';
+  this->_configData[0] = '\0';
+  this->resetStats();
+  this->_artifactSha1[0] = '\0';
+  this->_artifactMd5[0] = '\0';
+  this->_artifactSha256[0] = '\0';
 }
 
 HawkbitDdi::~HawkbitDdi(void) {
 }
 
+#ifdef ARDUINO_ARCH_ESP32
 void HawkbitDdi::begin(WiFiClientSecure client) {
-  this->_client = client;
-  this->_currentExecutionStatus = HB_EX_CLOSED;
-  this->_currentExecutionResult = HB_RES_NONE;
-  this->pollController();
-  this->putConfigData(HB_CONFIGDATA_REPLACE);
+  this->_esp32Transport.setClient(client);
+  this->begin(&this->_esp32Transport, &this->_esp32Flash, &this->_esp32Platform, &this->_esp32Storage);
+}
+#endif
+
+void HawkbitDdi::begin(HawkbitTransport *transport, HawkbitFlashSink *flash, HawkbitPlatform *platform, HawkbitStorage *storage) {
+  this->_transport = transport;
+  this->_flash = flash;
+  if (this->_downloadPipeline) {
+    this->_pipelinedFlash.setSink(flash);
+    this->_flash = &this->_pipelinedFlash;
+  }
+  this->_platform = platform;
+  this->_storage = storage;
+  if (this->_log == NULL) {
+    this->_log = &platform->log();
+  }
+  this->_workState = HB_STATE_IDLE;
+  this->_controllerBasePath = "/" + this->_tenantId + "/controller/v1/";
+  this->_authorizationHeader = "";
+  switch (this->_securityType) {
+    case HB_SEC_GATEWAYTOKEN:
+    case HB_SEC_TARGETTOKEN:
+      this->_authorizationHeader = String("Authorization: ") + HawkbitDdi::securityTypeString[this->_securityType] + " " + this->_securityToken + "\r\n";
+      break;
+    default:
+      /* No Authorization Header needed */
+      break;
+  }
+  this->_feedbackQueue.begin(storage);
+  this->_configDataTracker.begin(storage);
+  this->_configDataRefresh = this->_platform->millis() + HB_CONFIGDATA_REFRESH;
+  this->_ownController.controllerId = this->_controllerId.c_str();
+  this->_ownController.sink = flash;
+  if (this->_controllerCount > 0) {
+    for (size_t i = 0; i < this->_controllerCount; i++) {
+      this->resetController(&this->_controllers[i]);
+    }
+    this->_active = &this->_controllers[0];
+    this->_activeIndex = 0;
+    this->activateController(0);
+  } else {
+    this->resetController(&this->_ownController);
+    /* Waking up from deep sleep only continues polling */
+    if (!this->resumeRetainedState()) {
+      this->restoreSnapshot();
+      /* Send the config data if it differs from what the server has */
+      this->_ownController.configDataPending = true;
+    }
+  }
   this->work();
 }
 
+/* Forget the action of a controller and poll it immediately */
+void HawkbitDdi::resetController(t_hb_controller *controller) {
+  /* The controllers of a gateway follow its schedule, so they poll right
+     after one another over one kept-alive connection */
+  const char *scheduleId = this->_controllerCount > 0 ? this->_controllerId.c_str() : controller->controllerId;
+  controller->actionId = -1;
+  controller->executionStatus = HB_EX_CLOSED;
+  controller->executionResult = HB_RES_NONE;
+  controller->jobSchedule = 0;
+  controller->scheduler.begin(scheduleId, this->_platform->millis());
+  memset(&controller->poll, 0, sizeof(controller->poll));
+  controller->configDataHash = 0;
+  controller->configDataRefresh = 0;
+  controller->configDataPending = this->_configData[0] != '\0';
+}
+
+bool HawkbitDdi::resumeRetainedState() {
+  t_hb_retained_state *state = this->_retainedState;
+  t_hb_snapshot snapshot;
+  time_t now = this->_platform->time();
+  unsigned long delay = 0;
+  if (state == NULL || state->magic != HB_RETAINED_MAGIC) {
+    return false;
+  }
+  /* Without a clock assume the device slept as long as it was allowed to.
+     The clock counts whole seconds, less than one more is treated as due, so
+     the device does not wake up again just to wait for the next second */
+  if (state->sleepStart > 0 && now >= HB_TIME_VALID && (time_t)state->sleepStart <= now &&
+      (unsigned long)(now - state->sleepStart + 1) * 1000UL < state->sleepTime) {
+    delay = state->sleepTime - (unsigned long)(now - state->sleepStart) * 1000UL;
+  }
+  this->_ownController.scheduler = state->scheduler;
+  this->_ownController.scheduler.resume(this->_platform->millis(), delay);
+  this->_ownController.poll.interval = state->pollInterval;
+  /* The snapshot is saved before getSleepTime() allows sleeping, so it holds
+     the validators and links of the last poll */
+  if (this->loadSnapshot(&snapshot) && snapshot.actionId <= 0) {
+    this->restorePollCache(&snapshot);
+  }
+  /* A reset without sleep must not use it again */
+  state->magic = 0;
+  HB_LOG_DEBUG(this->_log, "Resumed after sleep, next poll in %lu ms\r\n", delay);
+  return true;
+}
+
+unsigned long HawkbitDdi::getSleepTime() {
+  unsigned long now = this->_platform->millis();
+  unsigned long next = this->getNextPoll();
+  if (this->_workState != HB_STATE_IDLE || this->configDataWaiting() || this->_deploymentBasePending ||
+      this->_cancelActionPending || this->_snapshotPending || this->_installApproved ||
+      /* A downloaded update waits for the next poll */
+      (this->_active->actionId > 0 && this->_active->executionStatus != HB_EX_DOWNLOADED) ||
+      (!this->_feedbackQueue.isEmpty() && !this->_feedbackBlocked) || HawkbitScheduler::reached(now, next)) {
+    return 0;
+  }
+  return next - now;
+}
+
+unsigned long HawkbitDdi::prepareSleep(t_hb_retained_state *state) {
+  time_t now = this->_platform->time();
+  /* A downloaded update waiting for the approval does not survive deep sleep */
+  unsigned long sleepTime = this->_controllerCount > 0 || this->_imageReady ? 0 : this->getSleepTime();
+  if (sleepTime == 0) {
+    return 0;
+  }
+  this->closeConnection();
+  state->magic = HB_RETAINED_MAGIC;
+  state->pollInterval = this->_ownController.poll.interval;
+  state->sleepTime = sleepTime;
+  state->sleepStart = now >= HB_TIME_VALID ? now : 0;
+  state->scheduler = this->_ownController.scheduler;
+  return sleepTime;
+}
+
+/* Keep the state of the controller in storage, so a reboot, e.g. after an
+   update, can continue without fetching everything again */
+void HawkbitDdi::saveSnapshot() {
+  t_hb_snapshot snapshot;
+  time_t now = this->_platform->time();
+  this->_snapshotPending = false;
+  if (this->_storage == NULL || this->_controllerCount > 0) {
+    return;
+  }
+  memset((void *)&snapshot, 0, sizeof(snapshot));
+  snapshot.version = HB_SNAPSHOT_VERSION;
+  snapshot.actionId = this->_ownController.actionId;
+  snapshot.executionStatus = this->_ownController.executionStatus;
+  snapshot.executionResult = this->_ownController.executionResult;
+  snapshot.deploymentMode = this->_currentDeploymentMode;
+  snapshot.updateSize = this->_updateSize;
+  memcpy(snapshot.artifactMd5, this->_artifactMd5, sizeof(snapshot.artifactMd5));
+  memcpy(snapshot.artifactSha1, this->_artifactSha1, sizeof(snapshot.artifactSha1));
+  memcpy(snapshot.artifactSha256, this->_artifactSha256, sizeof(snapshot.artifactSha256));
+  if (now >= HB_TIME_VALID) {
+    snapshot.nextPoll = now + (int32_t)((uint32_t)this->_ownController.scheduler.getNextTime() - (uint32_t)this->_platform->millis()) / 1000;
+  }
+  snapshot.poll = this->_ownController.poll;
+  snapshot.links = this->_links;
+  this->_storage->save("controller", &snapshot, sizeof(snapshot));
+}
+
+bool HawkbitDdi::loadSnapshot(t_hb_snapshot *snapshot) {
+  return this->_storage != NULL &&
+         this->_storage->load("controller", snapshot, sizeof(*snapshot)) == sizeof(*snapshot) &&
+         snapshot->version == HB_SNAPSHOT_VERSION && snapshot->executionStatus < HB_EX_MAX &&
+         snapshot->executionResult < HB_RES_MAX && snapshot->deploymentMode < HB_DEPLOYMENT_MAX;
+}
+
+/* Validators and links of the last poll, so the next one can be answered
+   with 304 Not Modified */
+void HawkbitDdi::restorePollCache(const t_hb_snapshot *snapshot) {
+  t_hb_poll_cache *poll = &this->_ownController.poll;
+  *poll = snapshot->poll;
+  poll->etag[sizeof(poll->etag) - 1] = '\0';
+  this->_links = snapshot->links;
+  this->_linksController = &this->_ownController;
+}
+
+void HawkbitDdi::restoreSnapshot() {
+  t_hb_snapshot snapshot;
+  time_t now = this->_platform->time();
+  unsigned long interval;
+  if (!this->loadSnapshot(&snapshot)) {
+    return;
+  }
+  this->_ownController.actionId = snapshot.actionId;
+  this->_ownController.executionStatus = (HB_EXECUTION_STATUS)snapshot.executionStatus;
+  this->_ownController.executionResult = (HB_EXECUTION_RESULT)snapshot.executionResult;
+  this->_ownController.jobSchedule = this->_platform->millis();
+  /* A closed action only waits for its feedback, which is queued on its own */
+  if (this->_ownController.executionStatus == HB_EX_CLOSED) {
+    this->_ownController.actionId = 0;
+  }
+  this->_currentDeploymentMode = (HB_DEPLOYMENT_MODE)snapshot.deploymentMode;
+  this->_updateSize = snapshot.updateSize;
+  memcpy(this->_artifactMd5, snapshot.artifactMd5, sizeof(this->_artifactMd5));
+  memcpy(this->_artifactSha1, snapshot.artifactSha1, sizeof(this->_artifactSha1));
+  memcpy(this->_artifactSha256, snapshot.artifactSha256, sizeof(this->_artifactSha256));
+  this->_artifactMd5[sizeof(this->_artifactMd5) - 1] = '\0';
+  this->_artifactSha1[sizeof(this->_artifactSha1) - 1] = '\0';
+  this->_artifactSha256[sizeof(this->_artifactSha256) - 1] = '\0';
+  this->restorePollCache(&snapshot);
+  /* Keep the poll schedule if the clock tells how long the reboot took */
+  interval = snapshot.poll.interval > 0 ? snapshot.poll.interval : HB_POLL_DEFAULT_INTERVAL;
+  if (snapshot.nextPoll > 0 && now >= HB_TIME_VALID && (time_t)snapshot.nextPoll > now &&
+      ((time_t)snapshot.nextPoll - now) * 1000UL <= interval) {
+    this->_ownController.scheduler.resume(this->_platform->millis(), (snapshot.nextPoll - now) * 1000UL);
+  }
+  HB_LOG_INFO(this->_log, "Restored state, Action ID: %d, next poll: %lu\r\n", this->_ownController.actionId, this->_ownController.scheduler.getNextTime());
+}
+
+/* Make the requests for another controller of the gateway */
+void HawkbitDdi::activateController(uint16_t index) {
+  t_hb_controller *controller = &this->_controllers[index];
+  HawkbitFlashSink *sink = controller->sink != NULL ? controller->sink : this->_ownController.sink;
+  if (index != this->_activeIndex) {
+    /* The links belong to the previous controller, the validators of each
+       controller are kept and only used while its links are known */
+    for (uint8_t link = 0; link < HB_LINK_MAX; link++) {
+      this->_links.clear((HB_LINK)link);
+    }
+    this->_linksController = NULL;
+  }
+  this->_active = controller;
+  this->_activeIndex = index;
+  if (this->_downloadPipeline) {
+    this->_pipelinedFlash.setSink(sink);
+  } else {
+    this->_flash = sink;
+  }
+  HB_LOG_DEBUG(this->_log, "Controller: %s\r\n", controller->controllerId);
+}
+
+/* Find the next controller of the gateway with a request to make, in at
+   most one round through all of them */
+HB_REQUEST_TYPE HawkbitDdi::nextController() {
+  t_hb_controller *current = this->_active;
+  HB_REQUEST_TYPE type;
+  for (size_t i = 1; i <= this->_controllerCount; i++) {
+    uint16_t index = (this->_activeIndex + i) % this->_controllerCount;
+    this->_active = &this->_controllers[index];
+    type = this->nextRequest();
+    if (type != HB_REQ_NONE) {
+      this->_active = current;
+      this->activateController(index);
+      return type;
+    }
+  }
+  this->_active = current;
+  return HB_REQ_NONE;
+}
+
+/* Id of the controller a feedback was queued for */
+const char *HawkbitDdi::feedbackControllerId(const t_feedback *feedback) {
+  if (this->_controllerCount == 0) {
+    return this->_ownController.controllerId;
+  }
+  if (feedback->controller >= this->_controllerCount) {
+    return NULL;
+  }
+  return this->_controllers[feedback->controller].controllerId;
+}
+
+unsigned long HawkbitDdi::getNextPoll() {
+  unsigned long next = this->_active->scheduler.getNextTime();
+  for (size_t i = 0; i < this->_controllerCount; i++) {
+    unsigned long time = this->_controllers[i].scheduler.getNextTime();
+    if (!HawkbitScheduler::reached(time, next)) {
+      next = time;
+    }
+  }
+  return next;
+}
+
 int HawkbitDdi::work() {
-  int retStatus = -1;
-  if (millis() > this->_nextPoll) {
-    this->pollController();
-    if (strnlen(this->_putConfigDataHref, sizeof(this->_putConfigDataHref)) > 0) {
-      Serial.println("Need to put config data");
-      this->putConfigData();
+  unsigned long start = this->_platform->millis();
+  /* Advance the state machine until it has to wait or the budget is used up */
+  while (this->step(start)) {
+    if (this->budgetExceeded(start)) {
+      break;
+    }
+  }
+  return this->_workState;
+}
+
+bool HawkbitDdi::budgetExceeded(unsigned long start) {
+  return this->_platform->millis() - start >= this->_workBudget;
+}
+
+/* Do a bounded piece of work. Returns false if there is nothing to do until
+   the next call, e.g. while waiting for the server */
+bool HawkbitDdi::step(unsigned long start) {
+  HB_REQUEST_TYPE type;
+  switch (this->_workState) {
+    case HB_STATE_RESPONSE:
+      return this->receiveResponse();
+    case HB_STATE_BODY:
+      return this->receiveBody();
+    case HB_STATE_DOWNLOAD:
+      return this->receiveImage(start);
+    default:
+      break;
+  }
+  if (this->_snapshotPending) {
+    this->saveSnapshot();
+  }
+  type = this->nextRequest();
+  /* A gateway stays with a controller until its action is done or waits for
+     the installation */
+  if (type == HB_REQ_NONE && this->_controllerCount > 1 &&
+      (this->_active->actionId <= 0 || this->_active->executionStatus == HB_EX_CLOSED ||
+       this->_active->executionStatus == HB_EX_DOWNLOADED)) {
+    type = this->nextController();
+  }
+  if (type == HB_REQ_NONE) {
+    /* Do not keep an idle connection open until the next poll cycle */
+    if (!this->holdConnection()) {
+      this->closeConnection();
     }
-    if (strnlen(this->_getDeploymentBaseHref, sizeof(this->_getDeploymentBaseHref)) > 0 && this->_currentActionId <= 0) {
-      Serial.println("Need to get Deployment Base");
-      this->getDeploymentBase();
+    return false;
+  }
+  this->_requestRetried = false;
+  if (!this->startRequest(type)) {
+    this->handleResponse(0);
+    /* Do not try to connect again within the same call */
+    return false;
+  }
+  return true;
+}
+
+/* Pick the next request in the order of a poll cycle */
+HB_REQUEST_TYPE HawkbitDdi::nextRequest() {
+  if (this->_active->scheduler.isDue(this->_platform->millis())) {
+    return HB_REQ_POLL;
+  }
+  if (this->_active->configDataPending && !this->_feedbackBlocked) {
+    if (this->configDataNeeded()) {
+      HB_LOG_DEBUG(this->_log, "Need to put config data\r\n");
+      return HB_REQ_CONFIGDATA;
     }
-    if (strnlen(this->_getCancelActionHref, sizeof(this->_getCancelActionHref)) > 0) {
-      Serial.println("Need to get Cancel Action Information");
-      this->getCancelAction();
+    this->_active->configDataPending = false;
+  }
+  if (this->_deploymentBasePending) {
+    /* A gateway takes the next action once the downloaded update of another
+       controller is installed */
+    if (this->_imageReady && this->_active != this->_imageController) {
+      this->_deploymentBasePending = false;
+    /* A downloaded update waits for the server to allow the installation */
+    } else if (this->_active->actionId <= 0 || this->_active->executionStatus == HB_EX_DOWNLOADED) {
+      HB_LOG_DEBUG(this->_log, "Need to get Deployment Base\r\n");
+      return HB_REQ_DEPLOYMENTBASE;
     }
+    /* Already working on an action */
+    this->_deploymentBasePending = false;
+  }
+  if (this->_cancelActionPending) {
+    HB_LOG_DEBUG(this->_log, "Need to get Cancel Action Information\r\n");
+    return HB_REQ_CANCELACTION;
   }
-  if (this->_currentActionId > 0) {
-    switch (this->_currentExecutionStatus) {
+  if (this->_active->actionId > 0) {
+    switch (this->_active->executionStatus) {
       case HB_EX_PROCEEDING:
-        this->getAndInstallUpdateImage();
-        //this->_currentExecutionStatus = HB_EX_CLOSED;
-        //this->_currentExecutionResult = HB_RES_SUCCESS;
-        //this->_jobFeedbackChanged = true;
+      case HB_EX_CANCELED:
+      case HB_EX_CLOSED:
         break;
-      case HB_EX_SCHEDULED:
-        if (millis() > this->_jobSchedule) {
-          this->_currentExecutionStatus = HB_EX_PROCEEDING;
-          this->_currentExecutionResult = HB_RES_NONE;
+      case HB_EX_DOWNLOADED:
+        if (!this->_imageReady) {
+          /* The image did not survive a reboot, download it again */
+          this->_active->executionStatus = HB_EX_PROCEEDING;
+          this->_active->executionResult = HB_RES_NONE;
           this->_jobFeedbackChanged = true;
+        } else if (this->_currentDeploymentMode == HB_DEPLOYMENT_FORCE ||
+                   (this->_installApproved && this->_currentDeploymentMode == HB_DEPLOYMENT_ATTEMPT)) {
+          if (this->_controllerCount > 0 && this->_active != &this->_controllers[this->_activeIndex]) {
+            /* Found by nextController(), check with the server before installing */
+            return HB_REQ_POLL;
+          }
+          this->installImage();
         }
         break;
-      case HB_EX_CANCELED:
-      case HB_EX_CLOSED:
+      case HB_EX_SCHEDULED:
+        if (HawkbitScheduler::reached(this->_platform->millis(), this->_active->jobSchedule)) {
+          this->_active->executionStatus = HB_EX_PROCEEDING;
+          this->_active->executionResult = HB_RES_NONE;
+          this->_jobFeedbackChanged = true;
+        }
         break;
       default:
-        this->_currentExecutionStatus = HB_EX_PROCEEDING;
-        this->_currentExecutionResult = HB_RES_NONE;
+        this->_active->executionStatus = HB_EX_PROCEEDING;
+        this->_active->executionResult = HB_RES_NONE;
         this->_jobFeedbackChanged = true;
         break;
     }
     if (this->_jobFeedbackChanged) {
-      if (this->_currentExecutionStatus == HB_EX_CANCELED) {
-        this->postCancelFeedback();
-      } else {
-        this->postDeploymentBaseFeedback();
-      }
-      this->_jobFeedbackChanged = false;
+      this->queueFeedback();
     }
-    if (this->_currentExecutionStatus == HB_EX_CLOSED) {
-      this->_currentActionId = 0;
-      ESP.restart();
+  }
+  /* Pending feedback is sent once the server could be reached again */
+  if (!this->_feedbackQueue.isEmpty() && !this->_feedbackBlocked) {
+    return HB_REQ_FEEDBACK;
+  }
+  if (this->_active->actionId <= 0) {
+    return HB_REQ_NONE;
+  }
+  if (this->_active->executionStatus == HB_EX_CLOSED) {
+    /* Do not reboot before the server knows the action is closed */
+    if (this->_feedbackQueue.contains(this->_active->actionId)) {
+      return HB_REQ_NONE;
     }
+    this->_active->actionId = 0;
+    /* The attached device of a gateway installs the image itself */
+    if (this->_controllerCount == 0) {
+      this->saveSnapshot();
+      this->closeConnection();
+      this->_platform->restart();
+    }
+    return HB_REQ_NONE;
+  }
+  /* Wait before continuing an interrupted download */
+  if (this->_active->executionStatus == HB_EX_PROCEEDING &&
+      (!this->_flashStarted || HawkbitScheduler::reached(this->_platform->millis(), this->_active->jobSchedule))) {
+    return HB_REQ_DOWNLOAD;
   }
-  return retStatus;
+  return HB_REQ_NONE;
 }
 
-char * HawkbitDdi::createHeaders() {
-  return this->createHeaders(this->_serverName.c_str());
+/* Config data of any controller waits to be sent */
+bool HawkbitDdi::configDataWaiting() {
+  if (this->_feedbackBlocked) {
+    return false;
+  }
+  if (this->_controllerCount == 0) {
+    return this->_ownController.configDataPending;
+  }
+  for (size_t i = 0; i < this->_controllerCount; i++) {
+    if (this->_controllers[i].configDataPending) {
+      return true;
+    }
+  }
+  return false;
 }
 
-char * HawkbitDdi::createHeaders(const char *serverName) {
-  return this->createHeaders(serverName, "application/hal+json");
+/* Choose how to send the config data, false if the server has it already */
+bool HawkbitDdi::configDataNeeded() {
+  size_t length = strnlen(this->_configData, sizeof(this->_configData));
+  if (this->_controllerCount > 0) {
+    /* A gateway only keeps a hash per controller, a change replaces all */
+    if (this->_active->configDataHash == HawkbitConfigDataTracker::hash(this->_active->controllerId, this->_configData, length) &&
+        (!(this->_active->poll.links & (1 << HB_LINK_CONFIGDATA)) ||
+         !HawkbitScheduler::reached(this->_platform->millis(), this->_active->configDataRefresh))) {
+      HB_LOG_DEBUG(this->_log, "Config data unchanged\r\n");
+      return false;
+    }
+    this->_configDataMode = HB_CONFIGDATA_REPLACE;
+    return true;
+  }
+  switch (this->_configDataTracker.compare(this->_active->controllerId, this->_configData, length)) {
+    case HB_CONFIGDATA_UNCHANGED:
+      /* Replace it once in a while in case the server lost the attributes */
+      if (!(this->_active->poll.links & (1 << HB_LINK_CONFIGDATA)) ||
+          !HawkbitScheduler::reached(this->_platform->millis(), this->_configDataRefresh)) {
+        HB_LOG_DEBUG(this->_log, "Config data unchanged\r\n");
+        return false;
+      }
+      this->_configDataMode = HB_CONFIGDATA_REPLACE;
+      return true;
+    case HB_CONFIGDATA_CHANGED:
+      this->_configDataMode = HB_CONFIGDATA_MERGE;
+      return true;
+    default:
+      this->_configDataMode = HB_CONFIGDATA_REPLACE;
+      return true;
+  }
 }
 
-char * HawkbitDdi::createHeaders(const char *serverName, const char *acceptType) {
-  size_t strsize = 0;
-  snprintf(headers, HEADERSIZE, "Host: %s\r\n", serverName);
-  strsize = strnlen(headers, HEADERSIZE);
-  switch (this->_securityType) {
-    case HB_SEC_GATEWAYTOKEN:
-    case HB_SEC_TARGETTOKEN:
-      /* Add Authorization Header */
-      snprintf(headers + strsize, HEADERSIZE - strsize, "Authorization: %s %s\r\n", HawkbitDdi::securityTypeString[this->_securityType], this->_securityToken.c_str());
-      strsize = strnlen(headers, HEADERSIZE);
+/* Send the request, returns false if it could not be sent */
+bool HawkbitDdi::startRequest(HB_REQUEST_TYPE type) {
+  this->_requestType = type;
+  this->_bodyBuffered = false;
+  switch (type) {
+    case HB_REQ_POLL:
+      return this->pollController();
+    case HB_REQ_CONFIGDATA:
+      return this->putConfigData();
+    case HB_REQ_DEPLOYMENTBASE:
+      return this->getDeploymentBase();
+    case HB_REQ_CANCELACTION:
+      return this->getCancelAction();
+    case HB_REQ_FEEDBACK:
+      return this->postDeploymentBaseFeedback();
+    case HB_REQ_DOWNLOAD:
+      return this->getAndInstallUpdateImage();
+    default:
+      return false;
+  }
+}
+
+/* Handle the response of the current request, a status code of 0 means
+   that no response has been received */
+void HawkbitDdi::handleResponse(int statusCode) {
+#if HB_STATS
+  t_hb_request_stats *stats = &this->_stats.requests[this->_requestType];
+  unsigned long handleStart = this->_platform->millis();
+  uint32_t heap;
+  stats->count++;
+  if (statusCode == 0 || statusCode >= 400) {
+    stats->failures++;
+  }
+#endif
+  this->_workState = HB_STATE_IDLE;
+  switch (this->_requestType) {
+    case HB_REQ_POLL:
+      this->handlePollController(statusCode);
+      break;
+    case HB_REQ_CONFIGDATA:
+      this->handlePutConfigData(statusCode);
+      break;
+    case HB_REQ_DEPLOYMENTBASE:
+      this->handleDeploymentBase(statusCode);
+      break;
+    case HB_REQ_CANCELACTION:
+      this->handleCancelAction(statusCode);
+      break;
+    case HB_REQ_FEEDBACK:
+      this->handleDeploymentBaseFeedback(statusCode);
+      break;
+    case HB_REQ_DOWNLOAD:
+      this->handleUpdateImage(statusCode);
       break;
     default:
-      /* No Authorization Header needed */
       break;
   }
-  if (acceptType != NULL && strlen(acceptType) > 0) {
-    snprintf(headers + strsize, HEADERSIZE - strsize, "Accept: %s\r\n", acceptType);
-    strsize = strnlen(headers, HEADERSIZE);
+#if HB_STATS
+  stats->bodyTime += this->_platform->millis() - handleStart;
+  /* The artifact body is counted while it is written to flash */
+  if (statusCode > 0 && this->_requestType != HB_REQ_DOWNLOAD) {
+    stats->bytesIn += this->_body.getBytesRead();
+  }
+  heap = this->_platform->freeHeap();
+  if (heap > 0 && (this->_stats.minFreeHeap == 0 || heap < this->_stats.minFreeHeap)) {
+    this->_stats.minFreeHeap = heap;
   }
-  snprintf(headers + strsize, HEADERSIZE - strsize, "Connection: close\r\n");
-  strsize = strnlen(headers, HEADERSIZE);
-  return headers;
+#endif
 }
 
-static void splitHref(char *href_string) {
-  Serial.println("Split Href");
-  uint8_t partNo = 0;
-  char *endPtr;
-  size_t curLen;
-  memset(&href_param, 0, sizeof(href_param));
-  // Read each time pair
-  char* component = strtok(href_string, "/");
-  while (component != NULL)
-  {
-    Serial.println(component);
-    switch (partNo) {
-      case 0:
-      default:
-        // Find the next command in input string
-        component = strtok(NULL, ":/");
-        break;
-      case 1:
-        strncpy(href_param.href_server, component, sizeof(href_param.href_server));
-        // Find the next command in input string
-        component = strtok(NULL, "/");
-        break;
-      case 2:
-        href_param.href_port = strtol(component, &endPtr, 10);
-        if (endPtr != NULL && *endPtr != '\0') {
-          href_param.href_port = 443;
-          href_param.href_url[0] = '/';
-          strncpy(&href_param.href_url[1], component, sizeof(href_param.href_url) - 1);
-        }
-        // Find the next command in input string
-        component = strtok(NULL, "");
-        break;
-      case 3:
-        curLen = strnlen(href_param.href_url, sizeof(href_param.href_url));
-        href_param.href_url[curLen] = '/';
-        strncpy(&href_param.href_url[curLen + 1], component, sizeof(href_param.href_url) - curLen - 1);
-        // Find the next command in input string
-        component = strtok(NULL, "");
-        break;
+/* Keep the connection open if the next poll is due before it times out */
+bool HawkbitDdi::holdConnection() {
+  unsigned long hold = HB_KEEPALIVE_HOLD;
+  if (!this->_keepAlive || !this->_connectionReusable || !this->_transport->connected()) {
+    return false;
+  }
+  if (this->_keepAliveTimeout > 0 && this->_keepAliveTimeout < hold) {
+    hold = this->_keepAliveTimeout;
+  }
+  return HawkbitScheduler::reached(this->_lastResponseTime + hold, this->getNextPoll());
+}
+
+bool HawkbitDdi::canReuseConnection(const char *serverName, uint16_t serverPort) {
+  if (!this->_keepAlive || !this->_connectionReusable || !this->_transport->connected()) {
+    return false;
+  }
+  if (this->_connectedPort != serverPort || strcmp(this->_connectedServer, serverName) != 0) {
+    return false;
+  }
+  /* Server announced an idle timeout via Keep-Alive header */
+  if (this->_keepAliveTimeout > 0 && this->_platform->millis() - this->_lastResponseTime >= this->_keepAliveTimeout) {
+    return false;
+  }
+  return true;
+}
+
+bool HawkbitDdi::connectServer(const char *serverName, uint16_t serverPort) {
+  const uint8_t *session;
+  size_t sessionLen;
+  bool sessionOffered = false;
+  bool sessionResumed;
+  size_t serverNameLength;
+  this->closeConnection();
+  if (this->_sessionCache.lookup(serverName, serverPort, &session, &sessionLen)) {
+    sessionOffered = this->_transport->setSession(session, sessionLen);
+  }
+  HB_LOG_DEBUG(this->_log, "Starting connection to server...\r\n");
+  if (!this->_transport->connect(serverName, serverPort)) {
+    HB_LOG_WARN(this->_log, "Connection failed!\r\n");
+    /* Do not offer a possibly rejected session again */
+    if (sessionOffered) {
+      this->_sessionCache.invalidate(serverName, serverPort);
     }
-    partNo++;
+    return false;
+  }
+  sessionResumed = sessionOffered && this->_transport->sessionResumed();
+  this->_sessionCache.countHandshake(sessionResumed);
+  if (!sessionResumed) {
+    this->_transport->saveSession(this->_sessionCache, serverName, serverPort);
+  }
+  HB_LOG_DEBUG(this->_log, "%s\r\n", sessionResumed ? "Connected to server (TLS session resumed)!" : "Connected to server!");
+  /* A server name that does not fit is not compared, the connection is not reused */
+  serverNameLength = strlen(serverName);
+  if (serverNameLength < sizeof(this->_connectedServer)) {
+    memcpy(this->_connectedServer, serverName, serverNameLength + 1);
+    this->_connectedPort = serverPort;
+  }
+  return true;
+}
+
+void HawkbitDdi::closeConnection() {
+  if (this->_transport->connected()) {
+    this->_transport->stop();
+  }
+  this->_connectionReusable = false;
+  this->_connectedServer[0] = '\0';
+  this->_connectedPort = 0;
+}
+
+bool HawkbitDdi::sendRequest(const char *serverName, uint16_t serverPort, const char *method, const char *controllerId, const char *path, const char *acceptType, const char *jsonBody, const char *extraHeaders) {
+  HawkbitRequestWriter request(this->_transport);
+  size_t bodyLength;
+  bool sent;
+#if HB_STATS
+  t_hb_request_stats *stats = &this->_stats.requests[this->_requestType];
+  unsigned long connectStart = this->_platform->millis();
+#endif
+  this->_requestReused = this->canReuseConnection(serverName, serverPort);
+  if (this->_requestReused) {
+    HB_LOG_DEBUG(this->_log, "Reusing connection to server!\r\n");
+  } else if (!this->connectServer(serverName, serverPort)) {
+    return false;
+  }
+#if HB_STATS
+  stats->connectTime += this->_platform->millis() - connectStart;
+#endif
+  // Make a HTTP request:
+  request.add(method);
+  request.add(" ");
+  if (controllerId != NULL) {
+    request.add(this->_controllerBasePath.c_str(), this->_controllerBasePath.length());
+    request.add(controllerId);
+    request.add(path);
+  } else {
+    /* The fragment of a link is not sent, a bare query gets the root path */
+    if (path[0] != '/') {
+      request.add("/");
+    }
+    request.add(path, strcspn(path, "#"));
+  }
+  request.add(" HTTP/1.1\r\nHost: ");
+  /* IPv6 literals are bracketed, the default port of the scheme is left out */
+  if (strchr(serverName, ':') != NULL) {
+    request.add("[");
+    request.add(serverName);
+    request.add("]");
+  } else {
+    request.add(serverName);
+  }
+  if (serverPort != (this->_transport->isSecure() ? 443 : 80)) {
+    request.add(":");
+    request.addNumber(serverPort);
+  }
+  request.add("\r\n");
+  request.add(this->_authorizationHeader.c_str(), this->_authorizationHeader.length());
+  if (acceptType != NULL && acceptType[0] != '\0') {
+    request.add("Accept: ");
+    request.add(acceptType);
+    request.add("\r\n");
+  }
+  request.add(this->_keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n");
+  if (extraHeaders != NULL) {
+    request.add(extraHeaders);
+  }
+  if (jsonBody != NULL) {
+    bodyLength = strlen(jsonBody);
+    request.add("Content-Type: application/json\r\nContent-Length: ");
+    request.addNumber(bodyLength);
+    request.add("\r\n");
+  }
+  // Close Headers field
+  request.add("\r\n");
+  if (jsonBody != NULL) {
+    request.add(jsonBody, bodyLength);
+  }
+  sent = request.finish();
+#if HB_STATS
+  stats->bytesOut += request.getBytesWritten();
+#endif
+  if (!sent) {
+    HB_LOG_WARN(this->_log, "Sending request failed\r\n");
+    this->closeConnection();
+    return false;
+  }
+  this->_response.reset();
+  this->_responseStarted = false;
+  this->_requestTime = this->_platform->millis();
+  this->_workState = HB_STATE_RESPONSE;
+  return true;
+}
+
+/* Parse the response headers received so far without waiting for more.
+   Returns false while the headers are incomplete */
+bool HawkbitDdi::receiveResponse() {
+  int c;
+  while (!this->_response.complete() && this->_transport->available() > 0) {
+    c = this->_transport->read();
+    if (c < 0) {
+      break;
+    }
+    if (!this->_responseStarted) {
+      this->_responseStarted = true;
+      this->_firstByteTime = this->_platform->millis();
+#if HB_STATS
+      this->_stats.requests[this->_requestType].firstByteTime += this->_firstByteTime - this->_requestTime;
+#endif
+    }
+#if HB_STATS
+    this->_stats.requests[this->_requestType].bytesIn++;
+#endif
+    /* Skip interim 1xx responses */
+    if (this->_response.feed((char)c) && this->_response.getStatusCode() < 200) {
+      this->_response.reset();
+    }
+  }
+  if (this->_response.complete()) {
+#if HB_STATS
+    this->_stats.requests[this->_requestType].headerTime += this->_platform->millis() - this->_firstByteTime;
+#endif
+    HB_LOG_DEBUG(this->_log, "HTTP %d, Content-Length: %ld%s\r\n", this->_response.getStatusCode(),
+                 this->_response.getContentLength(), this->_response.isChunked() ? ", chunked" : "");
+    this->_body.begin(this->_transport, this->_response.getContentLength(), this->_response.isChunked());
+    this->_keepAliveTimeout = this->_response.getKeepAliveTimeout();
+    this->_lastResponseTime = this->_platform->millis();
+    /* Only reuse the connection if we know where the body ends */
+    this->_connectionReusable = this->_keepAlive && this->_response.keepAlive() &&
+                                (this->_response.isChunked() || this->_response.getContentLength() >= 0);
+    /* The artifact is written as it arrives, other bodies of known size are
+       collected first so that parsing them does not wait for the server */
+    this->_bodyBuffered = this->_requestType != HB_REQ_DOWNLOAD && !this->_response.isChunked() &&
+                          this->_response.getContentLength() > 0 &&
+                          this->_response.getContentLength() <= (long)sizeof(this->_bufferedBody);
+    if (this->_bodyBuffered) {
+      this->_bufferedLength = 0;
+      this->_workState = HB_STATE_BODY;
+      return true;
+    }
+    this->handleResponse(this->_response.getStatusCode());
+    return true;
+  }
+  if (this->_transport->connected()) {
+    if (this->_platform->millis() - this->_requestTime < HB_RESPONSE_TIMEOUT) {
+      return false;
+    }
+    HB_LOG_WARN(this->_log, "Response timed out\r\n");
+  } else if (this->_requestReused && !this->_responseStarted && !this->_requestRetried) {
+    /* The server closed the idle connection in the meantime, retry once on a new one */
+    HB_LOG_DEBUG(this->_log, "Connection closed by server, reconnecting\r\n");
+    this->closeConnection();
+    this->_requestRetried = true;
+    if (this->startRequest(this->_requestType)) {
+      return true;
+    }
+    this->handleResponse(0);
+    return false;
+  } else {
+    HB_LOG_WARN(this->_log, "No valid response received\r\n");
+  }
+  this->closeConnection();
+  this->handleResponse(0);
+  return true;
+}
+
+/* Read the available part of a buffered body, handle the response once it
+   is complete or cannot be completed anymore */
+bool HawkbitDdi::receiveBody() {
+  size_t length = this->_response.getContentLength();
+  int available = this->_transport->available();
+  if (available > 0) {
+    if ((size_t)available > length - this->_bufferedLength) {
+      available = length - this->_bufferedLength;
+    }
+    this->_bufferedLength += this->_body.readBytes(this->_bufferedBody + this->_bufferedLength, available);
+    if (this->_bufferedLength < length) {
+      return true;
+    }
+  } else if (this->_transport->connected() && this->_platform->millis() - this->_requestTime < HB_RESPONSE_TIMEOUT) {
+    return false;
+  } else {
+    HB_LOG_WARN(this->_log, "Body incomplete, %u of %u bytes\r\n", (unsigned int)this->_bufferedLength, (unsigned int)length);
+    this->_connectionReusable = false;
+  }
+  this->_bufferedStream.begin(this->_bufferedBody, this->_bufferedLength);
+  this->handleResponse(this->_response.getStatusCode());
+  return true;
+}
+
+/* Body of the current response for the handlers */
+Stream &HawkbitDdi::responseBody() {
+  if (this->_bodyBuffered) {
+    return this->_bufferedStream;
+  }
+  return this->_body;
+}
+
+/* Send a GET request for one of the stored links */
+bool HawkbitDdi::getLink(HB_LINK link, const char *acceptType, const char *extraHeaders) {
+  char href[HB_LINK_STORE_SIZE + 1];
+  char host[HB_URL_HOST_SIZE];
+  HawkbitUrl url;
+  if (this->_links.copy(link, href, sizeof(href)) == 0) {
+    return false;
+  }
+  if (!url.parse(href) || !url.copyHost(host, sizeof(host))) {
+    HB_LOG_ERROR(this->_log, "Invalid link: %s\r\n", href);
+    return false;
+  }
+  /* The transport cannot switch between TLS and plain connections, and the
+     default port and Host header follow the scheme of the link */
+  if (url.isSecure() != this->_transport->isSecure()) {
+    HB_LOG_ERROR(this->_log, "Link does not use the %s scheme of the transport: %s\r\n",
+                 this->_transport->isSecure() ? "https" : "http", href);
+    return false;
+  }
+  HB_LOG_DEBUG(this->_log, "Server: %s:%d, GET %s\r\n", host, url.getPort(), url.getPath());
+  return this->sendRequest(host, url.getPort(), "GET", NULL, url.getPath(), acceptType, NULL, extraHeaders);
+}
+
+void HawkbitDdi::storeLink(HB_LINK link, const char *href) {
+  if (!this->_links.set(link, href)) {
+    HB_LOG_ERROR(this->_log, "Link does not fit into %d bytes of link storage\r\n", HB_LINK_STORE_SIZE);
+  }
+}
+
+/* Check for a successful response, otherwise the response is discarded */
+bool HawkbitDdi::isSuccess(int statusCode) {
+  if (statusCode >= 200 && statusCode < 300) {
+    return true;
+  }
+  if (statusCode > 0) {
+    HB_LOG_WARN(this->_log, "Request failed with HTTP status %d\r\n", statusCode);
+    this->finishRequest();
+  }
+  return false;
+}
+
+void HawkbitDdi::finishRequest() {
+  if (this->_connectionReusable && this->_body.drain()) {
+    HB_LOG_TRACE(this->_log, "Keeping connection alive\r\n");
+    return;
   }
+  this->closeConnection();
 }
 
 HB_DEPLOYMENT_MODE HawkbitDdi::parseDeploymentMode(const char *deploymentmode) {
@@ -260,371 +1015,846 @@ HB_DEPLOYMENT_MODE HawkbitDdi::parseDeploymentMode(const char *deploymentmode) {
   return returnMode;
 }
 
-void HawkbitDdi::getAndInstallUpdateImage() {
-  splitHref(this->_getSoftwareModuleHref);
-  this->_getSoftwareModuleHref[0] = '\0';
-  Serial.printf("Server: %s:%d, GET %s\r\n", href_param.href_server, href_param.href_port, href_param.href_url);
-  Serial.println("\nStarting connection to server...");
-  if (!_client.connect(href_param.href_server, href_param.href_port)) {
-    Serial.println("Connection failed!");
-  } else {
-    Serial.println("Connected to server!");
-    // Make a HTTP request:
-    _client.printf(HawkbitDdi::_getRequest, href_param.href_url);
-    _client.print(this->createHeaders(href_param.href_server, "application/octet-stream"));
-    // Close Headers field
-    _client.println();
-
-    while (_client.connected()) {
-      String line = _client.readStringUntil('\n');
-      Serial.println(line);
-      if (line == "\r") {
-        Serial.println("headers received");
-        break;
-      }
+bool HawkbitDdi::getAndInstallUpdateImage() {
+  char rangeHeader[40];
+  if (!this->_flashStarted && !this->startImage()) {
+    HB_LOG_ERROR(this->_log, "Starting the image in flash failed: %d\r\n", this->_flash->getError());
+    this->interruptImage(false);
+    return false;
+  }
+  size_t segmentSize = 0;
+  rangeHeader[0] = '\0';
+  /* Segments cost a request each, without keep-alive also a connection. They
+     end about when a report is due, so that is at most one per
+     HB_PROGRESS_INTERVAL */
+  if (this->_progressFeedback) {
+    segmentSize = this->nextSegmentSize();
+  }
+  this->_segmentOffset = this->_downloadOffset;
+  this->_segmentSize = segmentSize;
+  this->_segmentStart = this->_platform->millis();
+  this->_segmentDuration = 0;
+  if (this->_segmentSize > 0) {
+    /* Download in segments to be able to report progress in between */
+    snprintf(rangeHeader, sizeof(rangeHeader), "Range: bytes=%lu-%lu\r\n", (unsigned long)this->_downloadOffset,
+             (unsigned long)(this->_downloadOffset + this->_segmentSize - 1));
+  } else if (this->_downloadOffset > 0) {
+    snprintf(rangeHeader, sizeof(rangeHeader), "Range: bytes=%lu-\r\n", (unsigned long)this->_downloadOffset);
+  }
+  return this->getLink(HB_LINK_DOWNLOAD, "application/octet-stream", rangeHeader);
+}
+
+void HawkbitDdi::handleUpdateImage(int statusCode) {
+  long size = statusCode == 206 ? this->_response.getRangeSize() : statusCode == 200 ? this->_response.getContentLength() : -1;
+  /* The action failed already if the image could not be started */
+  if (!this->_flashStarted) {
+    return;
+  }
+  if (size >= 0 && size != (long)this->_updateSize) {
+    HB_LOG_ERROR(this->_log, "Server returned an artifact of %ld bytes instead of %lu\r\n", size, this->_updateSize);
+    this->closeConnection();
+    this->interruptImage(false);
+    return;
+  }
+  if (statusCode == 200 && this->_downloadOffset > 0) {
+    HB_LOG_WARN(this->_log, "Server ignored the range, restarting download\r\n");
+    this->_flash->abort();
+    this->_imageHash.begin(this->artifactHashType());
+    this->_downloadOffset = 0;
+    if (!this->_flash->begin(this->_updateSize)) {
+      HB_LOG_ERROR(this->_log, "Restarting the image in flash failed: %d\r\n", this->_flash->getError());
+      this->closeConnection();
+      this->interruptImage(false);
+      return;
     }
-    Update.begin(this->_updateSize, U_FLASH);
-    Serial.printf("%d Bytes written\r\n", Update.writeStream(_client));
-    if (Update.end()) {
-      Serial.println("OTA done!");
-      if (Update.isFinished()) {
-        this->_currentExecutionStatus = HB_EX_CLOSED;
-        this->_currentExecutionResult = HB_RES_SUCCESS;
-        this->_jobFeedbackChanged = true;
-        Serial.println("Update successfully completed. Rebooting.");
-      }
-      else {
-        this->_currentExecutionStatus = HB_EX_CLOSED;
-        this->_currentExecutionResult = HB_RES_FAILURE;
-        this->_jobFeedbackChanged = true;
-        Serial.println("Update not finished? Something went wrong!");
-      }
+  } else if (statusCode == 206 && this->_response.getRangeStart() != (long)this->_downloadOffset) {
+    HB_LOG_WARN(this->_log, "Server returned range from byte %ld\r\n", this->_response.getRangeStart());
+    this->closeConnection();
+    statusCode = 0;
+  }
+  if (!this->isSuccess(statusCode)) {
+    this->interruptImage(true);
+    return;
+  }
+  /* The body is written to flash by receiveImage() over the next work() calls */
+  this->_lastSavedOffset = this->_downloadOffset;
+  this->_lastDataTime = this->_platform->millis();
+  this->_workState = HB_STATE_DOWNLOAD;
+}
+
+/* Continue with the next segment of the artifact, report the progress first
+   if the last report is long enough ago */
+void HawkbitDdi::finishSegment() {
+  unsigned long now = this->_platform->millis();
+  this->_workState = HB_STATE_IDLE;
+  this->_active->jobSchedule = now;
+  /* A segment within the same ms counts as 1 ms, it still marks the segment complete */
+  this->_segmentDuration = now - this->_segmentStart > 0 ? now - this->_segmentStart : 1;
+  if (now - this->_lastProgressTime >= HB_PROGRESS_INTERVAL) {
+    HB_LOG_INFO(this->_log, "Download progress: %lu of %lu bytes\r\n", (unsigned long)this->_downloadOffset, this->_updateSize);
+    this->_feedbackQueue.push(this->_active->actionId, HB_EX_PROCEEDING, HB_RES_NONE, this->_downloadOffset, this->_updateSize, this->_activeIndex);
+    this->_lastProgressTime = now;
+  }
+}
+
+/* Bytes until about the next progress report at the rate of the last
+   segment, 0 if the rest of the artifact is not worth splitting */
+size_t HawkbitDdi::nextSegmentSize() {
+  unsigned long sinceReport = this->_platform->millis() - this->_lastProgressTime;
+  size_t remaining = this->_updateSize - this->_downloadOffset;
+  uint64_t size = HB_PROGRESS_BYTES;
+  /* The last request was a complete segment that took measurable time */
+  if (this->_segmentSize > 0 && this->_segmentDuration > 0 &&
+      this->_downloadOffset == this->_segmentOffset + this->_segmentSize && sinceReport < HB_PROGRESS_INTERVAL) {
+    size = (uint64_t)this->_segmentSize * (HB_PROGRESS_INTERVAL - sinceReport) / this->_segmentDuration;
+    if (size < HB_PROGRESS_BYTES) {
+      size = HB_PROGRESS_BYTES;
+    }
+  }
+  return size < remaining ? (size_t)size : 0;
+}
+
+/* Count a failed download attempt and either schedule the next one or give up */
+void HawkbitDdi::interruptImage(bool flashOk) {
+  this->_workState = HB_STATE_IDLE;
+  this->_downloadAttempts++;
+  if (!flashOk || this->_downloadAttempts >= HB_DOWNLOAD_MAX_ATTEMPTS) {
+    HB_LOG_ERROR(this->_log, "Download failed at %lu of %lu bytes\r\n", (unsigned long)this->_downloadOffset, this->_updateSize);
+    this->_flash->abort();
+    this->_flashStarted = false;
+    this->clearDownloadProgress();
+    this->_links.clear(HB_LINK_DOWNLOAD);
+    this->_active->executionStatus = HB_EX_CLOSED;
+    this->_active->executionResult = HB_RES_FAILURE;
+    this->_jobFeedbackChanged = true;
+    return;
+  }
+  /* Keep the image open and continue from the current offset later */
+  this->saveDownloadProgress();
+  this->_active->jobSchedule = this->_platform->millis() + HB_DOWNLOAD_RETRY_DELAY;
+  HB_LOG_WARN(this->_log, "Download interrupted at %lu of %lu bytes, retrying\r\n", (unsigned long)this->_downloadOffset, this->_updateSize);
+}
+
+/* Open the image in flash, continue a saved download if possible */
+bool HawkbitDdi::startImage() {
+  t_download_progress progress;
+  this->_downloadOffset = 0;
+  this->_downloadAttempts = 0;
+  this->_imageHash.begin(this->artifactHashType());
+  if (this->_storage != NULL && this->_flash->canResume() &&
+      this->_storage->load("download", &progress, sizeof(progress)) == sizeof(progress) &&
+      progress.actionId == this->_active->actionId && progress.size == this->_updateSize &&
+      strncmp(progress.sha1, this->_artifactSha1, sizeof(progress.sha1)) == 0 &&
+      progress.offset < progress.size && this->_flash->resume(this->_updateSize, progress.offset)) {
+    if (this->hashWrittenImage(progress.offset)) {
+      this->_downloadOffset = progress.offset;
+      HB_LOG_INFO(this->_log, "Resuming download at byte %lu\r\n", (unsigned long)this->_downloadOffset);
+      this->_flashStarted = true;
+      return true;
+    }
+    this->_flash->abort();
+    this->_imageHash.begin(this->artifactHashType());
+  }
+  if (!this->_flash->begin(this->_updateSize)) {
+    return false;
+  }
+  this->_flashStarted = true;
+  return true;
+}
+
+/* Feed the part written before a reboot into the digest */
+bool HawkbitDdi::hashWrittenImage(size_t length) {
+  uint8_t buffer[HB_DOWNLOAD_CHUNK_SIZE];
+  size_t offset = 0;
+  size_t toRead;
+  if (this->_imageHash.getType() == HB_HASH_NONE) {
+    return true;
+  }
+  while (offset < length) {
+    toRead = length - offset;
+    if (toRead > sizeof(buffer)) {
+      toRead = sizeof(buffer);
+    }
+    if (this->_flash->read(offset, buffer, toRead) != toRead) {
+      HB_LOG_WARN(this->_log, "Cannot read back the written image, restarting download\r\n");
+      return false;
+    }
+    this->_imageHash.update(buffer, toRead);
+    offset += toRead;
+  }
+  return true;
+}
+
+/* Strongest digest the server sent for the artifact */
+HB_HASH_TYPE HawkbitDdi::artifactHashType() {
+  if (this->_artifactSha256[0] != '\0') {
+    return HB_HASH_SHA256;
+  }
+  if (this->_artifactSha1[0] != '\0') {
+    return HB_HASH_SHA1;
+  }
+  if (this->_artifactMd5[0] != '\0') {
+    return HB_HASH_MD5;
+  }
+  return HB_HASH_NONE;
+}
+
+void HawkbitDdi::finishImage() {
+  bool hashOk = true;
+  this->_flashStarted = false;
+  this->clearDownloadProgress();
+  this->_links.clear(HB_LINK_DOWNLOAD);
+  HB_LOG_INFO(this->_log, "%lu Bytes written\r\n", (unsigned long)this->_downloadOffset);
+  switch (this->_imageHash.getType()) {
+    case HB_HASH_SHA256:
+      hashOk = this->_imageHash.verify(this->_artifactSha256);
+      break;
+    case HB_HASH_SHA1:
+      hashOk = this->_imageHash.verify(this->_artifactSha1);
+      break;
+    case HB_HASH_MD5:
+      hashOk = this->_imageHash.verify(this->_artifactMd5);
+      break;
+    default:
+      HB_LOG_WARN(this->_log, "No artifact hash to verify\r\n");
+      break;
+  }
+  if (!hashOk) {
+    this->_flash->abort();
+    this->_active->executionStatus = HB_EX_CLOSED;
+    this->_active->executionResult = HB_RES_FAILURE;
+    this->_jobFeedbackChanged = true;
+    HB_LOG_ERROR(this->_log, "Artifact hash mismatch!\r\n");
+    return;
+  }
+  if (this->_downloadAhead && this->_currentDeploymentMode != HB_DEPLOYMENT_FORCE) {
+    if (!this->_flash->commit()) {
+      this->_flash->abort();
+      this->_active->executionStatus = HB_EX_CLOSED;
+      this->_active->executionResult = HB_RES_FAILURE;
+      this->_jobFeedbackChanged = true;
+      HB_LOG_ERROR(this->_log, "Error Occurred. Error #: %d\r\n", this->_flash->getError());
+      return;
+    }
+    /* Keep the image open until the installation is allowed */
+    this->_imageReady = true;
+    this->_imageController = this->_active;
+    this->_active->executionStatus = HB_EX_DOWNLOADED;
+    this->_active->executionResult = HB_RES_NONE;
+    this->_jobFeedbackChanged = true;
+    HB_LOG_INFO(this->_log, "Update downloaded, waiting for installation\r\n");
+    return;
+  }
+  this->installImage();
+}
+
+/* Activate the verified image, it is booted after the next restart */
+void HawkbitDdi::installImage() {
+  this->_imageReady = false;
+  this->_installApproved = false;
+  if (this->_flash->end()) {
+    HB_LOG_INFO(this->_log, "OTA done!\r\n");
+    if (this->_flash->isFinished()) {
+      this->_active->executionStatus = HB_EX_CLOSED;
+      this->_active->executionResult = HB_RES_SUCCESS;
+      this->_jobFeedbackChanged = true;
+      HB_LOG_INFO(this->_log, "Update successfully completed. Rebooting.\r\n");
     }
     else {
-      this->_currentExecutionStatus = HB_EX_CLOSED;
-      this->_currentExecutionResult = HB_RES_FAILURE;
+      this->_active->executionStatus = HB_EX_CLOSED;
+      this->_active->executionResult = HB_RES_FAILURE;
       this->_jobFeedbackChanged = true;
-      Serial.println("Error Occurred. Error #: " + String(Update.getError()));
+      HB_LOG_ERROR(this->_log, "Update not finished? Something went wrong!\r\n");
     }
-    _client.stop();
+  }
+  else {
+    this->_active->executionStatus = HB_EX_CLOSED;
+    this->_active->executionResult = HB_RES_FAILURE;
+    this->_jobFeedbackChanged = true;
+    HB_LOG_ERROR(this->_log, "Error Occurred. Error #: %d\r\n", this->_flash->getError());
   }
 }
 
-void HawkbitDdi::getDeploymentBase() {
-  splitHref(this->_getDeploymentBaseHref);
-  this->_getDeploymentBaseHref[0] = '\0';
-  Serial.printf("Server: %s:%d, GET %s\r\n", href_param.href_server, href_param.href_port, href_param.href_url);
-  Serial.println("\nStarting connection to server...");
-  if (!_client.connect(href_param.href_server, href_param.href_port)) {
-    Serial.println("Connection failed!");
-  } else {
-    Serial.println("Connected to server!");
-    // Make a HTTP request:
-    _client.printf(HawkbitDdi::_getRequest, href_param.href_url);
-    _client.print(this->createHeaders(href_param.href_server));
-    // Close Headers field
-    _client.println();
-
-    while (_client.connected()) {
-      String line = _client.readStringUntil('\n');
-      Serial.println(line);
-      if (line == "\r") {
-        Serial.println("headers received");
-        break;
+/* Write the part of the response body that has already been received to the
+   flash sink, until the image is complete or the work budget is used up.
+   Returns false while waiting for more data */
+bool HawkbitDdi::receiveImage(unsigned long start) {
+  uint8_t buffer[HB_DOWNLOAD_CHUNK_SIZE];
+  size_t toRead;
+  size_t readLen;
+  int available;
+#if HB_STATS
+  unsigned long writeStart;
+#endif
+  while (this->_downloadOffset < this->_updateSize) {
+    available = this->_body.available();
+    if (available <= 0 && this->_body.isComplete() && this->_response.getStatusCode() == 206) {
+      this->finishRequest();
+      this->finishSegment();
+      return true;
+    }
+    if (available <= 0) {
+      if (!this->_body.isComplete() && this->_transport->connected() &&
+          this->_platform->millis() - this->_lastDataTime < HB_RESPONSE_TIMEOUT) {
+        return false;
       }
+      HB_LOG_WARN(this->_log, "Download timed out\r\n");
+      this->closeConnection();
+      this->interruptImage(true);
+      return true;
     }
-    auto error = deserializeJson(jsonBuffer, _client);
-    if (error) {
-      Serial.print(F("deserializeJson() failed with code "));
-      Serial.println(error.c_str());
-      _client.stop();
-      return;
+    toRead = this->_updateSize - this->_downloadOffset;
+    if (toRead > sizeof(buffer)) {
+      toRead = sizeof(buffer);
+    }
+    if (toRead > (size_t)available) {
+      toRead = available;
+    }
+    readLen = this->_body.readBytes((char *)buffer, toRead);
+    if (readLen == 0) {
+      return false;
+    }
+#if HB_STATS
+    writeStart = this->_platform->millis();
+    this->_stats.requests[HB_REQ_DOWNLOAD].bytesIn += readLen;
+    this->_stats.downloadBytes += readLen;
+    this->_stats.downloadTime += writeStart - this->_lastDataTime;
+#endif
+    if (this->_flash->write(buffer, readLen) != readLen) {
+      HB_LOG_ERROR(this->_log, "Flash write failed\r\n");
+      this->closeConnection();
+      this->interruptImage(false);
+      return true;
+    }
+#if HB_STATS
+    this->_stats.flashWriteTime += this->_platform->millis() - writeStart;
+#endif
+    this->_imageHash.update(buffer, readLen);
+    this->_downloadOffset += readLen;
+    this->_lastDataTime = this->_platform->millis();
+    if (this->_downloadOffset - this->_lastSavedOffset >= HB_DOWNLOAD_SAVE_INTERVAL) {
+      this->saveDownloadProgress();
+      this->_lastSavedOffset = this->_downloadOffset;
+    }
+    if (this->budgetExceeded(start)) {
+      return true;
     }
+  }
+  this->_workState = HB_STATE_IDLE;
+  this->finishRequest();
+  this->finishImage();
+  return true;
+}
+
+void HawkbitDdi::saveDownloadProgress() {
+  t_download_progress progress;
+  if (this->_storage == NULL || !this->_flash->canResume()) {
+    return;
+  }
+  memset(&progress, 0, sizeof(progress));
+  progress.actionId = this->_active->actionId;
+  progress.size = this->_updateSize;
+  progress.offset = this->_downloadOffset;
+  /* Both are 41 bytes, the memset keeps the terminator */
+  memcpy(progress.sha1, this->_artifactSha1, sizeof(progress.sha1) - 1);
+  this->_storage->save("download", &progress, sizeof(progress));
+}
 
-    // Extract values
-    Serial.println(F("Response:"));
-    serializeJsonPretty(jsonBuffer, Serial);
-    Serial.println();
-    _client.stop();
-    Serial.println("Storing Values");
-    this->_currentActionId = atoi(jsonBuffer["id"].as<char *>());
-    Serial.printf("Current Action ID: %d\r\n", this->_currentActionId);
-    /* Only look for the deployment update mode as we don't want to split download and update on ESP32 */
-    this->_currentDeploymentMode = HawkbitDdi::parseDeploymentMode(jsonBuffer["deployment"]["update"].as<char *>());
-    Serial.printf("Deployment Mode: %s", HawkbitDdi::deploymentModeString[this->_currentDeploymentMode]);
-    if (this->_currentExecutionStatus == HB_EX_CLOSED) {
+void HawkbitDdi::clearDownloadProgress() {
+  if (this->_storage != NULL && this->_flash->canResume()) {
+    this->_storage->remove("download");
+  }
+}
+
+bool HawkbitDdi::getDeploymentBase() {
+  return this->getLink(HB_LINK_DEPLOYMENTBASE, "application/hal+json", NULL);
+}
+
+void HawkbitDdi::handleDeploymentBase(int statusCode) {
+  this->_deploymentBasePending = false;
+  if (this->isSuccess(statusCode)) {
+    HawkbitJsonExtractor extractor;
+    /* Identity of a downloaded image that waits for the installation */
+    int preparedAction = this->_imageReady && this->_imageController == this->_active ? this->_active->actionId : 0;
+    unsigned long preparedSize = this->_updateSize;
+    char preparedHash[sizeof(this->_artifactSha256)];
+    strcpy(preparedHash, this->_artifactSha256[0] != '\0' ? this->_artifactSha256 :
+                         this->_artifactSha1[0] != '\0' ? this->_artifactSha1 : this->_artifactMd5);
+    this->_links.clear(HB_LINK_DOWNLOAD);
+    this->_artifactSha1[0] = '\0';
+    this->_artifactMd5[0] = '\0';
+    this->_artifactSha256[0] = '\0';
+    this->_updateSize = 0;
+    this->_currentDeploymentMode = HB_DEPLOYMENT_NONE;
+    this->_currentDownloadMode = HB_DEPLOYMENT_NONE;
+    if (!extractor.parse(this->responseBody(), HawkbitDdi::onDeploymentBaseValue, this)) {
+      HB_LOG_ERROR(this->_log, "Parsing deployment base failed\r\n");
+      this->closeConnection();
+      return;
+    }
+    this->finishRequest();
+    if (preparedAction > 0 && (preparedAction != this->_active->actionId || preparedSize != this->_updateSize ||
+                               strcmp(preparedHash, this->_artifactSha256[0] != '\0' ? this->_artifactSha256 :
+                                                    this->_artifactSha1[0] != '\0' ? this->_artifactSha1 : this->_artifactMd5) != 0)) {
+      /* The server replaced the action or its artifact, start over */
+      HB_LOG_WARN(this->_log, "Deployment changed, discarding the downloaded update\r\n");
+      this->_flash->abort();
+      this->_imageReady = false;
+      this->_installApproved = false;
+      this->_active->executionStatus = HB_EX_CLOSED;
+      this->_active->executionResult = HB_RES_NONE;
+    }
+    HB_LOG_INFO(this->_log, "Current Action ID: %d\r\n", this->_active->actionId);
+    HB_LOG_INFO(this->_log, "Deployment Mode: %s\r\n", HawkbitDdi::deploymentModeString[this->_currentDeploymentMode]);
+    if (this->_active->executionStatus == HB_EX_CLOSED) {
       if (this->_currentDeploymentMode == HB_DEPLOYMENT_FORCE) {
         /* Immediately start downloading and updating */
-        this->_currentExecutionStatus = HB_EX_PROCEEDING;
-        this->_currentExecutionResult = HB_RES_NONE;
+        this->_active->executionStatus = HB_EX_PROCEEDING;
+        this->_active->executionResult = HB_RES_NONE;
+        this->_jobFeedbackChanged = true;
+        this->_active->jobSchedule = this->_platform->millis();
+      } else if (this->_downloadAhead && this->_currentDeploymentMode != HB_DEPLOYMENT_NONE &&
+                 (this->_currentDownloadMode == HB_DEPLOYMENT_ATTEMPT || this->_currentDownloadMode == HB_DEPLOYMENT_FORCE)) {
+        /* Download now, the installation waits for installUpdate() */
+        this->_installApproved = false;
+        this->_active->executionStatus = HB_EX_PROCEEDING;
+        this->_active->executionResult = HB_RES_NONE;
         this->_jobFeedbackChanged = true;
-        this->_jobSchedule = millis();
+        this->_active->jobSchedule = this->_platform->millis();
       } else if (this->_currentDeploymentMode == HB_DEPLOYMENT_ATTEMPT) {
         /* Schedule downloading and updating in 10 minute */
-        this->_currentExecutionStatus = HB_EX_SCHEDULED;
-        this->_currentExecutionResult = HB_RES_NONE;
-        this->_jobSchedule = millis() + 15000UL;
+        this->_active->executionStatus = HB_EX_SCHEDULED;
+        this->_active->executionResult = HB_RES_NONE;
+        this->_active->jobSchedule = this->_platform->millis() + 15000UL;
         this->_jobFeedbackChanged = true;
       }
     }
-    Serial.println("Storing Chunks");
+    this->_snapshotPending = true;
     /* We only support one chunk with one artifact for now. */
-    JsonArray chunks = jsonBuffer["deployment"]["chunks"].as<JsonArray>();
-    if (!chunks.isNull() && chunks.size() >= 1) {
-      Serial.println("Storing Artifacts");
-      JsonArray artifacts = chunks[0]["artifacts"].as<JsonArray>();
-      if (!artifacts.isNull() && artifacts.size() >= 1) {
-        this->_updateSize = artifacts[0]["size"].as<unsigned long>();
-        strncpy(this->_getSoftwareModuleHref, artifacts[0]["_links"]["download"]["href"].as<char *>(), sizeof(this->_getSoftwareModuleHref));
-        Serial.println(this->_getSoftwareModuleHref);
-      }
-    }
+    HB_LOG_DEBUG(this->_log, "Artifact size: %lu\r\n", this->_updateSize);
   }
-  Serial.println("Deployment Base finished");
+  HB_LOG_DEBUG(this->_log, "Deployment Base finished\r\n");
 }
 
-void HawkbitDdi::pollController() {
-  char timeString[16];
-  int i = 0;
-  Serial.println("\nStarting connection to server...");
-  if (!_client.connect(this->_serverName.c_str(), this->_serverPort))
-    Serial.println("Connection failed!");
-  else {
-    Serial.println("Connected to server!");
-    // Make a HTTP request:
-    _client.printf(HawkbitDdi::_getRootController, this->_tenantId.c_str(), this->_controllerId.c_str());
-    _client.print(this->createHeaders());
-    // Close Headers field
-    _client.println();
-
-    while (_client.connected()) {
-      String line = _client.readStringUntil('\n');
-      Serial.println(line);
-      if (line == "\r") {
-        Serial.println("headers received");
-        break;
-      }
-    }
-    auto error = deserializeJson(jsonBuffer, _client);
-    if (error) {
-      Serial.print(F("deserializeJson() failed with code "));
-      Serial.println(error.c_str());
-      _client.stop();
-      return;
-    }
+void HawkbitDdi::onDeploymentBaseValue(void *context, const char *path, const char *value) {
+  HawkbitDdi *ddi = (HawkbitDdi *)context;
+  if (strcmp(path, "id") == 0) {
+    ddi->_active->actionId = atoi(value);
+  } else if (strcmp(path, "deployment.update") == 0) {
+    ddi->_currentDeploymentMode = HawkbitDdi::parseDeploymentMode(value);
+  } else if (strcmp(path, "deployment.download") == 0) {
+    ddi->_currentDownloadMode = HawkbitDdi::parseDeploymentMode(value);
+  } else if (strcmp(path, "deployment.chunks[0].artifacts[0].size") == 0) {
+    ddi->_updateSize = strtoul(value, NULL, 10);
+  } else if (strcmp(path, "deployment.chunks[0].artifacts[0].hashes.sha1") == 0) {
+    strncpy(ddi->_artifactSha1, value, sizeof(ddi->_artifactSha1) - 1);
+    ddi->_artifactSha1[sizeof(ddi->_artifactSha1) - 1] = '\0';
+  } else if (strcmp(path, "deployment.chunks[0].artifacts[0].hashes.md5") == 0) {
+    strncpy(ddi->_artifactMd5, value, sizeof(ddi->_artifactMd5) - 1);
+    ddi->_artifactMd5[sizeof(ddi->_artifactMd5) - 1] = '\0';
+  } else if (strcmp(path, "deployment.chunks[0].artifacts[0].hashes.sha256") == 0) {
+    strncpy(ddi->_artifactSha256, value, sizeof(ddi->_artifactSha256) - 1);
+    ddi->_artifactSha256[sizeof(ddi->_artifactSha256) - 1] = '\0';
+  } else if (strcmp(path, "deployment.chunks[0].artifacts[0]._links.download.href") == 0) {
+    ddi->storeLink(HB_LINK_DOWNLOAD, value);
+  }
+}
+
+bool HawkbitDdi::pollController() {
+  char conditionHeader[HB_POLL_ETAG_SIZE + 20];
+  conditionHeader[0] = '\0';
+  /* A 304 is only of use if the links of the cached resource are known */
+  if (this->_active->poll.etag[0] != '\0' && this->pollLinksKept()) {
+    snprintf(conditionHeader, sizeof(conditionHeader), "If-None-Match: %s\r\n", this->_active->poll.etag);
+  }
+  return this->sendRequest(this->_serverName.c_str(), this->_serverPort, "GET", this->_active->controllerId, "", "application/hal+json", NULL, conditionHeader);
+}
 
-    // Extract values
-    Serial.println(F("Response:"));
-    serializeJsonPretty(jsonBuffer, Serial);
-    Serial.println();
-    strncpy(timeString, jsonBuffer["config"]["polling"]["sleep"].as<char*>(), sizeof(timeString));
-    //  Serial.println(timeString);
-    this->_pollInterval = HawkbitDdi::convertTime(timeString);
-    Serial.printf("Poll Interval: %d\r\n", this->_pollInterval);
-    this->_nextPoll = millis() + (this->_pollInterval > 0 ? this->_pollInterval : 300000UL);
-    //this->_nextPoll = millis() + 10000UL;
-    Serial.printf("Next Poll: %d\r\n", this->_nextPoll);
-    Serial.println(jsonBuffer["_links"].as<char*>());
-    if (jsonBuffer["_links"].isNull()) {
-      this->_putConfigDataHref[0] = '\0';
-      this->_getDeploymentBaseHref[0] = '\0';
+void HawkbitDdi::handlePollController(int statusCode) {
+  t_hb_poll_cache *poll = &this->_active->poll;
+  long bodyLen = this->_response.getContentLength();
+  uint32_t bodyHash = 0;
+  if (statusCode == 304 && poll->cached && this->pollLinksKept()) {
+    /* Nothing changed, the links and interval of the last poll are still valid */
+    HB_LOG_DEBUG(this->_log, "Controller resource not modified\r\n");
+    this->finishRequest();
+  } else if (this->isSuccess(statusCode)) {
+    /* A longer ETag is not kept, the body is compared instead */
+    if (strlen(this->_response.getETag()) < sizeof(poll->etag)) {
+      strcpy(poll->etag, this->_response.getETag());
     } else {
-      if (!jsonBuffer["_links"]["deploymentBase"]["href"].isNull()) {
-        strncpy(this->_getDeploymentBaseHref, jsonBuffer["_links"]["deploymentBase"]["href"].as<char*>(), sizeof(this->_getDeploymentBaseHref));
-      } else {
-        this->_getDeploymentBaseHref[0] = '\0';
+      poll->etag[0] = '\0';
+    }
+    if (this->_bodyBuffered) {
+      if ((long)this->_bufferedLength != bodyLen) {
+        HB_LOG_ERROR(this->_log, "Reading controller resource failed\r\n");
+        poll->cached = false;
+        poll->etag[0] = '\0';
+        this->closeConnection();
+        this->pollFailed();
+        return;
       }
-      if (!jsonBuffer["_links"]["configData"]["href"].isNull()) {
-        strncpy(this->_putConfigDataHref, jsonBuffer["_links"]["configData"]["href"].as<char*>(), sizeof(this->_putConfigDataHref));
-      } else {
-        this->_putConfigDataHref[0] = '\0';
+      /* Without an ETag compare the body with the one of the last poll */
+      if (poll->etag[0] == '\0') {
+        bodyHash = hashBody(this->_bufferedBody, bodyLen);
       }
-      if (!jsonBuffer["_links"]["cancelAction"]["href"].isNull()) {
-        strncpy(this->_getCancelActionHref, jsonBuffer["_links"]["cancelAction"]["href"].as<char*>(), sizeof(this->_getCancelActionHref));
+      if (bodyHash != 0 && poll->cached && bodyHash == poll->bodyHash && bodyLen == poll->bodyLength &&
+          this->pollLinksKept()) {
+        HB_LOG_DEBUG(this->_log, "Controller resource unchanged\r\n");
       } else {
-        this->_getCancelActionHref[0] = '\0';
+        if (!this->parseController(this->_bufferedStream)) {
+          this->closeConnection();
+          this->pollFailed();
+          return;
+        }
       }
+    } else if (!this->parseController(this->_body)) {
+      this->closeConnection();
+      this->pollFailed();
+      return;
     }
+    poll->bodyHash = bodyHash;
+    poll->bodyLength = bodyLen;
+    this->finishRequest();
+  } else {
+    if (statusCode == 304) {
+      /* Unusable without the cached resource, fetch all of it next time */
+      poll->etag[0] = '\0';
+    }
+    this->pollFailed();
+    return;
+  }
 
-    _client.stop();
+  HB_LOG_DEBUG(this->_log, "Poll Interval: %lu\r\n", (unsigned long)poll->interval);
+  this->_active->scheduler.success(this->_platform->millis(), poll->interval);
+  this->_feedbackBlocked = false;
+  HB_LOG_DEBUG(this->_log, "Next Poll: %lu\r\n", this->_active->scheduler.getNextTime());
+  if (poll->links & (1 << HB_LINK_CONFIGDATA)) {
+    this->_active->configDataPending = true;
   }
+  this->_deploymentBasePending = this->_links.isSet(HB_LINK_DEPLOYMENTBASE);
+  this->_cancelActionPending = this->_links.isSet(HB_LINK_CANCELACTION);
 }
 
-void HawkbitDdi::postDeploymentBaseFeedback() {
-  char timeString[16];
-  jsonBuffer.clear();
-  jsonBuffer["id"] = String(this->_currentActionId);
-  jsonBuffer["time"] = "20190511T121314";
-  jsonBuffer["status"]["execution"] = HawkbitDdi::executionStatusString[this->_currentExecutionStatus];
-  jsonBuffer["status"]["result"]["finished"] = HawkbitDdi::executionResultString[this->_currentExecutionResult];
-  Serial.println("\nStarting connection to server...");
-  if (!_client.connect(this->_serverName.c_str(), this->_serverPort))
-    Serial.println("Connection failed!");
-  else {
-    Serial.println("Connected to server!");
-    // Make a HTTP request:
-    _client.printf(HawkbitDdi::_postDeploymentBaseFeedback, this->_tenantId.c_str(), this->_controllerId.c_str(), this->_currentActionId);
-    _client.print(this->createHeaders());
-    _client.println("Content-Type: application/json");
-    _client.printf("Content-Length: %d\r\n", measureJson(jsonBuffer));
-    // Close Headers field
-    _client.println();
-    serializeJson(jsonBuffer, _client);
-
-    while (_client.connected()) {
-      String line = _client.readStringUntil('\n');
-      Serial.println(line);
-      if (line == "\r") {
-        Serial.println("headers received");
-        break;
-      }
+/* Retry a failed poll with backoff instead of on every work() call */
+void HawkbitDdi::pollFailed() {
+  this->_active->scheduler.failure(this->_platform->millis());
+  HB_LOG_WARN(this->_log, "Poll failed %d times, next poll: %lu\r\n", this->_active->scheduler.getFailures(), this->_active->scheduler.getNextTime());
+}
+
+/* Extract links and poll interval, the result is cached for conditional polls */
+bool HawkbitDdi::parseController(Stream &body) {
+  t_hb_poll_cache *poll = &this->_active->poll;
+  HawkbitJsonExtractor extractor;
+  this->_links.clear(HB_LINK_CONFIGDATA);
+  this->_links.clear(HB_LINK_DEPLOYMENTBASE);
+  this->_links.clear(HB_LINK_CANCELACTION);
+  this->_linksController = this->_active;
+  poll->interval = 0;
+  poll->cached = extractor.parse(body, HawkbitDdi::onControllerValue, this);
+  poll->links = 0;
+  for (uint8_t link = HB_LINK_CONFIGDATA; link <= HB_LINK_CANCELACTION; link++) {
+    if (this->_links.isSet((HB_LINK)link)) {
+      poll->links |= 1 << link;
     }
-    _client.stop();
   }
+  if (!poll->cached) {
+    HB_LOG_ERROR(this->_log, "Parsing controller resource failed\r\n");
+    poll->etag[0] = '\0';
+  }
+  this->_snapshotPending = true;
+  return poll->cached;
 }
 
-void HawkbitDdi::getCancelAction() {
-  int actionId;
-  splitHref(this->_getCancelActionHref);
-  this->_getCancelActionHref[0] = '\0';
-  Serial.printf("Server: %s:%d, GET %s\r\n", href_param.href_server, href_param.href_port, href_param.href_url);
-  Serial.println("\nStarting connection to server...");
-  if (!_client.connect(href_param.href_server, href_param.href_port)) {
-    Serial.println("Connection failed!");
+/* Whether the links of the cached controller resource are still stored, a
+   gateway keeps them only for the controller it works for. The config data
+   is sent to a fixed path, its link only matters as a flag */
+bool HawkbitDdi::pollLinksKept() {
+  return (this->_active->poll.links & ~(1 << HB_LINK_CONFIGDATA)) == 0 || this->_linksController == this->_active;
+}
+
+void HawkbitDdi::onControllerValue(void *context, const char *path, const char *value) {
+  HawkbitDdi *ddi = (HawkbitDdi *)context;
+  char timeString[16];
+  if (strcmp(path, "config.polling.sleep") == 0) {
+    strncpy(timeString, value, sizeof(timeString) - 1);
+    timeString[sizeof(timeString) - 1] = '\0';
+    ddi->_active->poll.interval = HawkbitDdi::convertTime(timeString);
+  } else if (strcmp(path, "_links.deploymentBase.href") == 0) {
+    ddi->storeLink(HB_LINK_DEPLOYMENTBASE, value);
+  } else if (strcmp(path, "_links.configData.href") == 0) {
+    ddi->storeLink(HB_LINK_CONFIGDATA, value);
+  } else if (strcmp(path, "_links.cancelAction.href") == 0) {
+    ddi->storeLink(HB_LINK_CANCELACTION, value);
+  }
+}
+
+/* Move the current status of the action into the feedback queue */
+void HawkbitDdi::queueFeedback() {
+  /* _activeIndex lags behind while nextController() looks at the others */
+  uint16_t controller = this->_controllerCount > 0 ? (uint16_t)(this->_active - this->_controllers) : 0;
+  this->_jobFeedbackChanged = false;
+  this->_snapshotPending = true;
+  if (this->_active->executionStatus == HB_EX_CANCELED) {
+    /* Confirm the cancellation, this closes the action */
+    this->_feedbackQueue.push(this->_active->actionId, HB_EX_CLOSED, HB_RES_SUCCESS, 0, 0, controller, true);
+    this->_active->executionStatus = HB_EX_CLOSED;
+    this->_active->executionResult = HB_RES_SUCCESS;
+    this->_active->actionId = 0;
+    return;
+  }
+  this->_feedbackQueue.push(this->_active->actionId, this->_active->executionStatus, this->_active->executionResult, 0, 0, controller,
+                            this->_active->executionStatus == HB_EX_CLOSED);
+}
+
+bool HawkbitDdi::postDeploymentBaseFeedback() {
+  char path[48];
+  char details[48];
+  char body[HB_FEEDBACK_BODY_SIZE];
+  HawkbitJsonWriter json(body, sizeof(body));
+  const t_feedback *feedback = this->_feedbackQueue.peek();
+  const char *controllerId = this->feedbackControllerId(feedback);
+  if (controllerId == NULL) {
+    /* The controller is no longer served by the gateway */
+    this->_feedbackQueue.pop();
+    return false;
+  }
+  this->encodeStatus(json, feedback->actionId, feedback->execution, feedback->result);
+  if (feedback->total > 0) {
+    snprintf(details, sizeof(details), "Downloaded %lu of %lu bytes", (unsigned long)feedback->bytes, (unsigned long)feedback->total);
+    json.raw(",\"progress\":{\"cnt\":").number((long)((uint64_t)feedback->bytes * 100 / feedback->total)).raw(",\"of\":100}}");
+    json.raw(",\"details\":[").string(details).raw("]}}");
   } else {
-    Serial.println("Connected to server!");
-    // Make a HTTP request:
-    _client.printf(HawkbitDdi::_getRequest, href_param.href_url);
-    _client.print(this->createHeaders(href_param.href_server));
-    // Close Headers field
-    _client.println();
-
-    while (_client.connected()) {
-      String line = _client.readStringUntil('\n');
-      Serial.println(line);
-      if (line == "\r") {
-        Serial.println("headers received");
-        break;
-      }
+    json.raw("}}}");
+  }
+  if (json.overflow()) {
+    HB_LOG_ERROR(this->_log, "Feedback does not fit into the buffer\r\n");
+    this->_feedbackQueue.pop();
+    return false;
+  }
+  snprintf(path, sizeof(path), HawkbitDdi::_deploymentBaseFeedbackPath, feedback->actionId);
+  return this->sendRequest(this->_serverName.c_str(), this->_serverPort, "POST", controllerId, path, "application/hal+json", body);
+}
+
+void HawkbitDdi::handleDeploymentBaseFeedback(int statusCode) {
+  if (this->isSuccess(statusCode)) {
+    this->finishRequest();
+    this->_feedbackQueue.pop();
+    return;
+  }
+  /* A client error other than a timeout or throttling is returned again for
+     every retry, e.g. when the action no longer exists. The final result is
+     tried a few more times, the restart waits for it */
+  if (statusCode >= 400 && statusCode < 500 && statusCode != 408 && statusCode != 429 && !this->_feedbackQueue.retry()) {
+    HB_LOG_WARN(this->_log, "Dropping feedback rejected by the server\r\n");
+    this->_feedbackQueue.pop();
+    return;
+  }
+  /* Keep the feedback and try again after the next successful poll */
+  this->_feedbackBlocked = true;
+}
+
+bool HawkbitDdi::getCancelAction() {
+  return this->getLink(HB_LINK_CANCELACTION, "application/hal+json", NULL);
+}
+
+void HawkbitDdi::handleCancelAction(int statusCode) {
+  int actionId;
+  this->_cancelActionPending = false;
+  if (this->isSuccess(statusCode)) {
+    HawkbitJsonExtractor extractor;
+    actionId = -1;
+    if (!extractor.parse(this->responseBody(), HawkbitDdi::onCancelActionValue, &actionId)) {
+      HB_LOG_ERROR(this->_log, "Parsing cancel action failed\r\n");
+      this->closeConnection();
+      return;
     }
-    auto error = deserializeJson(jsonBuffer, _client);
-    if (error) {
-      Serial.print(F("deserializeJson() failed with code "));
-      Serial.println(error.c_str());
-      _client.stop();
+    this->finishRequest();
+    if (actionId < 0) {
+      HB_LOG_ERROR(this->_log, "Cancel action without stopId\r\n");
       return;
     }
-
-    // Extract values
-    Serial.println(F("Response:"));
-    serializeJsonPretty(jsonBuffer, Serial);
-    Serial.println();
-    _client.stop();
-    Serial.println("Storing Values");
-    actionId = atoi(jsonBuffer["cancelAction"]["stopId"].as<char *>());
-    if (this->_currentActionId == actionId) {
-      Serial.printf("Canceled Action ID: %d\r\n", this->_currentActionId);
+    /* Drop a partially or completely downloaded image of the canceled action */
+    if (this->_flashStarted || (this->_imageReady && this->_imageController == this->_active)) {
+      this->_flash->abort();
+      this->_flashStarted = false;
+      this->_imageReady = false;
+      this->clearDownloadProgress();
+    }
+    if (this->_active->actionId == actionId) {
+      HB_LOG_INFO(this->_log, "Canceled Action ID: %d\r\n", this->_active->actionId);
       /* Immediately start downloading and updating */
-      this->_currentExecutionStatus = HB_EX_CANCELED;
-      this->_currentExecutionResult = HB_RES_SUCCESS;
+      this->_active->executionStatus = HB_EX_CANCELED;
+      this->_active->executionResult = HB_RES_SUCCESS;
       this->_jobFeedbackChanged = true;
     } else {
-      this->_currentActionId = actionId;
-      Serial.printf("Canceled Action ID: %d\r\n", this->_currentActionId);
+      this->_active->actionId = actionId;
+      HB_LOG_INFO(this->_log, "Canceled Action ID: %d\r\n", this->_active->actionId);
       /* Immediately start downloading and updating */
-      this->_currentExecutionStatus = HB_EX_CANCELED;
-      this->_currentExecutionResult = HB_RES_FAILURE;
+      this->_active->executionStatus = HB_EX_CANCELED;
+      this->_active->executionResult = HB_RES_FAILURE;
       this->_jobFeedbackChanged = true;
     }
   }
-  Serial.println("CancelAction finished");
+  HB_LOG_DEBUG(this->_log, "CancelAction finished\r\n");
 }
 
-void HawkbitDdi::postCancelFeedback() {
-  char timeString[16];
-  if (this->_currentExecutionStatus == HB_EX_CANCELED) {
-    this->_currentExecutionStatus = HB_EX_CLOSED;
-    this->_currentExecutionResult = HB_RES_SUCCESS;
+void HawkbitDdi::onCancelActionValue(void *context, const char *path, const char *value) {
+  if (strcmp(path, "cancelAction.stopId") == 0) {
+    *(int *)context = atoi(value);
+  }
+}
+
+bool HawkbitDdi::putConfigData() {
+  char body[sizeof(this->_configData) + HB_FEEDBACK_BODY_SIZE];
+  HawkbitJsonWriter json(body, sizeof(body));
+  this->_configDataModified = false;
+  this->encodeStatus(json, this->_active->actionId, this->_active->executionStatus, this->_active->executionResult);
+  json.raw("}},\"data\":");
+  this->buildConfigData(json);
+  json.raw(",\"mode\":").string(HawkbitDdi::configDataModeString[this->_configDataMode]).raw("}");
+  if (json.overflow()) {
+    HB_LOG_ERROR(this->_log, "Config data does not fit into the buffer\r\n");
+    return false;
+  }
+  HB_LOG_TRACE(this->_log, "%s\r\n", body);
+  return this->sendRequest(this->_serverName.c_str(), this->_serverPort, "PUT", this->_active->controllerId, HawkbitDdi::_configDataPath, "application/hal+json", body);
+}
+
+void HawkbitDdi::handlePutConfigData(int statusCode) {
+  size_t length = strnlen(this->_configData, sizeof(this->_configData));
+  if (!this->isSuccess(statusCode)) {
+    /* Keep it for this controller and try again after the next successful poll */
+    this->_feedbackBlocked = true;
+    return;
+  }
+  this->finishRequest();
+  /* Data set while the request was on its way is sent with the next one */
+  if (this->_configDataModified) {
+    return;
+  }
+  this->_active->configDataPending = false;
+  if (this->_controllerCount > 0) {
+    this->_active->configDataHash = HawkbitConfigDataTracker::hash(this->_active->controllerId, this->_configData, length);
+    this->_active->configDataRefresh = this->_platform->millis() + HB_CONFIGDATA_REFRESH;
+    return;
+  }
+  this->_configDataTracker.acknowledge(this->_active->controllerId, this->_configData, length);
+  this->_configDataRefresh = this->_platform->millis() + HB_CONFIGDATA_REFRESH;
+}
+
+/* Start of a feedback or config data body up to the open result object:
+   {"id":"..","time":"..","status":{"execution":"..","result":{"finished":"..".
+   The timestamp is left out while the wall clock is not set */
+void HawkbitDdi::encodeStatus(HawkbitJsonWriter &json, int actionId, uint8_t execution, uint8_t result) {
+  char timestamp[24];
+  time_t now = this->_platform->time();
+  struct tm utc;
+  json.raw("{\"id\":\"").number(actionId).raw("\"");
+  if (now >= HB_TIME_VALID && gmtime_r(&now, &utc) != NULL) {
+    /* The modulo bounds the width of each field for the compiler */
+    snprintf(timestamp, sizeof(timestamp), "%04u%02u%02uT%02u%02u%02u",
+             (unsigned)(utc.tm_year + 1900) % 10000U, (unsigned)(utc.tm_mon + 1) % 100U, (unsigned)utc.tm_mday % 100U,
+             (unsigned)utc.tm_hour % 100U, (unsigned)utc.tm_min % 100U, (unsigned)utc.tm_sec % 100U);
+    json.raw(",\"time\":\"").raw(timestamp).raw("\"");
+  }
+  json.raw(",\"status\":{\"execution\":").string(HawkbitDdi::executionStatusString[execution]);
+  json.raw(",\"result\":{\"finished\":").string(HawkbitDdi::executionResultString[result]);
+}
+
+size_t HawkbitDdi::printStats(Print &out) {
+  const t_hb_stats &all = this->getStats();
+  size_t len = 0;
+  len += out.printf("{\"downloadBytes\":%lu,\"downloadTime\":%lu,\"flashWriteTime\":%lu,\"minFreeHeap\":%lu,\"requests\":{",
+                    all.downloadBytes, all.downloadTime, all.flashWriteTime, (unsigned long)all.minFreeHeap);
+  for (int i = HB_REQ_NONE + 1; i < HB_REQ_MAX; i++) {
+    const t_hb_request_stats *stats = &all.requests[i];
+    len += out.printf("%s\"%s\":{\"count\":%lu,\"failures\":%lu,\"connectTime\":%lu,\"firstByteTime\":%lu,"
+                      "\"headerTime\":%lu,\"bodyTime\":%lu,\"bytesOut\":%lu,\"bytesIn\":%lu}",
+                      i > HB_REQ_NONE + 1 ? "," : "", HawkbitDdi::requestTypeString[i], stats->count, stats->failures,
+                      stats->connectTime, stats->firstByteTime, stats->headerTime, stats->bodyTime, stats->bytesOut, stats->bytesIn);
+  }
+  len += out.println("}}");
+  return len;
+}
+
+/* The application's config data, optionally with a summary of the statistics
+   appended as further attributes. A merge only contains the attributes that
+   changed since the server acknowledged them */
+void HawkbitDdi::buildConfigData(HawkbitJsonWriter &json) {
+  size_t length = strnlen(this->_configData, sizeof(this->_configData));
+  const char *separator = ",";
+  const char *end;
+  const char *last;
+  if (this->_configDataMode == HB_CONFIGDATA_MERGE) {
+    HawkbitBufferStream stream;
+    HawkbitJsonExtractor extractor;
+    t_config_merge merge = { this, &json, true };
+    json.raw("{");
+    stream.begin(this->_configData, length);
+    extractor.parse(stream, HawkbitDdi::onConfigDataValue, &merge);
+    this->appendStats(json, merge.first ? "" : ",");
+    json.raw("}");
+    return;
+  }
+  if (!this->_statsInConfigData) {
+    json.raw(length > 0 ? this->_configData : "{}", length > 0 ? length : 2);
+    return;
+  }
+  /* Reopen the object of the application's config data */
+  end = this->_configData + length;
+  while (end > this->_configData && *(end - 1) != '}') {
+    end--;
+  }
+  if (end == this->_configData) {
+    json.raw("{");
+    separator = "";
   } else {
-    this->_currentExecutionStatus = HB_EX_CLOSED;
-    this->_currentExecutionResult = HB_RES_FAILURE;
-  }
-  jsonBuffer.clear();
-  jsonBuffer["id"] = String(this->_currentActionId);
-  jsonBuffer["time"] = "20190511T121314";
-  jsonBuffer["status"]["execution"] = HawkbitDdi::executionStatusString[this->_currentExecutionStatus];
-  jsonBuffer["status"]["result"]["finished"] = HawkbitDdi::executionResultString[this->_currentExecutionResult];
-  Serial.println("\nStarting connection to server...");
-  if (!_client.connect(this->_serverName.c_str(), this->_serverPort))
-    Serial.println("Connection failed!");
-  else {
-    Serial.println("Connected to server!");
-    // Make a HTTP request:
-    _client.printf(HawkbitDdi::_postDeploymentBaseFeedback, this->_tenantId.c_str(), this->_controllerId.c_str(), this->_currentActionId);
-    _client.print(this->createHeaders());
-    _client.println("Content-Type: application/json");
-    _client.printf("Content-Length: %d\r\n", measureJson(jsonBuffer));
-    // Close Headers field
-    _client.println();
-    serializeJson(jsonBuffer, _client);
-
-    while (_client.connected()) {
-      String line = _client.readStringUntil('\n');
-      Serial.println(line);
-      if (line == "\r") {
-        Serial.println("headers received");
-        break;
-      }
+    end--;
+    last = end;
+    while (last > this->_configData && isspace(*(last - 1))) {
+      last--;
     }
-    // if there are incoming bytes available
-    // from the server, read them and print them:
-    while (_client.available()) {
-      char c = _client.read();
-      Serial.write(c);
+    if (last > this->_configData && *(last - 1) == '{') {
+      separator = "";
     }
-    _client.stop();
+    json.raw(this->_configData, end - this->_configData);
   }
-  this->_currentActionId = 0;
+  this->appendStats(json, separator);
+  json.raw("}");
 }
 
-void HawkbitDdi::putConfigData() {
-  this->putConfigData(HB_CONFIGDATA_MERGE);
+void HawkbitDdi::onConfigDataValue(void *context, const char *path, const char *value) {
+  t_config_merge *merge = (t_config_merge *)context;
+  if (!merge->ddi->_configDataTracker.changed(path, value)) {
+    return;
+  }
+  merge->json->raw(merge->first ? "" : ",").string(path).raw(":").string(value);
+  merge->first = false;
 }
 
-void HawkbitDdi::putConfigData(HB_CONFIGDATA_MODE cf_mode) {
-  char timeString[16];
-  jsonBuffer.clear();
-  jsonBuffer["id"] = String(this->_currentActionId);
-  jsonBuffer["time"] = "20190511T121314";
-  jsonBuffer["status"]["execution"] = HawkbitDdi::executionStatusString[this->_currentExecutionStatus];
-  jsonBuffer["status"]["result"]["finished"] = HawkbitDdi::executionResultString[this->_currentExecutionResult];
-  jsonBuffer["data"] = serialized(this->_configData);
-  jsonBuffer["mode"] = HawkbitDdi::configDataModeString[cf_mode];
-  Serial.println("\nStarting connection to server...");
-  if (!_client.connect(this->_serverName.c_str(), this->_serverPort))
-    Serial.println("Connection failed!");
-  else {
-    Serial.println("Connected to server!");
-    // Make a HTTP request:
-    _client.printf(HawkbitDdi::_putConfigData, this->_tenantId.c_str(), this->_controllerId.c_str());
-    _client.print(this->createHeaders());
-    _client.println("Content-Type: application/json");
-    _client.printf("Content-Length: %d\r\n", measureJson(jsonBuffer));
-    // Close Headers field
-    _client.println();
-    serializeJson(jsonBuffer, _client);
-    serializeJsonPretty(jsonBuffer, Serial);
-
-    while (_client.connected()) {
-      String line = _client.readStringUntil('\n');
-      Serial.println(line);
-      if (line == "\r") {
-        Serial.println("headers received");
-        break;
-      }
-    }
-    _client.stop();
+/* Summary of the statistics as config data attributes */
+void HawkbitDdi::appendStats(HawkbitJsonWriter &json, const char *separator) {
+#if HB_STATS
+  unsigned long requests = 0;
+  unsigned long connectTime = 0;
+  unsigned long firstByteTime = 0;
+  if (!this->_statsInConfigData) {
+    return;
+  }
+  for (int i = HB_REQ_NONE + 1; i < HB_REQ_MAX; i++) {
+    requests += this->_stats.requests[i].count;
+    connectTime += this->_stats.requests[i].connectTime;
+    firstByteTime += this->_stats.requests[i].firstByteTime;
   }
+  json.raw(separator);
+  json.raw("\"hbRequests\":\"").number(requests);
+  json.raw("\",\"hbConnectMs\":\"").number(requests > 0 ? connectTime / requests : 0);
+  json.raw("\",\"hbFirstByteMs\":\"").number(requests > 0 ? firstByteTime / requests : 0);
+  json.raw("\",\"hbDownloadBps\":\"").number(this->_stats.downloadTime > 0 ? (unsigned long)((uint64_t)this->_stats.downloadBytes * 1000 / this->_stats.downloadTime) : 0);
+  json.raw("\",\"hbFlashWriteMs\":\"").number(this->_stats.flashWriteTime);
+  json.raw("\",\"hbMinFreeHeap\":\"").number(this->_stats.minFreeHeap).raw("\"");
+#endif
 }
 
 unsigned long HawkbitDdi::convertTime(char *timeString) {
@@ -659,5 +1889,9 @@ unsigned long HawkbitDdi::convertTime(char *timeString) {
 }
 
 unsigned long HawkbitDdi::convertTime(String timeString) {
-  return HawkbitDdi::convertTime(timeString.c_str());
+  /* strtok() needs a writable copy, c_str() would select this overload again */
+  char buffer[16];
+  strncpy(buffer, timeString.c_str(), sizeof(buffer) - 1);
+  buffer[sizeof(buffer) - 1] = '\0';
+  return HawkbitDdi::convertTime(buffer);
 }
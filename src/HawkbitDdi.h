@@ -27,9 +27,20 @@
 #define ___HAWKBIT_DDI_H___
 
 #include <Arduino.h>
-#include <ArduinoJson.h>
-#include <WiFiClientSecure.h>
-#include <Update.h>
+#include "HawkbitPlatform.h"
+#include "HawkbitConfigData.h"
+#include "HawkbitHttp.h"
+#include "HawkbitJson.h"
+#include "HawkbitHash.h"
+#include "HawkbitFeedback.h"
+#include "HawkbitLinks.h"
+#include "HawkbitPipeline.h"
+#include "HawkbitScheduler.h"
+#include "HawkbitSessionCache.h"
+#include "HawkbitUrl.h"
+#ifdef ARDUINO_ARCH_ESP32
+#include "HawkbitEsp32.h"
+#endif
 
 enum HB_SECURITY_TYPE {
   HB_SEC_CLIENTCERTIFICATE,
@@ -46,6 +57,7 @@ enum HB_EXECUTION_STATUS {
   HB_EX_PROCEEDING,
   HB_EX_SCHEDULED,
   HB_EX_RESUMED,
+  HB_EX_DOWNLOADED,
   HB_EX_MAX
 };
 
@@ -71,6 +83,171 @@ enum HB_DEPLOYMENT_MODE {
   HB_DEPLOYMENT_MAX
 };
 
+/* Progress of the request handled by work() */
+enum HB_WORK_STATE {
+  HB_STATE_IDLE,
+  HB_STATE_RESPONSE,
+  HB_STATE_BODY,
+  HB_STATE_DOWNLOAD,
+  HB_STATE_MAX
+};
+
+enum HB_REQUEST_TYPE {
+  HB_REQ_NONE,
+  HB_REQ_POLL,
+  HB_REQ_CONFIGDATA,
+  HB_REQ_DEPLOYMENTBASE,
+  HB_REQ_CANCELACTION,
+  HB_REQ_FEEDBACK,
+  HB_REQ_DOWNLOAD,
+  HB_REQ_MAX
+};
+
+/* Collect the timing and traffic statistics returned by getStats(),
+   set to 0 to compile them out */
+#ifndef HB_STATS
+#define HB_STATS 1
+#endif
+
+/* Statistics per request type, times are sums in ms */
+typedef struct str_hb_request_stats {
+  unsigned long count;
+  /* Requests without response or with an error status */
+  unsigned long failures;
+  /* DNS lookup, TCP connect and TLS handshake, done in one call by the transport */
+  unsigned long connectTime;
+  unsigned long firstByteTime;
+  unsigned long headerTime;
+  /* Handling the response, i.e. parsing the body */
+  unsigned long bodyTime;
+  unsigned long bytesOut;
+  unsigned long bytesIn;
+} t_hb_request_stats;
+
+typedef struct str_hb_stats {
+  t_hb_request_stats requests[HB_REQ_MAX];
+  unsigned long downloadBytes;
+  /* Time from the start of the artifact bodies to their last byte */
+  unsigned long downloadTime;
+  unsigned long flashWriteTime;
+  /* Lowest free heap seen after a request, 0 if the platform cannot tell */
+  uint32_t minFreeHeap;
+} t_hb_stats;
+
+/* Time in ms a single work() call may spend before it returns */
+#ifndef HB_WORK_BUDGET
+#define HB_WORK_BUDGET 20UL
+#endif
+
+/* Time in ms an idle kept-alive connection stays open for a poll that is
+   due within it, e.g. of the next controller of a gateway. A shorter idle
+   timeout announced by the server is used instead */
+#ifndef HB_KEEPALIVE_HOLD
+#define HB_KEEPALIVE_HOLD 2000UL
+#endif
+
+/* Time in ms to wait for a response or further download data */
+#ifndef HB_RESPONSE_TIMEOUT
+#define HB_RESPONSE_TIMEOUT 10000UL
+#endif
+
+/* Smallest download segment when progress feedback is enabled */
+#ifndef HB_PROGRESS_BYTES
+#define HB_PROGRESS_BYTES 262144UL
+#endif
+
+/* Minimum time between two progress feedbacks in ms */
+#ifndef HB_PROGRESS_INTERVAL
+#define HB_PROGRESS_INTERVAL 10000UL
+#endif
+
+/* Largest response body that is collected before it is parsed, so that
+   work() does not wait for the rest of it. A controller resource up to this
+   size is also compared with the last poll if the server sends no ETag */
+#ifndef HB_BODY_BUFFER_SIZE
+#define HB_BODY_BUFFER_SIZE 1024
+#endif
+
+/* Feedback body without the config data, also added to the config data body */
+#ifndef HB_FEEDBACK_BODY_SIZE
+#define HB_FEEDBACK_BODY_SIZE 384
+#endif
+
+/* Time in ms after which unchanged config data is sent again if the server
+   asks for it */
+#ifndef HB_CONFIGDATA_REFRESH
+#define HB_CONFIGDATA_REFRESH 86400000UL
+#endif
+
+/* Bytes read from the connection per flash write while downloading */
+#ifndef HB_DOWNLOAD_CHUNK_SIZE
+#define HB_DOWNLOAD_CHUNK_SIZE 1024
+#endif
+
+/* Download attempts per artifact before the action is closed as failed */
+#ifndef HB_DOWNLOAD_MAX_ATTEMPTS
+#define HB_DOWNLOAD_MAX_ATTEMPTS 5
+#endif
+
+/* Delay before an interrupted download is continued in ms */
+#ifndef HB_DOWNLOAD_RETRY_DELAY
+#define HB_DOWNLOAD_RETRY_DELAY 10000UL
+#endif
+
+/* Bytes between two saves of the download progress to storage */
+#ifndef HB_DOWNLOAD_SAVE_INTERVAL
+#define HB_DOWNLOAD_SAVE_INTERVAL 65536UL
+#endif
+
+/* Longest ETag kept for conditional polls, a controller resource with a
+   longer one is compared by its body instead */
+#ifndef HB_POLL_ETAG_SIZE
+#define HB_POLL_ETAG_SIZE 32
+#endif
+
+/* Validators of the controller resource last parsed for a controller */
+typedef struct str_hb_poll_cache {
+  char etag[HB_POLL_ETAG_SIZE];
+  uint32_t bodyHash;
+  int32_t bodyLength;
+  /* Poll interval requested by the server, 0 for the default */
+  uint32_t interval;
+  /* Links the resource contained, one bit per HB_LINK */
+  uint8_t links;
+  bool cached;
+} t_hb_poll_cache;
+
+/* Poll state kept over deep sleep in memory that is retained, e.g. a
+   RTC_DATA_ATTR variable on ESP32. Only used by the library */
+typedef struct str_hb_retained_state {
+  uint32_t magic;
+  uint32_t pollInterval;
+  /* Sleep time in ms and wall clock time in s when it started, 0 if unknown */
+  uint32_t sleepTime;
+  uint32_t sleepStart;
+  HawkbitScheduler scheduler;
+} t_hb_retained_state;
+
+/* State of one controller served by the gateway, see setGateway().
+   controllerId and sink are set by the application, the rest by the library */
+typedef struct str_hb_controller {
+  const char *controllerId;
+  /* Flash sink for the artifacts of this controller, NULL for the one of begin() */
+  HawkbitFlashSink *sink;
+  HawkbitScheduler scheduler;
+  unsigned long jobSchedule;
+  int actionId;
+  HB_EXECUTION_STATUS executionStatus;
+  HB_EXECUTION_RESULT executionResult;
+  t_hb_poll_cache poll;
+  /* Hash of the config data the server acknowledged for this controller of
+     a gateway, the attributes of a single controller are tracked in detail */
+  uint32_t configDataHash;
+  unsigned long configDataRefresh;
+  /* Config data has to be sent or checked, until the server acknowledges it */
+  bool configDataPending;
+} t_hb_controller;
+
 class HawkbitDdi
 {
   public:
@@ -80,20 +257,139 @@ class HawkbitDdi
     ~HawkbitDdi(void);
 
     /* Public member methods */
+#ifdef ARDUINO_ARCH_ESP32
     void begin(WiFiClientSecure client);
+#endif
+    void begin(HawkbitTransport *transport, HawkbitFlashSink *flash, HawkbitPlatform *platform, HawkbitStorage *storage = NULL);
 
     int work();
 
+    /* Serve several controllers with one instance and connection, e.g. on a
+       gateway for attached devices. They are polled in turn, one action is
+       processed at a time. Has to be set before begin() */
+    void setGateway(t_hb_controller *controllers, size_t count) {
+      this->_controllers = controllers;
+      this->_controllerCount = count;
+    }
+
+    /* Continue the poll schedule stored with prepareSleep() after waking up
+       from deep sleep. Has to be set before begin() */
+    void setRetainedState(t_hb_retained_state *state) {
+      this->_retainedState = state;
+    }
+
+    /* Time in ms until work() has to be called again, 0 while a request or
+       action is in progress */
+    unsigned long getSleepTime();
+
+    /* Close the connection and store the poll state for deep sleep. Returns
+       the time in ms the device may sleep, 0 if it must stay awake */
+    unsigned long prepareSleep(t_hb_retained_state *state);
+
+    /* Limit the time a single work() call spends on requests and downloading */
+    void setWorkBudget(unsigned long budget) {
+      this->_workBudget = budget;
+    }
+
+    HB_WORK_STATE getWorkState() {
+        return this->_workState;
+    }
+
+    /* Send all requests of a poll cycle over one persistent connection per host */
+    void setKeepAlive(bool keepAlive) {
+      this->_keepAlive = keepAlive;
+    }
+
+    /* Write the firmware image to flash in a separate task while the next
+       block is downloaded. Has to be set before begin() */
+    void setDownloadPipeline(bool pipeline) {
+      this->_downloadPipeline = pipeline;
+    }
+
+    /* Download the artifact of a deployment that may be installed later
+       ("attempt") right away, but only install it after installUpdate(), e.g.
+       at a maintenance moment chosen by the application */
+    void setDownloadAhead(bool downloadAhead) {
+      this->_downloadAhead = downloadAhead;
+    }
+
+    /* Whether a downloaded update waits for installUpdate() */
+    bool isUpdateDownloaded() {
+      return this->_imageReady && this->_imageController->executionStatus == HB_EX_DOWNLOADED;
+    }
+
+    /* Allow installing the downloaded update, the device reboots once the
+       server has been told */
+    void installUpdate() {
+      this->_installApproved = true;
+    }
+
+    /* Report the download progress to the server with "proceeding" feedback.
+       The artifact is then downloaded in Range segments that end about when
+       the next report is due, at least HB_PROGRESS_BYTES. Without keep-alive
+       each segment and report opens a connection of its own */
+    void setProgressFeedback(bool progress) {
+      this->_progressFeedback = progress;
+    }
+
+    /* Send the log output to another sink than the one of the platform.
+       The amount of output is set at compile time with HB_LOG_LEVEL */
+    void setLog(Print *log) {
+      this->_log = log;
+    }
+
+    /* Add a summary of the statistics to the config data sent to the server.
+       It is sent along when the config data changed or is refreshed */
+    void setStatsInConfigData(bool statsInConfigData) {
+      this->_statsInConfigData = statsInConfigData;
+    }
+
+    /* All zero if HB_STATS is 0 */
+    const t_hb_stats &getStats() {
+#if HB_STATS
+      return this->_stats;
+#else
+      static const t_hb_stats none = {};
+      return none;
+#endif
+    }
+
+    /* Write the statistics as one line of JSON, e.g. for a benchmark log */
+    size_t printStats(Print &out);
+
+    void resetStats() {
+#if HB_STATS
+      memset(&this->_stats, 0, sizeof(this->_stats));
+#endif
+    }
+
+    /* Attributes of the device as flat JSON object. Only the attributes that
+       changed since the server acknowledged them are sent */
     void setConfigData(char *jsonString) {
-      strncpy(this->_configData, jsonString, sizeof(this->_configData));
+      strncpy(this->_configData, jsonString, sizeof(this->_configData) - 1);
+      this->_configData[sizeof(this->_configData) - 1] = '\0';
+      this->_configDataModified = true;
+      this->_ownController.configDataPending = true;
+      for (size_t i = 0; i < this->_controllerCount; i++) {
+        this->_controllers[i].configDataPending = true;
+      }
     }
 
     bool isIdle() {
-        return this->_currentExecutionStatus <= 0;
+        return this->_active->executionStatus <= 0;
     }
 
-    unsigned long getNextPoll() {
-        return this->_nextPoll;
+    /* Earliest poll of all controllers */
+    unsigned long getNextPoll();
+
+    /* Connections that could resume a cached TLS session */
+    unsigned long getTlsSessionHits() {
+        return this->_sessionCache.getHits();
+    }
+
+    /* Connections that needed a full TLS handshake */
+    unsigned long getTlsSessionMisses() {
+        return this->_sessionCache.getMisses();
     }
 
   protected:
@@ -105,52 +401,178 @@ class HawkbitDdi
     static const char *executionResultString[];
     static const char *configDataModeString[];
     static const char *deploymentModeString[];
-    static const char *_getRequest;
-    static const char *_getRootController;
-    static const char *_putConfigData;
-    static const char *_postDeploymentBaseFeedback;
+    static const char *requestTypeString[];
+    static const char *_configDataPath;
+    static const char *_deploymentBaseFeedbackPath;
     /* private static member methods */
     static unsigned long convertTime(char *timeString);
     static unsigned long convertTime(String timeString);
 
     /* private member attributes */
-    char _putConfigDataHref[512];
-    char _getDeploymentBaseHref[512];
-    char _getCancelActionHref[512];
-    char _getSoftwareModuleHref[1024];
+    HawkbitLinkStore _links;
+    /* Controller the links were parsed for, they are dropped for another one */
+    t_hb_controller *_linksController = NULL;
     char _configData[512];
+    bool _deploymentBasePending = false;
+    bool _cancelActionPending = false;
 
-    unsigned long _nextPoll = 0;
-    /* Default the pollInterval to 5 Minutes */
-    unsigned long _pollInterval = 300000UL;
-    unsigned long _jobSchedule;
+    /* State of the single controller when not used as gateway */
+    t_hb_controller _ownController;
+    /* Controller the current requests are made for */
+    t_hb_controller *_active = &_ownController;
+    t_hb_retained_state *_retainedState = NULL;
+    t_hb_controller *_controllers = NULL;
+    size_t _controllerCount = 0;
+    uint16_t _activeIndex = 0;
     bool _jobFeedbackChanged = false;
-    int _currentActionId = -1;
+    HawkbitFeedbackQueue _feedbackQueue;
+    /* Set when feedback or config data could not be delivered, until the next
+       successful poll */
+    bool _feedbackBlocked = false;
     unsigned long _updateSize;
-    WiFiClientSecure _client;
+    char _artifactMd5[33];
+    char _artifactSha1[41];
+    char _artifactSha256[65];
+    HawkbitHash _imageHash;
+    size_t _downloadOffset = 0;
+    uint8_t _downloadAttempts = 0;
+    bool _flashStarted = false;
+    size_t _lastSavedOffset = 0;
+    unsigned long _lastDataTime = 0;
+    bool _progressFeedback = false;
+    bool _downloadAhead = false;
+    /* Verified image waiting to be activated */
+    bool _imageReady = false;
+    t_hb_controller *_imageController = NULL;
+    bool _installApproved = false;
+    unsigned long _lastProgressTime = 0;
+    /* Download segment in progress, a size of 0 is the rest of the artifact.
+       The duration is set once it is complete */
+    size_t _segmentOffset = 0;
+    size_t _segmentSize = 0;
+    unsigned long _segmentStart = 0;
+    unsigned long _segmentDuration = 0;
+    HB_WORK_STATE _workState = HB_STATE_IDLE;
+    HB_REQUEST_TYPE _requestType = HB_REQ_NONE;
+    unsigned long _workBudget = HB_WORK_BUDGET;
+    unsigned long _requestTime = 0;
+    bool _requestReused = false;
+    bool _requestRetried = false;
+    bool _responseStarted = false;
+    /* Set when the state kept in storage is outdated */
+    bool _snapshotPending = false;
+    bool _configDataModified = false;
+    unsigned long _configDataRefresh = 0;
+    HawkbitConfigDataTracker _configDataTracker;
+#if HB_STATS
+    t_hb_stats _stats;
+#endif
+    bool _statsInConfigData = false;
+    unsigned long _firstByteTime = 0;
+    HB_CONFIGDATA_MODE _configDataMode = HB_CONFIGDATA_MERGE;
+#ifdef ARDUINO_ARCH_ESP32
+    HawkbitEsp32Transport _esp32Transport;
+    HawkbitEsp32FlashSink _esp32Flash;
+    HawkbitEsp32Platform _esp32Platform;
+    HawkbitEsp32Storage _esp32Storage;
+#endif
+    HawkbitTransport *_transport = NULL;
+    HawkbitFlashSink *_flash = NULL;
+    HawkbitPipelinedFlashSink _pipelinedFlash;
+    bool _downloadPipeline = false;
+    HawkbitPlatform *_platform = NULL;
+    HawkbitStorage *_storage = NULL;
+    Print *_log = NULL;
+    HawkbitHttpResponse _response;
+    HawkbitBodyStream _body;
+    /* Small bodies are collected across work() calls before they are handled */
+    char _bufferedBody[HB_BODY_BUFFER_SIZE];
+    size_t _bufferedLength = 0;
+    bool _bodyBuffered = false;
+    HawkbitBufferStream _bufferedStream;
+    HawkbitSessionCache _sessionCache;
+    bool _keepAlive = false;
+    bool _connectionReusable = false;
+    char _connectedServer[HB_URL_HOST_SIZE];
+    uint16_t _connectedPort = 0;
+    unsigned long _keepAliveTimeout = 0;
+    unsigned long _lastResponseTime = 0;
     uint16_t _serverPort;
     String _serverName;
     String _tenantId;
     String _controllerId;
     String _securityToken;
+    /* Parts of the requests that do not change after begin() */
+    String _controllerBasePath;
+    String _authorizationHeader;
     HB_SECURITY_TYPE _securityType;
-    HB_EXECUTION_STATUS _currentExecutionStatus;
-    HB_EXECUTION_RESULT _currentExecutionResult;
     HB_DEPLOYMENT_MODE _currentDeploymentMode;
+    HB_DEPLOYMENT_MODE _currentDownloadMode = HB_DEPLOYMENT_NONE;
 
     /* private member methods */
-    void pollController();
-    void putConfigData();
-    void putConfigData(HB_CONFIGDATA_MODE cf_mode);
-    void getDeploymentBase();
-    void postDeploymentBaseFeedback();
-    void getCancelAction();
-    void postCancelFeedback();
-    void getAndInstallUpdateImage();
+    bool step(unsigned long start);
+    bool resumeRetainedState();
+    void saveSnapshot();
+    bool loadSnapshot(struct str_hb_snapshot *snapshot);
+    void restorePollCache(const struct str_hb_snapshot *snapshot);
+    void restoreSnapshot();
+    void resetController(t_hb_controller *controller);
+    void activateController(uint16_t index);
+    const char *feedbackControllerId(const t_feedback *feedback);
+    HB_REQUEST_TYPE nextController();
+    bool budgetExceeded(unsigned long start);
+    HB_REQUEST_TYPE nextRequest();
+    bool startRequest(HB_REQUEST_TYPE type);
+    void handleResponse(int statusCode);
+    bool pollController();
+    void handlePollController(int statusCode);
+    bool parseController(Stream &body);
+    bool pollLinksKept();
+    void pollFailed();
+    bool putConfigData();
+    void handlePutConfigData(int statusCode);
+    bool configDataNeeded();
+    bool configDataWaiting();
+    void buildConfigData(HawkbitJsonWriter &json);
+    void appendStats(HawkbitJsonWriter &json, const char *separator);
+    static void onConfigDataValue(void *context, const char *path, const char *value);
+    void encodeStatus(HawkbitJsonWriter &json, int actionId, uint8_t execution, uint8_t result);
+    bool getDeploymentBase();
+    void handleDeploymentBase(int statusCode);
+    void queueFeedback();
+    bool postDeploymentBaseFeedback();
+    void handleDeploymentBaseFeedback(int statusCode);
+    bool getCancelAction();
+    void handleCancelAction(int statusCode);
+    bool getAndInstallUpdateImage();
+    void handleUpdateImage(int statusCode);
+    bool receiveImage(unsigned long start);
+    void finishSegment();
+    size_t nextSegmentSize();
+    void interruptImage(bool flashOk);
+    bool startImage();
+    bool hashWrittenImage(size_t length);
+    HB_HASH_TYPE artifactHashType();
+    void finishImage();
+    void installImage();
+    void saveDownloadProgress();
+    void clearDownloadProgress();
     static HB_DEPLOYMENT_MODE parseDeploymentMode(const char *deploymentmode);
-    char * createHeaders();
-    char * createHeaders(const char *serverName);
-    char * createHeaders(const char *serverName, const char *acceptType);
+    static void onControllerValue(void *context, const char *path, const char *value);
+    static void onDeploymentBaseValue(void *context, const char *path, const char *value);
+    static void onCancelActionValue(void *context, const char *path, const char *value);
+    bool holdConnection();
+    bool canReuseConnection(const char *serverName, uint16_t serverPort);
+    bool connectServer(const char *serverName, uint16_t serverPort);
+    void closeConnection();
+    bool sendRequest(const char *serverName, uint16_t serverPort, const char *method, const char *controllerId, const char *path, const char *acceptType, const char *jsonBody, const char *extraHeaders = NULL);
+    bool receiveResponse();
+    bool receiveBody();
+    Stream &responseBody();
+    bool getLink(HB_LINK link, const char *acceptType, const char *extraHeaders);
+    void storeLink(HB_LINK link, const char *href);
+    bool isSuccess(int statusCode);
+    void finishRequest();
 
 };
 
@@ -0,0 +1,144 @@
+/**
+
+   @file HawkbitEsp32.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "HawkbitEsp32.h"
+
+#ifdef ARDUINO_ARCH_ESP32
+
+/* WiFiClientSecure runs the complete handshake inside connect() and neither
+   accepts nor exports a session, so the session hooks keep their defaults */
+bool HawkbitEsp32Transport::connect(const char *serverName, uint16_t serverPort) {
+  return this->_client.connect(serverName, serverPort) > 0;
+}
+
+bool HawkbitEsp32Transport::connected() {
+  return this->_client.connected();
+}
+
+void HawkbitEsp32Transport::stop() {
+  this->_client.stop();
+}
+
+int HawkbitEsp32Transport::available() {
+  return this->_client.available();
+}
+
+int HawkbitEsp32Transport::read() {
+  return this->_client.read();
+}
+
+int HawkbitEsp32Transport::peek() {
+  return this->_client.peek();
+}
+
+size_t HawkbitEsp32Transport::readBytes(char *buffer, size_t length) {
+  return this->_client.readBytes(buffer, length);
+}
+
+size_t HawkbitEsp32Transport::write(uint8_t data) {
+  return this->_client.write(data);
+}
+
+size_t HawkbitEsp32Transport::write(const uint8_t *buffer, size_t size) {
+  return this->_client.write(buffer, size);
+}
+
+void HawkbitEsp32Transport::flush() {
+  this->_client.flush();
+}
+
+bool HawkbitEsp32FlashSink::begin(size_t size) {
+  return Update.begin(size, U_FLASH);
+}
+
+size_t HawkbitEsp32FlashSink::write(uint8_t *data, size_t len) {
+  return Update.write(data, len);
+}
+
+bool HawkbitEsp32FlashSink::end() {
+  return Update.end();
+}
+
+bool HawkbitEsp32FlashSink::isFinished() {
+  return Update.isFinished();
+}
+
+void HawkbitEsp32FlashSink::abort() {
+  Update.abort();
+}
+
+int HawkbitEsp32FlashSink::getError() {
+  return Update.getError();
+}
+
+size_t HawkbitEsp32Storage::load(const char *key, void *data, size_t len) {
+  size_t readLen = 0;
+  if (this->_preferences.begin("hawkbit", true)) {
+    if (this->_preferences.getBytesLength(key) == len) {
+      readLen = this->_preferences.getBytes(key, data, len);
+    }
+    this->_preferences.end();
+  }
+  return readLen;
+}
+
+bool HawkbitEsp32Storage::save(const char *key, const void *data, size_t len) {
+  bool saved = false;
+  if (this->_preferences.begin("hawkbit", false)) {
+    saved = this->_preferences.putBytes(key, data, len) == len;
+    this->_preferences.end();
+  }
+  return saved;
+}
+
+void HawkbitEsp32Storage::remove(const char *key) {
+  if (this->_preferences.begin("hawkbit", false)) {
+    this->_preferences.remove(key);
+    this->_preferences.end();
+  }
+}
+
+unsigned long HawkbitEsp32Platform::millis() {
+  return ::millis();
+}
+
+Print &HawkbitEsp32Platform::log() {
+  return Serial;
+}
+
+void HawkbitEsp32Platform::restart() {
+  ESP.restart();
+}
+
+/* Set by SNTP, e.g. after configTime() */
+time_t HawkbitEsp32Platform::time() {
+  return ::time(NULL);
+}
+
+uint32_t HawkbitEsp32Platform::freeHeap() {
+  return ESP.getFreeHeap();
+}
+
+#endif /* ARDUINO_ARCH_ESP32 */
@@ -0,0 +1,99 @@
+/**
+
+   @file HawkbitEsp32.h
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#ifndef ___HAWKBIT_ESP32_H___
+#define ___HAWKBIT_ESP32_H___
+
+#ifdef ARDUINO_ARCH_ESP32
+
+#include <Arduino.h>
+#include <WiFiClientSecure.h>
+#include <Update.h>
+#include <Preferences.h>
+#include "HawkbitPlatform.h"
+
+/* Transport using the WiFiClientSecure passed to HawkbitDdi::begin() */
+class HawkbitEsp32Transport : public HawkbitTransport
+{
+  public:
+    void setClient(WiFiClientSecure client) {
+      this->_client = client;
+    }
+
+    bool connect(const char *serverName, uint16_t serverPort) override;
+    bool connected() override;
+    void stop() override;
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t readBytes(char *buffer, size_t length) override;
+    size_t write(uint8_t data) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    void flush() override;
+
+  private:
+    WiFiClientSecure _client;
+};
+
+/* Flash sink writing to the inactive OTA partition with the Update library.
+   Update cannot continue a partially written partition after a reboot, so
+   interrupted downloads are only continued within the same boot */
+class HawkbitEsp32FlashSink : public HawkbitFlashSink
+{
+  public:
+    bool begin(size_t size) override;
+    size_t write(uint8_t *data, size_t len) override;
+    bool end() override;
+    bool isFinished() override;
+    void abort() override;
+    int getError() override;
+};
+
+/* Storage in the "hawkbit" namespace of the NVS partition */
+class HawkbitEsp32Storage : public HawkbitStorage
+{
+  public:
+    size_t load(const char *key, void *data, size_t len) override;
+    bool save(const char *key, const void *data, size_t len) override;
+    void remove(const char *key) override;
+
+  private:
+    Preferences _preferences;
+};
+
+class HawkbitEsp32Platform : public HawkbitPlatform
+{
+  public:
+    unsigned long millis() override;
+    Print &log() override;
+    void restart() override;
+    time_t time() override;
+    uint32_t freeHeap() override;
+};
+
+#endif /* ARDUINO_ARCH_ESP32 */
+
+#endif /* ___HAWKBIT_ESP32_H___ */
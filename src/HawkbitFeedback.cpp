@@ -0,0 +1,139 @@
+/**
+
+   @file HawkbitFeedback.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "HawkbitFeedback.h"
+
+/* Layout of the queue in storage */
+typedef struct str_feedback_store {
+  uint8_t count;
+  t_feedback entries[HB_FEEDBACK_QUEUE_SIZE];
+} t_feedback_store;
+
+void HawkbitFeedbackQueue::begin(HawkbitStorage *storage) {
+  t_feedback_store store;
+  this->_storage = storage;
+  this->_count = 0;
+  if (storage == NULL || storage->load("feedback", &store, sizeof(store)) != sizeof(store) ||
+      store.count > HB_FEEDBACK_QUEUE_SIZE) {
+    return;
+  }
+  memcpy(this->_entries, store.entries, sizeof(this->_entries));
+  this->_count = store.count;
+}
+
+void HawkbitFeedbackQueue::push(int actionId, uint8_t execution, uint8_t result, uint32_t bytes, uint32_t total,
+                                uint16_t controller, bool final) {
+  t_feedback *entry;
+  bool stored = total == 0;
+  uint8_t i;
+  for (i = 0; i < this->_count; i++) {
+    if (this->_entries[i].actionId == actionId) {
+      stored = stored || isStored(&this->_entries[i]);
+      this->remove(i);
+      break;
+    }
+  }
+  if (this->_count >= HB_FEEDBACK_QUEUE_SIZE) {
+    /* Give up on the oldest action that is not closed yet */
+    i = 0;
+    while (i < this->_count && this->_entries[i].final) {
+      i++;
+    }
+    if (i == this->_count) {
+      /* Only final results are left, they are kept instead of a newer status */
+      if (!final) {
+        return;
+      }
+      i = 0;
+    }
+    stored = stored || isStored(&this->_entries[i]);
+    this->remove(i);
+  }
+  entry = &this->_entries[this->_count++];
+  entry->actionId = actionId;
+  entry->execution = execution;
+  entry->result = result;
+  entry->controller = controller;
+  entry->bytes = bytes;
+  entry->total = total;
+  entry->final = final;
+  entry->attempts = 0;
+  if (stored) {
+    this->save();
+  }
+}
+
+void HawkbitFeedbackQueue::pop() {
+  bool stored;
+  if (this->_count > 0) {
+    stored = isStored(&this->_entries[0]);
+    this->remove(0);
+    if (stored) {
+      this->save();
+    }
+  }
+}
+
+bool HawkbitFeedbackQueue::retry() {
+  if (this->_count == 0 || !this->_entries[0].final) {
+    return false;
+  }
+  if (this->_entries[0].attempts < 255) {
+    this->_entries[0].attempts++;
+  }
+  return this->_entries[0].attempts < HB_FEEDBACK_FINAL_ATTEMPTS;
+}
+
+bool HawkbitFeedbackQueue::contains(int actionId) {
+  for (uint8_t i = 0; i < this->_count; i++) {
+    if (this->_entries[i].actionId == actionId) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void HawkbitFeedbackQueue::remove(uint8_t index) {
+  memmove(&this->_entries[index], &this->_entries[index + 1], (this->_count - index - 1) * sizeof(t_feedback));
+  this->_count--;
+}
+
+void HawkbitFeedbackQueue::save() {
+  t_feedback_store store;
+  if (this->_storage == NULL) {
+    return;
+  }
+  memset(&store, 0, sizeof(store));
+  for (uint8_t i = 0; i < this->_count; i++) {
+    if (isStored(&this->_entries[i])) {
+      store.entries[store.count++] = this->_entries[i];
+    }
+  }
+  if (store.count == 0) {
+    this->_storage->remove("feedback");
+    return;
+  }
+  this->_storage->save("feedback", &store, sizeof(store));
+}
@@ -0,0 +1,105 @@
+/**
+
+   @file HawkbitFeedback.h
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#ifndef ___HAWKBIT_FEEDBACK_H___
+#define ___HAWKBIT_FEEDBACK_H___
+
+#include <Arduino.h>
+#include "HawkbitPlatform.h"
+
+/* Actions with undelivered feedback, more are not expected at a time */
+#ifndef HB_FEEDBACK_QUEUE_SIZE
+#define HB_FEEDBACK_QUEUE_SIZE 4
+#endif
+
+/* Attempts to deliver the final feedback of an action that the server
+   rejects before it is given up, the restart after an update waits for it
+   until then. Feedback that is lost in transit is retried without limit */
+#ifndef HB_FEEDBACK_FINAL_ATTEMPTS
+#define HB_FEEDBACK_FINAL_ATTEMPTS 5
+#endif
+
+typedef struct str_feedback {
+  int actionId;
+  uint8_t execution;
+  uint8_t result;
+  /* Index of the controller the action belongs to in gateway mode */
+  uint16_t controller;
+  /* Download progress, total is 0 if there is none to report */
+  uint32_t bytes;
+  uint32_t total;
+  /* Result that closes the action, it is never evicted by newer feedback */
+  bool final;
+  uint8_t attempts;
+} t_feedback;
+
+/* Action feedback that has not been acknowledged by the server yet. Only the
+   latest status of an action is kept, as it supersedes the earlier ones.
+   The queue is kept in storage so it survives a reboot, except for the
+   progress reports, which would cost a write per download segment. */
+class HawkbitFeedbackQueue
+{
+  public:
+    void begin(HawkbitStorage *storage);
+
+    /* Add the status of an action, replacing a pending one of the same action.
+       A full queue drops the oldest feedback that is not final */
+    void push(int actionId, uint8_t execution, uint8_t result, uint32_t bytes = 0, uint32_t total = 0,
+              uint16_t controller = 0, bool final = false);
+
+    /* Oldest pending feedback, NULL if the queue is empty */
+    const t_feedback *peek() {
+      return this->_count > 0 ? &this->_entries[0] : NULL;
+    }
+
+    /* Drop the oldest feedback once the server acknowledged it */
+    void pop();
+
+    /* Count a rejected attempt of the oldest feedback, false if it is to be
+       given up: at once unless it is final, otherwise after
+       HB_FEEDBACK_FINAL_ATTEMPTS */
+    bool retry();
+
+    bool contains(int actionId);
+
+    bool isEmpty() {
+      return this->_count == 0;
+    }
+
+  private:
+    HawkbitStorage *_storage = NULL;
+    uint8_t _count = 0;
+    t_feedback _entries[HB_FEEDBACK_QUEUE_SIZE];
+
+    void remove(uint8_t index);
+    void save();
+
+    /* Progress reports are not kept in storage */
+    static bool isStored(const t_feedback *feedback) {
+      return feedback->total == 0;
+    }
+};
+
+#endif /* ___HAWKBIT_FEEDBACK_H___ */
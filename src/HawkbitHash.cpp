@@ -0,0 +1,121 @@
+/**
+
+   @file HawkbitHash.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "HawkbitHash.h"
+
+HawkbitHash::HawkbitHash() {
+  this->_type = HB_HASH_NONE;
+}
+
+HawkbitHash::~HawkbitHash(void) {
+  this->release();
+}
+
+void HawkbitHash::release() {
+  switch (this->_type) {
+    case HB_HASH_MD5:
+      mbedtls_md5_free(&this->_ctx.md5);
+      break;
+    case HB_HASH_SHA1:
+      mbedtls_sha1_free(&this->_ctx.sha1);
+      break;
+    case HB_HASH_SHA256:
+      mbedtls_sha256_free(&this->_ctx.sha256);
+      break;
+    default:
+      break;
+  }
+  this->_type = HB_HASH_NONE;
+}
+
+void HawkbitHash::begin(HB_HASH_TYPE type) {
+  this->release();
+  this->_type = type;
+  switch (this->_type) {
+    case HB_HASH_MD5:
+      mbedtls_md5_init(&this->_ctx.md5);
+      mbedtls_md5_starts(&this->_ctx.md5);
+      break;
+    case HB_HASH_SHA1:
+      mbedtls_sha1_init(&this->_ctx.sha1);
+      mbedtls_sha1_starts(&this->_ctx.sha1);
+      break;
+    case HB_HASH_SHA256:
+      mbedtls_sha256_init(&this->_ctx.sha256);
+      mbedtls_sha256_starts(&this->_ctx.sha256, 0);
+      break;
+    default:
+      break;
+  }
+}
+
+void HawkbitHash::update(const uint8_t *data, size_t len) {
+  switch (this->_type) {
+    case HB_HASH_MD5:
+      mbedtls_md5_update(&this->_ctx.md5, data, len);
+      break;
+    case HB_HASH_SHA1:
+      mbedtls_sha1_update(&this->_ctx.sha1, data, len);
+      break;
+    case HB_HASH_SHA256:
+      mbedtls_sha256_update(&this->_ctx.sha256, data, len);
+      break;
+    default:
+      break;
+  }
+}
+
+bool HawkbitHash::verify(const char *expectedHex) {
+  uint8_t digest[32];
+  char hex[3];
+  size_t digestLen;
+  switch (this->_type) {
+    case HB_HASH_MD5:
+      mbedtls_md5_finish(&this->_ctx.md5, digest);
+      digestLen = 16;
+      break;
+    case HB_HASH_SHA1:
+      mbedtls_sha1_finish(&this->_ctx.sha1, digest);
+      digestLen = 20;
+      break;
+    case HB_HASH_SHA256:
+      mbedtls_sha256_finish(&this->_ctx.sha256, digest);
+      digestLen = 32;
+      break;
+    default:
+      return false;
+  }
+  this->release();
+  if (strlen(expectedHex) != digestLen * 2) {
+    return false;
+  }
+  for (size_t i = 0; i < digestLen; i++) {
+    snprintf(hex, sizeof(hex), "%02x", digest[i]);
+    if (strncasecmp(hex, expectedHex + i * 2, 2) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
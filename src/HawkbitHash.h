@@ -0,0 +1,69 @@
+/**
+
+   @file HawkbitHash.h
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#ifndef ___HAWKBIT_HASH_H___
+#define ___HAWKBIT_HASH_H___
+
+#include <Arduino.h>
+#include <mbedtls/md5.h>
+#include <mbedtls/sha1.h>
+#include <mbedtls/sha256.h>
+
+enum HB_HASH_TYPE {
+  HB_HASH_NONE,
+  HB_HASH_MD5,
+  HB_HASH_SHA1,
+  HB_HASH_SHA256,
+  HB_HASH_MAX
+};
+
+/* Incremental digest over an artifact while it is written to flash */
+class HawkbitHash
+{
+  public:
+    HawkbitHash(void);
+    ~HawkbitHash(void);
+
+    void begin(HB_HASH_TYPE type);
+    void update(const uint8_t *data, size_t len);
+    /* Finish the digest and compare it to the expected hex string */
+    bool verify(const char *expectedHex);
+
+    HB_HASH_TYPE getType() {
+      return this->_type;
+    }
+
+  private:
+    HB_HASH_TYPE _type;
+    union {
+      mbedtls_md5_context md5;
+      mbedtls_sha1_context sha1;
+      mbedtls_sha256_context sha256;
+    } _ctx;
+
+    void release();
+};
+
+#endif /* ___HAWKBIT_HASH_H___ */
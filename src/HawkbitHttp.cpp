@@ -0,0 +1,381 @@
+/**
+
+   @file HawkbitHttp.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "HawkbitHttp.h"
+
+static bool headerHasToken(const char *value, const char *token);
+
+HawkbitHttpResponse::HawkbitHttpResponse() {
+  this->reset();
+}
+
+void HawkbitHttpResponse::reset() {
+  this->_lineLen = 0;
+  this->_lineTruncated = false;
+  this->_complete = false;
+  this->_statusCode = 0;
+  this->_contentLength = -1;
+  this->_chunked = false;
+  this->_connectionClose = false;
+  this->_keepAliveMax = -1;
+  this->_keepAliveTimeout = 0;
+  this->_rangeStart = -1;
+  this->_rangeSize = -1;
+  this->_etag[0] = '\0';
+}
+
+bool HawkbitHttpResponse::feed(char c) {
+  if (this->_complete) {
+    return true;
+  }
+  if (c == '\r') {
+    return false;
+  }
+  if (c != '\n') {
+    if (this->_lineLen < sizeof(this->_line) - 1) {
+      this->_line[this->_lineLen++] = c;
+    } else {
+      this->_lineTruncated = true;
+    }
+    return false;
+  }
+  if (this->_lineLen == 0) {
+    /* Empty line ends the headers, ignore empty lines before the status line */
+    if (this->_statusCode > 0) {
+      /* These responses never carry a body */
+      if (this->_statusCode == 204 || this->_statusCode == 304) {
+        this->_contentLength = 0;
+        this->_chunked = false;
+      }
+      this->_complete = true;
+    }
+    return this->_complete;
+  }
+  this->_line[this->_lineLen] = '\0';
+  this->parseLine();
+  this->_lineLen = 0;
+  this->_lineTruncated = false;
+  return false;
+}
+
+void HawkbitHttpResponse::parseLine() {
+  const char *value;
+  size_t nameLen;
+  if (this->_statusCode == 0) {
+    if (strncmp(this->_line, "HTTP/1.", 7) == 0 && this->_lineLen > 9) {
+      this->_statusCode = atoi(this->_line + 9);
+      /* HTTP/1.0 servers close the connection unless told otherwise */
+      this->_connectionClose = (this->_line[7] == '0');
+    }
+    return;
+  }
+  value = strchr(this->_line, ':');
+  if (value == NULL) {
+    return;
+  }
+  nameLen = value - this->_line;
+  value++;
+  while (*value == ' ' || *value == '\t') {
+    value++;
+  }
+  if (nameLen == 14 && strncasecmp(this->_line, "Content-Length", nameLen) == 0) {
+    this->_contentLength = strtol(value, NULL, 10);
+  } else if (nameLen == 17 && strncasecmp(this->_line, "Transfer-Encoding", nameLen) == 0) {
+    this->_chunked = headerHasToken(value, "chunked");
+  } else if (nameLen == 10 && strncasecmp(this->_line, "Connection", nameLen) == 0) {
+    if (headerHasToken(value, "close")) {
+      this->_connectionClose = true;
+    } else if (headerHasToken(value, "keep-alive")) {
+      this->_connectionClose = false;
+    }
+  } else if (nameLen == 10 && strncasecmp(this->_line, "Keep-Alive", nameLen) == 0) {
+    const char *param = strstr(value, "timeout=");
+    if (param != NULL) {
+      this->_keepAliveTimeout = strtoul(param + 8, NULL, 10) * 1000UL;
+    }
+    param = strstr(value, "max=");
+    if (param != NULL) {
+      this->_keepAliveMax = strtol(param + 4, NULL, 10);
+    }
+  } else if (nameLen == 13 && strncasecmp(this->_line, "Content-Range", nameLen) == 0) {
+    /* bytes <first>-<last>/<size> */
+    if (strncasecmp(value, "bytes ", 6) == 0) {
+      this->_rangeStart = strtol(value + 6, NULL, 10);
+      /* The size is "*" if the server does not know it */
+      value = strchr(value, '/');
+      if (value != NULL && value[1] >= '0' && value[1] <= '9') {
+        this->_rangeSize = strtol(value + 1, NULL, 10);
+      }
+    }
+  } else if (nameLen == 4 && strncasecmp(this->_line, "ETag", nameLen) == 0) {
+    /* A truncated ETag would never match again */
+    if (!this->_lineTruncated && strlen(value) < sizeof(this->_etag)) {
+      strcpy(this->_etag, value);
+    } else {
+      this->_etag[0] = '\0';
+    }
+  }
+}
+
+static bool headerHasToken(const char *value, const char *token) {
+  size_t tokenLen = strlen(token);
+  for (; *value != '\0'; value++) {
+    if (strncasecmp(value, token, tokenLen) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void HawkbitBodyStream::begin(Stream *client, long contentLength, bool chunked) {
+  this->_client = client;
+  this->_chunked = chunked;
+  this->_firstChunk = chunked;
+  this->_finished = false;
+  this->_remaining = chunked ? 0 : contentLength;
+  this->_bytesRead = 0;
+}
+
+bool HawkbitBodyStream::isComplete() {
+  if (this->_chunked) {
+    return this->_finished;
+  }
+  return this->_remaining == 0;
+}
+
+bool HawkbitBodyStream::drain() {
+  char buffer[64];
+  while (this->readBytes(buffer, sizeof(buffer)) > 0) {
+  }
+  return this->isComplete();
+}
+
+/* Read one chunk size or trailer line, the size is parsed as hex up to any extension */
+bool HawkbitBodyStream::readChunkLine(long *chunkSize) {
+  char c;
+  bool inSize = true;
+  *chunkSize = 0;
+  while (this->_client->readBytes(&c, 1) == 1) {
+    if (c == '\n') {
+      return true;
+    }
+    if (!inSize) {
+      continue;
+    }
+    if (c >= '0' && c <= '9') {
+      *chunkSize = *chunkSize * 16 + (c - '0');
+    } else if (c >= 'a' && c <= 'f') {
+      *chunkSize = *chunkSize * 16 + (c - 'a' + 10);
+    } else if (c >= 'A' && c <= 'F') {
+      *chunkSize = *chunkSize * 16 + (c - 'A' + 10);
+    } else {
+      inSize = false;
+    }
+  }
+  return false;
+}
+
+bool HawkbitBodyStream::nextChunk() {
+  long chunkSize;
+  if (!this->_firstChunk) {
+    /* CRLF after the previous chunk data */
+    if (!this->readChunkLine(&chunkSize)) {
+      return false;
+    }
+  }
+  this->_firstChunk = false;
+  if (!this->readChunkLine(&chunkSize) || chunkSize < 0) {
+    return false;
+  }
+  if (chunkSize == 0) {
+    /* Last chunk, skip optional trailer headers up to the empty line */
+    long lineLen;
+    char c = '\0';
+    do {
+      lineLen = 0;
+      while (this->_client->readBytes(&c, 1) == 1 && c != '\n') {
+        if (c != '\r') {
+          lineLen++;
+        }
+      }
+      if (c != '\n') {
+        return false;
+      }
+    } while (lineLen > 0);
+    this->_finished = true;
+    return true;
+  }
+  this->_remaining = chunkSize;
+  return true;
+}
+
+int HawkbitBodyStream::available() {
+  int avail;
+  if (this->_chunked && this->_remaining == 0 && !this->_finished && this->_client->available() > 0) {
+    this->nextChunk();
+  }
+  if (this->_remaining == 0) {
+    return 0;
+  }
+  avail = this->_client->available();
+  if (this->_remaining > 0 && avail > this->_remaining) {
+    avail = this->_remaining;
+  }
+  return avail;
+}
+
+int HawkbitBodyStream::read() {
+  char c;
+  if (this->readBytes(&c, 1) != 1) {
+    return -1;
+  }
+  return (uint8_t)c;
+}
+
+int HawkbitBodyStream::peek() {
+  if (this->available() <= 0) {
+    return -1;
+  }
+  return this->_client->peek();
+}
+
+size_t HawkbitBodyStream::readBytes(char *buffer, size_t length) {
+  size_t total = 0;
+  size_t toRead;
+  size_t readLen;
+  while (total < length) {
+    if (this->_remaining == 0) {
+      if (!this->_chunked || this->_finished || !this->nextChunk() || this->_finished) {
+        break;
+      }
+    }
+    toRead = length - total;
+    if (this->_remaining > 0 && toRead > (size_t)this->_remaining) {
+      toRead = this->_remaining;
+    }
+    readLen = this->_client->readBytes(buffer + total, toRead);
+    if (readLen == 0) {
+      break;
+    }
+    if (this->_remaining > 0) {
+      this->_remaining -= readLen;
+    }
+    total += readLen;
+  }
+  this->_bytesRead += total;
+  return total;
+}
+
+void HawkbitBufferStream::begin(const char *buffer, size_t length) {
+  this->_buffer = buffer;
+  this->_length = length;
+  this->_position = 0;
+}
+
+int HawkbitBufferStream::available() {
+  return this->_length - this->_position;
+}
+
+int HawkbitBufferStream::read() {
+  if (this->_position >= this->_length) {
+    return -1;
+  }
+  return (uint8_t)this->_buffer[this->_position++];
+}
+
+int HawkbitBufferStream::peek() {
+  if (this->_position >= this->_length) {
+    return -1;
+  }
+  return (uint8_t)this->_buffer[this->_position];
+}
+
+size_t HawkbitBufferStream::readBytes(char *buffer, size_t length) {
+  if (length > this->_length - this->_position) {
+    length = this->_length - this->_position;
+  }
+  memcpy(buffer, this->_buffer + this->_position, length);
+  this->_position += length;
+  return length;
+}
+
+HawkbitRequestWriter::HawkbitRequestWriter(Print *out) {
+  this->_out = out;
+}
+
+size_t HawkbitRequestWriter::write(uint8_t data) {
+  if (this->_used >= sizeof(this->_buffer)) {
+    this->send();
+  }
+  this->_buffer[this->_used++] = (char)data;
+  return 1;
+}
+
+size_t HawkbitRequestWriter::write(const uint8_t *data, size_t length) {
+  size_t total = length;
+  while (length > 0) {
+    size_t part = sizeof(this->_buffer) - this->_used;
+    if (part == 0) {
+      this->send();
+      continue;
+    }
+    if (part > length) {
+      part = length;
+    }
+    memcpy(this->_buffer + this->_used, data, part);
+    this->_used += part;
+    data += part;
+    length -= part;
+  }
+  return total;
+}
+
+size_t HawkbitRequestWriter::addNumber(unsigned long value) {
+  char digits[20];
+  size_t count = 0;
+  do {
+    digits[sizeof(digits) - ++count] = '0' + value % 10;
+    value /= 10;
+  } while (value > 0 && count < sizeof(digits));
+  return this->add(digits + sizeof(digits) - count, count);
+}
+
+bool HawkbitRequestWriter::finish() {
+  this->send();
+  return !this->_failed;
+}
+
+void HawkbitRequestWriter::send() {
+  size_t written;
+  if (this->_used == 0) {
+    return;
+  }
+  written = this->_out->write((const uint8_t *)this->_buffer, this->_used);
+  if (written != this->_used) {
+    this->_failed = true;
+  }
+  this->_written += written;
+  this->_used = 0;
+}
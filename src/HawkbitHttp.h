@@ -0,0 +1,218 @@
+/**
+
+   @file HawkbitHttp.h
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#ifndef ___HAWKBIT_HTTP_H___
+#define ___HAWKBIT_HTTP_H___
+
+#include <Arduino.h>
+
+/* Longest response header line that is evaluated, longer lines are truncated */
+#ifndef HB_HTTP_LINE_SIZE
+#define HB_HTTP_LINE_SIZE 128
+#endif
+
+#ifndef HB_HTTP_ETAG_SIZE
+#define HB_HTTP_ETAG_SIZE 64
+#endif
+
+/* Bytes of a request collected before they are passed to the transport */
+#ifndef HB_HTTP_REQUEST_BUFFER_SIZE
+#define HB_HTTP_REQUEST_BUFFER_SIZE 512
+#endif
+
+/* Incremental parser for the status line and headers of a HTTP/1.1 response.
+   It works on a fixed line buffer and never allocates. */
+class HawkbitHttpResponse
+{
+  public:
+    HawkbitHttpResponse(void);
+
+    void reset();
+
+    /* Feed one byte of the response head. Returns true once the empty line
+       terminating the headers has been seen */
+    bool feed(char c);
+
+    bool complete() {
+      return this->_complete;
+    }
+
+    int getStatusCode() {
+      return this->_statusCode;
+    }
+
+    /* Announced body length, -1 if unknown */
+    long getContentLength() {
+      return this->_contentLength;
+    }
+
+    bool isChunked() {
+      return this->_chunked;
+    }
+
+    /* Whether the server keeps the connection open after this response */
+    bool keepAlive() {
+      return !this->_connectionClose && this->_keepAliveMax != 0 && this->_keepAliveMax != 1;
+    }
+
+    /* Idle timeout announced in the Keep-Alive header in ms, 0 if none */
+    unsigned long getKeepAliveTimeout() {
+      return this->_keepAliveTimeout;
+    }
+
+    /* First byte of a partial response (Content-Range), -1 if none */
+    long getRangeStart() {
+      return this->_rangeStart;
+    }
+
+    /* Complete length of the resource of a partial response, -1 if unknown */
+    long getRangeSize() {
+      return this->_rangeSize;
+    }
+
+    /* ETag of the response including quotes, empty if none */
+    const char *getETag() {
+      return this->_etag;
+    }
+
+  private:
+    char _line[HB_HTTP_LINE_SIZE];
+    size_t _lineLen;
+    bool _lineTruncated;
+    bool _complete;
+    int _statusCode;
+    long _contentLength;
+    bool _chunked;
+    bool _connectionClose;
+    long _keepAliveMax;
+    unsigned long _keepAliveTimeout;
+    long _rangeStart;
+    long _rangeSize;
+    char _etag[HB_HTTP_ETAG_SIZE];
+
+    void parseLine();
+};
+
+/* Stream view on a HTTP response body. Stops at the announced Content-Length
+   and decodes chunked transfer encoding on the fly, so the connection can be
+   reused for the next request afterwards */
+class HawkbitBodyStream : public Stream
+{
+  public:
+    void begin(Stream *client, long contentLength, bool chunked);
+
+    /* Whether the whole body has been read */
+    bool isComplete();
+
+    /* Read and discard the rest of the body */
+    bool drain();
+
+    /* Body bytes read so far, without chunk framing */
+    unsigned long getBytesRead() {
+      return this->_bytesRead;
+    }
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t readBytes(char *buffer, size_t length) override;
+    size_t write(uint8_t data) override {
+      return 0;
+    }
+
+  private:
+    Stream *_client = NULL;
+    /* Remaining bytes of the body or current chunk, -1 if delimited by close */
+    long _remaining = 0;
+    bool _chunked = false;
+    bool _firstChunk = false;
+    bool _finished = false;
+    unsigned long _bytesRead = 0;
+
+    bool nextChunk();
+    bool readChunkLine(long *chunkSize);
+};
+
+/* Stream over a body that has already been read into memory */
+class HawkbitBufferStream : public Stream
+{
+  public:
+    void begin(const char *buffer, size_t length);
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t readBytes(char *buffer, size_t length) override;
+    size_t write(uint8_t data) override {
+      return 0;
+    }
+
+  private:
+    const char *_buffer = NULL;
+    size_t _length = 0;
+    size_t _position = 0;
+};
+
+/* Collects the head and body of a request in a fixed buffer, so a request
+   is passed to the transport in one write unless it exceeds the buffer */
+class HawkbitRequestWriter : public Print
+{
+  public:
+    HawkbitRequestWriter(Print *out);
+
+    using Print::write;
+    size_t write(uint8_t data) override;
+    size_t write(const uint8_t *data, size_t length) override;
+
+    size_t add(const char *text) {
+      return this->write((const uint8_t *)text, strlen(text));
+    }
+
+    size_t add(const char *text, size_t length) {
+      return this->write((const uint8_t *)text, length);
+    }
+
+    size_t addNumber(unsigned long value);
+
+    /* Pass the rest of the buffer to the transport. Returns false if the
+       transport did not take all bytes of the request */
+    bool finish();
+
+    /* Bytes taken by the transport so far */
+    size_t getBytesWritten() {
+      return this->_written;
+    }
+
+  private:
+    Print *_out;
+    char _buffer[HB_HTTP_REQUEST_BUFFER_SIZE];
+    size_t _used = 0;
+    size_t _written = 0;
+    bool _failed = false;
+
+    void send();
+};
+
+#endif /* ___HAWKBIT_HTTP_H___ */
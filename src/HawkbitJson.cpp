@@ -0,0 +1,345 @@
+/**
+
+   @file HawkbitJson.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "HawkbitJson.h"
+
+bool HawkbitJsonExtractor::parse(Stream &stream, HawkbitJsonCallback callback, void *context) {
+  this->_stream = &stream;
+  this->_callback = callback;
+  this->_context = context;
+  this->_hasPeek = false;
+  this->_pathLen = 0;
+  this->_pathOverflow = 0;
+  this->_path[0] = '\0';
+  return this->parseValue(0);
+}
+
+bool HawkbitJsonExtractor::next(char *c) {
+  if (this->_hasPeek) {
+    this->_hasPeek = false;
+    *c = this->_peek;
+    return true;
+  }
+  return this->_stream->readBytes(c, 1) == 1;
+}
+
+/* Next character that is not whitespace */
+bool HawkbitJsonExtractor::nextToken(char *c) {
+  do {
+    if (!this->next(c)) {
+      return false;
+    }
+  } while (*c == ' ' || *c == '\t' || *c == '\r' || *c == '\n');
+  return true;
+}
+
+bool HawkbitJsonExtractor::pushPath(const char *separator, const char *name) {
+  size_t sepLen = this->_pathLen > 0 ? strlen(separator) : 0;
+  size_t nameLen = strlen(name);
+  if (this->_pathOverflow > 0 || this->_pathLen + sepLen + nameLen >= sizeof(this->_path)) {
+    this->_pathOverflow++;
+    return false;
+  }
+  memcpy(this->_path + this->_pathLen, separator, sepLen);
+  memcpy(this->_path + this->_pathLen + sepLen, name, nameLen + 1);
+  this->_pathLen += sepLen + nameLen;
+  return true;
+}
+
+void HawkbitJsonExtractor::popPath(size_t pathLen, bool pushed) {
+  if (!pushed) {
+    this->_pathOverflow--;
+    return;
+  }
+  this->_pathLen = pathLen;
+  this->_path[pathLen] = '\0';
+}
+
+void HawkbitJsonExtractor::report() {
+  if (this->_pathOverflow == 0) {
+    this->_callback(this->_context, this->_path, this->_value);
+  }
+}
+
+bool HawkbitJsonExtractor::parseValue(uint8_t depth) {
+  char c;
+  bool truncated;
+  if (!this->nextToken(&c)) {
+    return false;
+  }
+  switch (c) {
+    case '{':
+      return depth < HB_JSON_MAX_DEPTH && this->parseObject(depth + 1);
+    case '[':
+      return depth < HB_JSON_MAX_DEPTH && this->parseArray(depth + 1);
+    case '"':
+      if (!this->parseString(&truncated)) {
+        return false;
+      }
+      /* Values too long for the buffer are treated as missing */
+      if (!truncated) {
+        this->report();
+      }
+      return true;
+    default:
+      return this->parseLiteral(c);
+  }
+}
+
+bool HawkbitJsonExtractor::parseObject(uint8_t depth) {
+  char c;
+  size_t pathLen = this->_pathLen;
+  bool truncated;
+  bool pushed;
+  if (!this->nextToken(&c)) {
+    return false;
+  }
+  if (c == '}') {
+    return true;
+  }
+  for (;;) {
+    if (c != '"' || !this->parseString(&truncated)) {
+      return false;
+    }
+    if (!this->nextToken(&c) || c != ':') {
+      return false;
+    }
+    /* A truncated key must not match a wanted path */
+    pushed = !truncated && this->pushPath(".", this->_value);
+    if (truncated) {
+      this->_pathOverflow++;
+    }
+    if (!this->parseValue(depth)) {
+      return false;
+    }
+    this->popPath(pathLen, pushed);
+    if (!this->nextToken(&c)) {
+      return false;
+    }
+    if (c == '}') {
+      return true;
+    }
+    if (c != ',' || !this->nextToken(&c)) {
+      return false;
+    }
+  }
+}
+
+bool HawkbitJsonExtractor::parseArray(uint8_t depth) {
+  char c;
+  char index[8];
+  size_t pathLen = this->_pathLen;
+  bool pushed;
+  unsigned int i = 0;
+  if (!this->nextToken(&c)) {
+    return false;
+  }
+  if (c == ']') {
+    return true;
+  }
+  this->_hasPeek = true;
+  this->_peek = c;
+  for (;; i++) {
+    snprintf(index, sizeof(index), "[%u]", i);
+    /* Array indices attach to their parent without separator */
+    pushed = this->pushPath("", index);
+    if (!this->parseValue(depth)) {
+      return false;
+    }
+    this->popPath(pathLen, pushed);
+    if (!this->nextToken(&c)) {
+      return false;
+    }
+    if (c == ']') {
+      return true;
+    }
+    if (c != ',') {
+      return false;
+    }
+  }
+}
+
+/* Read a string after the opening quote into _value and decode escapes */
+bool HawkbitJsonExtractor::parseString(bool *truncated) {
+  char c;
+  char hex[5];
+  size_t len = 0;
+  unsigned long codepoint;
+  char utf8[3];
+  size_t utf8Len;
+  *truncated = false;
+  for (;;) {
+    if (!this->next(&c)) {
+      return false;
+    }
+    if (c == '"') {
+      break;
+    }
+    utf8Len = 1;
+    utf8[0] = c;
+    if (c == '\\') {
+      if (!this->next(&c)) {
+        return false;
+      }
+      switch (c) {
+        case 'b': utf8[0] = '\b'; break;
+        case 'f': utf8[0] = '\f'; break;
+        case 'n': utf8[0] = '\n'; break;
+        case 'r': utf8[0] = '\r'; break;
+        case 't': utf8[0] = '\t'; break;
+        case 'u':
+          for (int i = 0; i < 4; i++) {
+            if (!this->next(&hex[i])) {
+              return false;
+            }
+          }
+          hex[4] = '\0';
+          codepoint = strtoul(hex, NULL, 16);
+          if (codepoint < 0x80) {
+            utf8[0] = (char)codepoint;
+          } else if (codepoint < 0x800) {
+            utf8[0] = (char)(0xC0 | (codepoint >> 6));
+            utf8[1] = (char)(0x80 | (codepoint & 0x3F));
+            utf8Len = 2;
+          } else {
+            utf8[0] = (char)(0xE0 | (codepoint >> 12));
+            utf8[1] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+            utf8[2] = (char)(0x80 | (codepoint & 0x3F));
+            utf8Len = 3;
+          }
+          break;
+        default:
+          /* \" \\ \/ */
+          utf8[0] = c;
+          break;
+      }
+    }
+    if (len + utf8Len < sizeof(this->_value)) {
+      memcpy(this->_value + len, utf8, utf8Len);
+      len += utf8Len;
+    } else {
+      *truncated = true;
+    }
+  }
+  this->_value[len] = '\0';
+  return true;
+}
+
+/* Numbers, true, false and null */
+bool HawkbitJsonExtractor::parseLiteral(char first) {
+  char c = first;
+  size_t len = 0;
+  for (;;) {
+    if (c == ',' || c == '}' || c == ']' || c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+      this->_hasPeek = true;
+      this->_peek = c;
+      break;
+    }
+    if (len < sizeof(this->_value) - 1) {
+      this->_value[len++] = c;
+    }
+    /* End of stream terminates a top level literal */
+    if (!this->next(&c)) {
+      break;
+    }
+  }
+  this->_value[len] = '\0';
+  if (len == 0) {
+    return false;
+  }
+  this->report();
+  return true;
+}
+
+HawkbitJsonWriter::HawkbitJsonWriter(char *buffer, size_t size) {
+  this->_buffer = buffer;
+  this->_size = size;
+  if (size > 0) {
+    buffer[0] = '\0';
+  } else {
+    this->_overflow = true;
+  }
+}
+
+HawkbitJsonWriter &HawkbitJsonWriter::raw(const char *text) {
+  return this->raw(text, strlen(text));
+}
+
+HawkbitJsonWriter &HawkbitJsonWriter::raw(const char *text, size_t length) {
+  if (this->_overflow || length >= this->_size - this->_length) {
+    this->_overflow = true;
+    return *this;
+  }
+  memcpy(this->_buffer + this->_length, text, length);
+  this->_length += length;
+  this->_buffer[this->_length] = '\0';
+  return *this;
+}
+
+HawkbitJsonWriter &HawkbitJsonWriter::string(const char *text) {
+  static const char hex[] = "0123456789abcdef";
+  this->put('"');
+  while (*text != '\0') {
+    /* Copy the run of characters that need no escaping at once */
+    size_t run = 0;
+    while (text[run] != '\0' && text[run] != '"' && text[run] != '\\' && (uint8_t)text[run] >= 0x20) {
+      run++;
+    }
+    if (run > 0) {
+      this->raw(text, run);
+      text += run;
+      continue;
+    }
+    uint8_t c = (uint8_t)*text++;
+    if (c == '"' || c == '\\') {
+      this->put('\\');
+      this->put(c);
+    } else {
+      this->raw("\\u00");
+      this->put(hex[c >> 4]);
+      this->put(hex[c & 0x0f]);
+    }
+  }
+  this->put('"');
+  return *this;
+}
+
+HawkbitJsonWriter &HawkbitJsonWriter::number(long value) {
+  char digits[21];
+  size_t count = 0;
+  unsigned long magnitude = value < 0 ? 0UL - (unsigned long)value : (unsigned long)value;
+  do {
+    digits[sizeof(digits) - ++count] = '0' + magnitude % 10;
+    magnitude /= 10;
+  } while (magnitude > 0);
+  if (value < 0) {
+    digits[sizeof(digits) - ++count] = '-';
+  }
+  return this->raw(digits + sizeof(digits) - count, count);
+}
+
+void HawkbitJsonWriter::put(char c) {
+  this->raw(&c, 1);
+}
@@ -0,0 +1,116 @@
+/**
+
+   @file HawkbitJson.h
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#ifndef ___HAWKBIT_JSON_H___
+#define ___HAWKBIT_JSON_H___
+
+#include <Arduino.h>
+
+/* Longest path of a value, e.g. "deployment.chunks[0].artifacts[0]._links.download.href" */
+#ifndef HB_JSON_PATH_SIZE
+#define HB_JSON_PATH_SIZE 96
+#endif
+
+/* Longest string value that is reported, longer values are skipped */
+#ifndef HB_JSON_VALUE_SIZE
+#define HB_JSON_VALUE_SIZE 1024
+#endif
+
+#ifndef HB_JSON_MAX_DEPTH
+#define HB_JSON_MAX_DEPTH 12
+#endif
+
+/* Called for every scalar value with its path. Object members are joined with
+   '.', array elements are addressed as "[n]". Numbers, booleans and null are
+   passed as their literal text */
+typedef void (*HawkbitJsonCallback)(void *context, const char *path, const char *value);
+
+/* Streaming JSON parser that extracts single values without building a
+   document, so memory use does not depend on the size of the response */
+class HawkbitJsonExtractor
+{
+  public:
+    bool parse(Stream &stream, HawkbitJsonCallback callback, void *context);
+
+  private:
+    Stream *_stream;
+    HawkbitJsonCallback _callback;
+    void *_context;
+    bool _hasPeek;
+    char _peek;
+    size_t _pathLen;
+    /* Depth of nested containers whose path did not fit into _path */
+    uint8_t _pathOverflow;
+    char _path[HB_JSON_PATH_SIZE];
+    char _value[HB_JSON_VALUE_SIZE];
+
+    bool next(char *c);
+    bool nextToken(char *c);
+    bool parseValue(uint8_t depth);
+    bool parseObject(uint8_t depth);
+    bool parseArray(uint8_t depth);
+    bool parseString(bool *truncated);
+    bool parseLiteral(char first);
+    bool pushPath(const char *separator, const char *name);
+    void popPath(size_t pathLen, bool pushed);
+    void report();
+};
+
+/* Writes JSON text into a caller provided buffer without allocating. Text
+   that does not fit is dropped and reported by overflow() */
+class HawkbitJsonWriter
+{
+  public:
+    HawkbitJsonWriter(char *buffer, size_t size);
+
+    /* Append text that already is valid JSON */
+    HawkbitJsonWriter &raw(const char *text);
+    HawkbitJsonWriter &raw(const char *text, size_t length);
+    /* Append a quoted and escaped string */
+    HawkbitJsonWriter &string(const char *text);
+    HawkbitJsonWriter &number(long value);
+
+    const char *c_str() {
+      return this->_buffer;
+    }
+
+    size_t length() {
+      return this->_length;
+    }
+
+    bool overflow() {
+      return this->_overflow;
+    }
+
+  private:
+    char *_buffer;
+    size_t _size;
+    size_t _length = 0;
+    bool _overflow = false;
+
+    void put(char c);
+};
+
+#endif /* ___HAWKBIT_JSON_H___ */
@@ -0,0 +1,108 @@
+/**
+
+   @file HawkbitLinks.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "HawkbitLinks.h"
+
+HawkbitLinkStore::HawkbitLinkStore() {
+  memset(this->_links, 0, sizeof(this->_links));
+  this->_prefixLength = 0;
+  this->_used = 0;
+}
+
+bool HawkbitLinkStore::set(HB_LINK link, const char *href) {
+  size_t length = href != NULL ? strlen(href) : 0;
+  size_t shared = 0;
+  this->clear(link);
+  if (length == 0) {
+    return true;
+  }
+  if (this->_used == 0) {
+    /* Nothing stored, the link becomes the prefix */
+    if (length > sizeof(this->_arena)) {
+      return false;
+    }
+    memcpy(this->_arena, href, length);
+    this->_prefixLength = length;
+    this->_used = length;
+    shared = length;
+  } else {
+    while (shared < this->_prefixLength && shared < length && this->_arena[shared] == href[shared]) {
+      shared++;
+    }
+    if (this->_used + length - shared > sizeof(this->_arena)) {
+      return false;
+    }
+    memcpy(this->_arena + this->_used, href + shared, length - shared);
+  }
+  this->_links[link].offset = this->_used;
+  this->_links[link].length = length;
+  this->_links[link].shared = shared;
+  this->_used += length - shared;
+  return true;
+}
+
+void HawkbitLinkStore::clear(HB_LINK link) {
+  t_link *entry = &this->_links[link];
+  uint16_t suffixLength;
+  bool empty = true;
+  if (entry->length == 0) {
+    return;
+  }
+  suffixLength = entry->length - entry->shared;
+  if (suffixLength > 0) {
+    memmove(this->_arena + entry->offset, this->_arena + entry->offset + suffixLength, this->_used - entry->offset - suffixLength);
+    this->_used -= suffixLength;
+    for (int i = 0; i < HB_LINK_MAX; i++) {
+      if (this->_links[i].length > 0 && this->_links[i].offset > entry->offset) {
+        this->_links[i].offset -= suffixLength;
+      }
+    }
+  }
+  entry->length = 0;
+  for (int i = 0; i < HB_LINK_MAX; i++) {
+    if (this->_links[i].length > 0) {
+      empty = false;
+    }
+  }
+  if (empty) {
+    /* Let the next link define a new prefix */
+    this->_prefixLength = 0;
+    this->_used = 0;
+  }
+}
+
+size_t HawkbitLinkStore::copy(HB_LINK link, char *buffer, size_t size) {
+  t_link *entry = &this->_links[link];
+  if (entry->length == 0 || entry->length >= size) {
+    if (size > 0) {
+      buffer[0] = '\0';
+    }
+    return 0;
+  }
+  memcpy(buffer, this->_arena, entry->shared);
+  memcpy(buffer + entry->shared, this->_arena + entry->offset, entry->length - entry->shared);
+  buffer[entry->length] = '\0';
+  return entry->length;
+}
@@ -0,0 +1,87 @@
+/**
+
+   @file HawkbitLinks.h
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#ifndef ___HAWKBIT_LINKS_H___
+#define ___HAWKBIT_LINKS_H___
+
+#include <Arduino.h>
+
+/* Bytes for all links together, a single link cannot be longer */
+#ifndef HB_LINK_STORE_SIZE
+#define HB_LINK_STORE_SIZE 768
+#endif
+
+enum HB_LINK {
+  HB_LINK_CONFIGDATA,
+  HB_LINK_DEPLOYMENTBASE,
+  HB_LINK_CANCELACTION,
+  HB_LINK_DOWNLOAD,
+  HB_LINK_MAX
+};
+
+/* Compact storage for the links of the DDI resources. The first link stored
+   into the empty store becomes the prefix, all links keep only the part
+   after what they share with it, e.g. ".../controller/v1/<id>/". Removing a
+   link compacts the store, so it only holds the current content. */
+class HawkbitLinkStore
+{
+  public:
+    HawkbitLinkStore(void);
+
+    /* Replace a link, an empty href removes it. Returns false if it does not fit */
+    bool set(HB_LINK link, const char *href);
+    void clear(HB_LINK link);
+
+    bool isSet(HB_LINK link) {
+      return this->_links[link].length > 0;
+    }
+
+    /* Copy the complete link into buffer. Returns its length, 0 if the link
+       is not set or the buffer is too small */
+    size_t copy(HB_LINK link, char *buffer, size_t size);
+
+    /* Bytes of the store in use */
+    size_t getUsed() {
+      return this->_used;
+    }
+
+  private:
+    typedef struct str_link {
+      /* Start of the part after the shared prefix */
+      uint16_t offset;
+      /* Length of the complete link, 0 if not set */
+      uint16_t length;
+      /* Leading bytes taken from the prefix */
+      uint16_t shared;
+    } t_link;
+
+    t_link _links[HB_LINK_MAX];
+    /* The prefix is stored at the start of the arena */
+    uint16_t _prefixLength;
+    uint16_t _used;
+    char _arena[HB_LINK_STORE_SIZE];
+};
+
+#endif /* ___HAWKBIT_LINKS_H___ */
@@ -0,0 +1,597 @@
+/**
+
+   @file HawkbitLinux.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "HawkbitLinux.h"
+
+#if defined(__linux__) && !defined(ARDUINO)
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/x509v3.h>
+
+HawkbitLinuxTransport::HawkbitLinuxTransport() {
+  this->_sessionServer[0] = '\0';
+}
+
+HawkbitLinuxTransport::~HawkbitLinuxTransport(void) {
+  this->stop();
+  SSL_SESSION_free(this->_offeredSession);
+  SSL_CTX_free(this->_ctx);
+}
+
+bool HawkbitLinuxTransport::createContext(bool verify) {
+  if (this->_ctx == NULL) {
+    this->_ctx = SSL_CTX_new(TLS_client_method());
+    if (this->_ctx == NULL) {
+      return false;
+    }
+    SSL_CTX_set_min_proto_version(this->_ctx, TLS1_2_VERSION);
+    /* Sessions are kept by the HawkbitSessionCache of the caller */
+    SSL_CTX_set_session_cache_mode(this->_ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(this->_ctx, HawkbitLinuxTransport::onNewSession);
+    /* SSL_write() has no MSG_NOSIGNAL, a connection closed by the server
+       must fail the write instead of terminating the process */
+    signal(SIGPIPE, SIG_IGN);
+  }
+  SSL_CTX_set_verify(this->_ctx, verify ? SSL_VERIFY_PEER : SSL_VERIFY_NONE, NULL);
+  return true;
+}
+
+bool HawkbitLinuxTransport::setCACert(const char *rootCA) {
+  BIO *bio;
+  X509 *cert;
+  int count = 0;
+  if (!this->createContext(true)) {
+    return false;
+  }
+  bio = BIO_new_mem_buf(rootCA, -1);
+  if (bio == NULL) {
+    return false;
+  }
+  while ((cert = PEM_read_bio_X509(bio, NULL, NULL, NULL)) != NULL) {
+    if (X509_STORE_add_cert(SSL_CTX_get_cert_store(this->_ctx), cert) == 1) {
+      count++;
+    }
+    X509_free(cert);
+  }
+  /* The end of the PEM data is reported as error */
+  ERR_clear_error();
+  BIO_free(bio);
+  return count > 0;
+}
+
+void HawkbitLinuxTransport::setInsecure() {
+  this->createContext(false);
+}
+
+bool HawkbitLinuxTransport::waitSocket(short events, unsigned long timeout) {
+  struct pollfd fd;
+  fd.fd = this->_socket;
+  fd.events = events;
+  fd.revents = 0;
+  return poll(&fd, 1, timeout) > 0;
+}
+
+/* Connect to the first address of the host that accepts within the timeout */
+bool HawkbitLinuxTransport::openSocket(const char *serverName, uint16_t serverPort) {
+  struct addrinfo hints;
+  struct addrinfo *result;
+  struct addrinfo *addr;
+  char port[6];
+  int error;
+  socklen_t errorLen;
+  int noDelay = 1;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  snprintf(port, sizeof(port), "%u", serverPort);
+  if (getaddrinfo(serverName, port, &hints, &result) != 0) {
+    return false;
+  }
+  for (addr = result; addr != NULL; addr = addr->ai_next) {
+    this->_socket = socket(addr->ai_family, addr->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, addr->ai_protocol);
+    if (this->_socket < 0) {
+      continue;
+    }
+    if (::connect(this->_socket, addr->ai_addr, addr->ai_addrlen) == 0 ||
+        (errno == EINPROGRESS && this->waitSocket(POLLOUT, this->_timeout))) {
+      error = 0;
+      errorLen = sizeof(error);
+      if (getsockopt(this->_socket, SOL_SOCKET, SO_ERROR, &error, &errorLen) == 0 && error == 0) {
+        break;
+      }
+    }
+    close(this->_socket);
+    this->_socket = -1;
+  }
+  freeaddrinfo(result);
+  if (this->_socket < 0) {
+    return false;
+  }
+  setsockopt(this->_socket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+  return true;
+}
+
+bool HawkbitLinuxTransport::handshake(const char *serverName) {
+  unsigned char address[sizeof(struct in6_addr)];
+  bool ipLiteral = inet_pton(AF_INET, serverName, address) == 1 || inet_pton(AF_INET6, serverName, address) == 1;
+  unsigned long start = ::millis();
+  unsigned long elapsed;
+  int ret;
+  int error;
+  this->_ssl = SSL_new(this->_ctx);
+  if (this->_ssl == NULL) {
+    return false;
+  }
+  SSL_set_fd(this->_ssl, this->_socket);
+  SSL_set_app_data(this->_ssl, this);
+  if (!ipLiteral) {
+    SSL_set_tlsext_host_name(this->_ssl, serverName);
+  }
+  if (SSL_CTX_get_verify_mode(this->_ctx) != SSL_VERIFY_NONE) {
+    if (ipLiteral) {
+      X509_VERIFY_PARAM_set1_ip_asc(SSL_get0_param(this->_ssl), serverName);
+    } else {
+      SSL_set1_host(this->_ssl, serverName);
+    }
+  }
+  if (this->_offeredSession != NULL) {
+    SSL_set_session(this->_ssl, this->_offeredSession);
+  }
+  for (;;) {
+    ret = SSL_connect(this->_ssl);
+    if (ret == 1) {
+      return true;
+    }
+    error = SSL_get_error(this->_ssl, ret);
+    elapsed = ::millis() - start;
+    if (elapsed >= this->_timeout) {
+      return false;
+    }
+    if (error == SSL_ERROR_WANT_READ) {
+      this->waitSocket(POLLIN, this->_timeout - elapsed);
+    } else if (error == SSL_ERROR_WANT_WRITE) {
+      this->waitSocket(POLLOUT, this->_timeout - elapsed);
+    } else {
+      return false;
+    }
+  }
+}
+
+bool HawkbitLinuxTransport::connect(const char *serverName, uint16_t serverPort) {
+  bool connected;
+  this->stop();
+  connected = this->openSocket(serverName, serverPort) &&
+              (this->_ctx == NULL || this->handshake(serverName));
+  /* A session is only offered to the next connection */
+  SSL_SESSION_free(this->_offeredSession);
+  this->_offeredSession = NULL;
+  if (!connected) {
+    this->stop();
+  }
+  return connected;
+}
+
+bool HawkbitLinuxTransport::connected() {
+  if (this->_head < this->_tail) {
+    return true;
+  }
+  if (this->_socket < 0) {
+    return false;
+  }
+  /* Notices a close by the server */
+  this->fill();
+  return !this->_peerClosed || this->_head < this->_tail;
+}
+
+void HawkbitLinuxTransport::stop() {
+  if (this->_ssl != NULL) {
+    SSL_shutdown(this->_ssl);
+    SSL_free(this->_ssl);
+    this->_ssl = NULL;
+  }
+  if (this->_socket >= 0) {
+    close(this->_socket);
+    this->_socket = -1;
+  }
+  ERR_clear_error();
+  this->_head = 0;
+  this->_tail = 0;
+  this->_peerClosed = false;
+  this->_sessionCache = NULL;
+}
+
+bool HawkbitLinuxTransport::setSession(const uint8_t *session, size_t len) {
+  const unsigned char *data = session;
+  if (this->_ctx == NULL) {
+    return false;
+  }
+  SSL_SESSION_free(this->_offeredSession);
+  this->_offeredSession = d2i_SSL_SESSION(NULL, &data, len);
+  return this->_offeredSession != NULL;
+}
+
+bool HawkbitLinuxTransport::sessionResumed() {
+  return this->_ssl != NULL && SSL_session_reused(this->_ssl) == 1;
+}
+
+/* TLS 1.2 sessions can be stored right away, TLS 1.3 tickets are sent after
+   the handshake and stored by onNewSession() once they arrive */
+void HawkbitLinuxTransport::saveSession(HawkbitSessionCache &cache, const char *serverName, uint16_t serverPort) {
+  SSL_SESSION *session;
+  if (this->_ssl == NULL) {
+    return;
+  }
+  this->_sessionCache = &cache;
+  strncpy(this->_sessionServer, serverName, sizeof(this->_sessionServer) - 1);
+  this->_sessionServer[sizeof(this->_sessionServer) - 1] = '\0';
+  this->_sessionPort = serverPort;
+  session = SSL_get1_session(this->_ssl);
+  if (session != NULL) {
+    if (SSL_SESSION_is_resumable(session)) {
+      this->storeSession(session);
+    }
+    SSL_SESSION_free(session);
+  }
+}
+
+void HawkbitLinuxTransport::storeSession(SSL_SESSION *session) {
+  int len = i2d_SSL_SESSION(session, NULL);
+  uint8_t *data;
+  unsigned char *end;
+  if (this->_sessionCache == NULL || len <= 0 || len > HB_TLS_SESSION_MAX_LEN) {
+    return;
+  }
+  data = (uint8_t *)malloc(len);
+  if (data == NULL) {
+    return;
+  }
+  end = data;
+  i2d_SSL_SESSION(session, &end);
+  this->_sessionCache->store(this->_sessionServer, this->_sessionPort, data, len);
+  free(data);
+}
+
+int HawkbitLinuxTransport::onNewSession(SSL *ssl, SSL_SESSION *session) {
+  HawkbitLinuxTransport *transport = (HawkbitLinuxTransport *)SSL_get_app_data(ssl);
+  if (transport != NULL) {
+    transport->storeSession(session);
+  }
+  /* The session is not kept */
+  return 0;
+}
+
+/* Read what the socket has without waiting. Returns false if the buffer
+   is still empty */
+bool HawkbitLinuxTransport::fill() {
+  ssize_t ret;
+  int error;
+  if (this->_head < this->_tail) {
+    return true;
+  }
+  if (this->_socket < 0 || this->_peerClosed) {
+    return false;
+  }
+  this->_head = 0;
+  this->_tail = 0;
+  if (this->_ssl != NULL) {
+    ret = SSL_read(this->_ssl, this->_buffer, sizeof(this->_buffer));
+    if (ret > 0) {
+      this->_tail = ret;
+      return true;
+    }
+    error = SSL_get_error(this->_ssl, ret);
+    if (error != SSL_ERROR_WANT_READ && error != SSL_ERROR_WANT_WRITE) {
+      this->_peerClosed = true;
+      ERR_clear_error();
+    }
+    return false;
+  }
+  ret = recv(this->_socket, this->_buffer, sizeof(this->_buffer), 0);
+  if (ret > 0) {
+    this->_tail = ret;
+    return true;
+  }
+  if (ret == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+    this->_peerClosed = true;
+  }
+  return false;
+}
+
+int HawkbitLinuxTransport::available() {
+  this->fill();
+  return this->_tail - this->_head;
+}
+
+int HawkbitLinuxTransport::read() {
+  if (!this->fill()) {
+    return -1;
+  }
+  return this->_buffer[this->_head++];
+}
+
+int HawkbitLinuxTransport::peek() {
+  if (!this->fill()) {
+    return -1;
+  }
+  return this->_buffer[this->_head];
+}
+
+/* Waits up to the timeout for the requested bytes like WiFiClientSecure */
+size_t HawkbitLinuxTransport::readBytes(char *buffer, size_t length) {
+  unsigned long start = ::millis();
+  unsigned long elapsed;
+  size_t total = 0;
+  size_t part;
+  while (total < length) {
+    if (!this->fill()) {
+      elapsed = ::millis() - start;
+      if (this->_socket < 0 || this->_peerClosed || elapsed >= this->_timeout) {
+        break;
+      }
+      this->waitSocket(POLLIN, this->_timeout - elapsed);
+      continue;
+    }
+    part = this->_tail - this->_head;
+    if (part > length - total) {
+      part = length - total;
+    }
+    memcpy(buffer + total, this->_buffer + this->_head, part);
+    this->_head += part;
+    total += part;
+  }
+  return total;
+}
+
+size_t HawkbitLinuxTransport::write(uint8_t data) {
+  return this->write(&data, 1);
+}
+
+size_t HawkbitLinuxTransport::write(const uint8_t *buffer, size_t size) {
+  unsigned long start = ::millis();
+  unsigned long elapsed;
+  size_t written = 0;
+  ssize_t ret;
+  short events;
+  int error;
+  while (written < size && this->_socket >= 0) {
+    if (this->_ssl != NULL) {
+      ret = SSL_write(this->_ssl, buffer + written, size - written);
+      if (ret > 0) {
+        written += ret;
+        continue;
+      }
+      error = SSL_get_error(this->_ssl, ret);
+      if (error == SSL_ERROR_WANT_READ) {
+        events = POLLIN;
+      } else if (error == SSL_ERROR_WANT_WRITE) {
+        events = POLLOUT;
+      } else {
+        ERR_clear_error();
+        break;
+      }
+    } else {
+      ret = send(this->_socket, buffer + written, size - written, MSG_NOSIGNAL);
+      if (ret > 0) {
+        written += ret;
+        continue;
+      }
+      if (ret < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+        break;
+      }
+      events = POLLOUT;
+    }
+    elapsed = ::millis() - start;
+    if (elapsed >= this->_timeout || !this->waitSocket(events, this->_timeout - elapsed)) {
+      break;
+    }
+  }
+  return written;
+}
+
+HawkbitFileFlashSink::HawkbitFileFlashSink(const char *path) {
+  this->_path = path;
+}
+
+HawkbitFileFlashSink::~HawkbitFileFlashSink(void) {
+  if (this->_file != NULL) {
+    fclose(this->_file);
+  }
+}
+
+bool HawkbitFileFlashSink::open(const char *mode) {
+  if (this->_file != NULL) {
+    fclose(this->_file);
+  }
+  this->_file = fopen(this->_path.c_str(), mode);
+  if (this->_file == NULL) {
+    this->_error = errno;
+    return false;
+  }
+  return true;
+}
+
+bool HawkbitFileFlashSink::begin(size_t size) {
+  this->_size = size;
+  this->_written = 0;
+  this->_finished = false;
+  this->_error = 0;
+  return this->open("wb");
+}
+
+size_t HawkbitFileFlashSink::write(uint8_t *data, size_t len) {
+  size_t written;
+  if (this->_file == NULL || this->_written + len > this->_size) {
+    this->_error = ENOSPC;
+    return 0;
+  }
+  written = fwrite(data, 1, len, this->_file);
+  if (written != len) {
+    this->_error = errno;
+  }
+  this->_written += written;
+  return written;
+}
+
+bool HawkbitFileFlashSink::commit() {
+  if (this->_file == NULL || fflush(this->_file) != 0) {
+    this->_error = this->_file != NULL ? errno : EBADF;
+    return false;
+  }
+  return true;
+}
+
+/* The image is complete if all announced bytes have been written */
+bool HawkbitFileFlashSink::end() {
+  if (!this->commit()) {
+    return false;
+  }
+  fclose(this->_file);
+  this->_file = NULL;
+  if (this->_written != this->_size) {
+    this->_error = EIO;
+    return false;
+  }
+  this->_finished = true;
+  return true;
+}
+
+bool HawkbitFileFlashSink::isFinished() {
+  return this->_finished;
+}
+
+void HawkbitFileFlashSink::abort() {
+  if (this->_file != NULL) {
+    fclose(this->_file);
+    this->_file = NULL;
+  }
+  ::remove(this->_path.c_str());
+  this->_written = 0;
+  this->_finished = false;
+}
+
+int HawkbitFileFlashSink::getError() {
+  return this->_error;
+}
+
+bool HawkbitFileFlashSink::canResume() {
+  return true;
+}
+
+bool HawkbitFileFlashSink::resume(size_t size, size_t offset) {
+  struct stat status;
+  if (stat(this->_path.c_str(), &status) != 0 || (size_t)status.st_size < offset || offset > size ||
+      !this->open("r+b")) {
+    return false;
+  }
+  if (ftruncate(fileno(this->_file), offset) != 0 || fseek(this->_file, offset, SEEK_SET) != 0) {
+    this->_error = errno;
+    return false;
+  }
+  this->_size = size;
+  this->_written = offset;
+  this->_finished = false;
+  return true;
+}
+
+size_t HawkbitFileFlashSink::read(size_t offset, uint8_t *data, size_t len) {
+  ssize_t readLen;
+  if (this->_file == NULL || fflush(this->_file) != 0) {
+    return 0;
+  }
+  readLen = pread(fileno(this->_file), data, len, offset);
+  return readLen > 0 ? readLen : 0;
+}
+
+HawkbitFileStorage::HawkbitFileStorage(const char *directory) {
+  this->_directory = directory;
+  mkdir(directory, 0755);
+}
+
+String HawkbitFileStorage::path(const char *key) {
+  return this->_directory + "/" + key;
+}
+
+size_t HawkbitFileStorage::load(const char *key, void *data, size_t len) {
+  FILE *file = fopen(this->path(key).c_str(), "rb");
+  struct stat status;
+  size_t readLen = 0;
+  if (file == NULL) {
+    return 0;
+  }
+  /* Like the ESP32 storage a value of another size is not loaded */
+  if (fstat(fileno(file), &status) == 0 && (size_t)status.st_size == len) {
+    readLen = fread(data, 1, len, file);
+  }
+  fclose(file);
+  return readLen == len ? readLen : 0;
+}
+
+/* Written to a temporary file first, so a crash keeps the old value */
+bool HawkbitFileStorage::save(const char *key, const void *data, size_t len) {
+  String target = this->path(key);
+  String temporary = target + ".tmp";
+  FILE *file = fopen(temporary.c_str(), "wb");
+  bool saved;
+  if (file == NULL) {
+    return false;
+  }
+  saved = fwrite(data, 1, len, file) == len;
+  saved = fclose(file) == 0 && saved;
+  return saved && rename(temporary.c_str(), target.c_str()) == 0;
+}
+
+void HawkbitFileStorage::remove(const char *key) {
+  unlink(this->path(key).c_str());
+}
+
+unsigned long HawkbitLinuxPlatform::millis() {
+  return ::millis();
+}
+
+Print &HawkbitLinuxPlatform::log() {
+  return Serial;
+}
+
+void HawkbitLinuxPlatform::restart() {
+  this->_restarts++;
+}
+
+time_t HawkbitLinuxPlatform::time() {
+  return ::time(NULL);
+}
+
+#endif /* __linux__ && !ARDUINO */
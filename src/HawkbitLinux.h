@@ -0,0 +1,169 @@
+/**
+
+   @file HawkbitLinux.h
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#ifndef ___HAWKBIT_LINUX_H___
+#define ___HAWKBIT_LINUX_H___
+
+#if defined(__linux__) && !defined(ARDUINO)
+
+#include <Arduino.h>
+#include <openssl/ssl.h>
+#include "HawkbitPlatform.h"
+#include "HawkbitUrl.h"
+
+/* Bytes read from the socket ahead of the parser */
+#ifndef HB_LINUX_RECEIVE_BUFFER_SIZE
+#define HB_LINUX_RECEIVE_BUFFER_SIZE 4096
+#endif
+
+/* Transport over a POSIX socket for the host build. Connections are plain
+   TCP unless TLS is enabled with setCACert() or setInsecure(), like on
+   WiFiClientSecure these apply to all connections */
+class HawkbitLinuxTransport : public HawkbitTransport
+{
+  public:
+    HawkbitLinuxTransport(void);
+    ~HawkbitLinuxTransport(void);
+
+    /* Use TLS and verify the servers against the CA certificates in PEM */
+    bool setCACert(const char *rootCA);
+    /* Use TLS without verifying the servers */
+    void setInsecure();
+
+    bool connect(const char *serverName, uint16_t serverPort) override;
+    bool connected() override;
+    void stop() override;
+
+    bool isSecure() override {
+      return this->_ctx != NULL;
+    }
+
+    bool setSession(const uint8_t *session, size_t len) override;
+    bool sessionResumed() override;
+    void saveSession(HawkbitSessionCache &cache, const char *serverName, uint16_t serverPort) override;
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t readBytes(char *buffer, size_t length) override;
+    using Print::write;
+    size_t write(uint8_t data) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+
+  private:
+    int _socket = -1;
+    bool _peerClosed = false;
+    SSL_CTX *_ctx = NULL;
+    SSL *_ssl = NULL;
+    SSL_SESSION *_offeredSession = NULL;
+    /* Where sessions issued after the handshake go, e.g. TLS 1.3 tickets */
+    HawkbitSessionCache *_sessionCache = NULL;
+    char _sessionServer[HB_URL_HOST_SIZE];
+    uint16_t _sessionPort = 0;
+    uint8_t _buffer[HB_LINUX_RECEIVE_BUFFER_SIZE];
+    size_t _head = 0;
+    size_t _tail = 0;
+
+    bool createContext(bool verify);
+    bool openSocket(const char *serverName, uint16_t serverPort);
+    bool handshake(const char *serverName);
+    bool waitSocket(short events, unsigned long timeout);
+    bool fill();
+    void storeSession(SSL_SESSION *session);
+    static int onNewSession(SSL *ssl, SSL_SESSION *session);
+};
+
+/* Flash sink writing the image into a file. Written data stays in the file,
+   so an interrupted download can be resumed after a restart of the process */
+class HawkbitFileFlashSink : public HawkbitFlashSink
+{
+  public:
+    HawkbitFileFlashSink(const char *path);
+    ~HawkbitFileFlashSink(void);
+
+    bool begin(size_t size) override;
+    size_t write(uint8_t *data, size_t len) override;
+    bool end() override;
+    bool commit() override;
+    bool isFinished() override;
+    void abort() override;
+    int getError() override;
+    bool canResume() override;
+    bool resume(size_t size, size_t offset) override;
+    size_t read(size_t offset, uint8_t *data, size_t len) override;
+
+    /* Size of the image activated by the last successful end() */
+    size_t getImageSize() {
+      return this->_finished ? this->_size : 0;
+    }
+
+  private:
+    String _path;
+    FILE *_file = NULL;
+    size_t _size = 0;
+    size_t _written = 0;
+    bool _finished = false;
+    int _error = 0;
+
+    bool open(const char *mode);
+};
+
+/* Storage with one file per key in a directory */
+class HawkbitFileStorage : public HawkbitStorage
+{
+  public:
+    HawkbitFileStorage(const char *directory);
+
+    size_t load(const char *key, void *data, size_t len) override;
+    bool save(const char *key, const void *data, size_t len) override;
+    void remove(const char *key) override;
+
+  private:
+    String _directory;
+
+    String path(const char *key);
+};
+
+/* Restarting is left to the caller, restart() is only counted, so a test can
+   create a new HawkbitDdi on the same storage like after a reboot */
+class HawkbitLinuxPlatform : public HawkbitPlatform
+{
+  public:
+    unsigned long millis() override;
+    Print &log() override;
+    void restart() override;
+    time_t time() override;
+
+    unsigned long getRestarts() {
+      return this->_restarts;
+    }
+
+  private:
+    unsigned long _restarts = 0;
+};
+
+#endif /* __linux__ && !ARDUINO */
+
+#endif /* ___HAWKBIT_LINUX_H___ */
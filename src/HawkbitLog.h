@@ -0,0 +1,78 @@
+/**
+
+   @file HawkbitLog.h
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#ifndef ___HAWKBIT_LOG_H___
+#define ___HAWKBIT_LOG_H___
+
+#include <Arduino.h>
+
+#define HB_LOG_LEVEL_NONE 0
+#define HB_LOG_LEVEL_ERROR 1
+#define HB_LOG_LEVEL_WARN 2
+#define HB_LOG_LEVEL_INFO 3
+#define HB_LOG_LEVEL_DEBUG 4
+/* Dumps of request bodies and parsing details */
+#define HB_LOG_LEVEL_TRACE 5
+
+/* Messages above this level are not compiled in */
+#ifndef HB_LOG_LEVEL
+#define HB_LOG_LEVEL HB_LOG_LEVEL_INFO
+#endif
+
+#define HB_LOG_ENABLED(level) (HB_LOG_LEVEL >= (level))
+
+/* printf style logging to a Print sink, e.g. HB_LOG_INFO(log, "Polled %d\r\n", n).
+   The arguments of disabled levels are not evaluated */
+#if HB_LOG_ENABLED(HB_LOG_LEVEL_ERROR)
+#define HB_LOG_ERROR(sink, ...) (sink)->printf(__VA_ARGS__)
+#else
+#define HB_LOG_ERROR(sink, ...) do {} while (0)
+#endif
+
+#if HB_LOG_ENABLED(HB_LOG_LEVEL_WARN)
+#define HB_LOG_WARN(sink, ...) (sink)->printf(__VA_ARGS__)
+#else
+#define HB_LOG_WARN(sink, ...) do {} while (0)
+#endif
+
+#if HB_LOG_ENABLED(HB_LOG_LEVEL_INFO)
+#define HB_LOG_INFO(sink, ...) (sink)->printf(__VA_ARGS__)
+#else
+#define HB_LOG_INFO(sink, ...) do {} while (0)
+#endif
+
+#if HB_LOG_ENABLED(HB_LOG_LEVEL_DEBUG)
+#define HB_LOG_DEBUG(sink, ...) (sink)->printf(__VA_ARGS__)
+#else
+#define HB_LOG_DEBUG(sink, ...) do {} while (0)
+#endif
+
+#if HB_LOG_ENABLED(HB_LOG_LEVEL_TRACE)
+#define HB_LOG_TRACE(sink, ...) (sink)->printf(__VA_ARGS__)
+#else
+#define HB_LOG_TRACE(sink, ...) do {} while (0)
+#endif
+
+#endif /* ___HAWKBIT_LOG_H___ */
@@ -0,0 +1,280 @@
+/**
+
+   @file HawkbitPipeline.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "HawkbitPipeline.h"
+
+HawkbitPipelinedFlashSink::HawkbitPipelinedFlashSink() {
+  memset(this->_buffers, 0, sizeof(this->_buffers));
+  this->_failed = false;
+  this->_canceled = false;
+}
+
+HawkbitPipelinedFlashSink::~HawkbitPipelinedFlashSink(void) {
+  this->stop(true);
+}
+
+bool HawkbitPipelinedFlashSink::begin(size_t size) {
+  this->stop(true);
+  this->_failed = false;
+  this->_canceled = false;
+  this->_current = NULL;
+  this->_fill = 0;
+  if (!this->_sink->begin(size)) {
+    return false;
+  }
+#ifdef HB_PIPELINE_THREADED
+  for (int i = 0; i < HB_PIPELINE_BUFFERS; i++) {
+    this->_buffers[i] = (uint8_t *)malloc(HB_PIPELINE_BUFFER_SIZE);
+    if (this->_buffers[i] == NULL) {
+      /* Not enough heap, write through without pipelining */
+      this->stop(true);
+      return true;
+    }
+  }
+  if (!this->createQueues()) {
+    this->stop(true);
+    return true;
+  }
+  for (int i = 0; i < HB_PIPELINE_BUFFERS; i++) {
+    this->sendFree(this->_buffers[i]);
+  }
+  if (!this->startWriter()) {
+    this->stop(true);
+    return true;
+  }
+  this->_running = true;
+#endif
+  return true;
+}
+
+#ifdef HB_PIPELINE_THREADED
+/* Body of the writer task */
+void HawkbitPipelinedFlashSink::writeBlocks() {
+  t_block block;
+  for (;;) {
+    this->receiveFull(&block);
+    /* An empty block stops the writer */
+    if (block.data == NULL) {
+      break;
+    }
+    if (!this->_canceled && !this->_failed && this->_sink->write(block.data, block.len) != block.len) {
+      this->_failed = true;
+    }
+    this->sendFree(block.data);
+  }
+}
+#endif
+
+#ifdef ARDUINO_ARCH_ESP32
+void HawkbitPipelinedFlashSink::writerTask(void *param) {
+  HawkbitPipelinedFlashSink *pipeline = (HawkbitPipelinedFlashSink *)param;
+  pipeline->writeBlocks();
+  xSemaphoreGive(pipeline->_writerDone);
+  vTaskDelete(NULL);
+}
+
+bool HawkbitPipelinedFlashSink::startWriter() {
+  return xTaskCreate(HawkbitPipelinedFlashSink::writerTask, "hbFlashWriter", HB_PIPELINE_TASK_STACK, this, 1, NULL) == pdPASS;
+}
+
+void HawkbitPipelinedFlashSink::joinWriter() {
+  xSemaphoreTake(this->_writerDone, portMAX_DELAY);
+}
+
+bool HawkbitPipelinedFlashSink::createQueues() {
+  this->_fullQueue = xQueueCreate(HB_PIPELINE_BUFFERS + 1, sizeof(t_block));
+  this->_freeQueue = xQueueCreate(HB_PIPELINE_BUFFERS, sizeof(uint8_t *));
+  this->_writerDone = xSemaphoreCreateBinary();
+  return this->_fullQueue != NULL && this->_freeQueue != NULL && this->_writerDone != NULL;
+}
+
+void HawkbitPipelinedFlashSink::deleteQueues() {
+  if (this->_fullQueue != NULL) {
+    vQueueDelete(this->_fullQueue);
+    this->_fullQueue = NULL;
+  }
+  if (this->_freeQueue != NULL) {
+    vQueueDelete(this->_freeQueue);
+    this->_freeQueue = NULL;
+  }
+  if (this->_writerDone != NULL) {
+    vSemaphoreDelete(this->_writerDone);
+    this->_writerDone = NULL;
+  }
+}
+
+void HawkbitPipelinedFlashSink::sendFull(const t_block &block) {
+  xQueueSend(this->_fullQueue, &block, portMAX_DELAY);
+}
+
+void HawkbitPipelinedFlashSink::receiveFull(t_block *block) {
+  xQueueReceive(this->_fullQueue, block, portMAX_DELAY);
+}
+
+void HawkbitPipelinedFlashSink::sendFree(uint8_t *buffer) {
+  xQueueSend(this->_freeQueue, &buffer, portMAX_DELAY);
+}
+
+uint8_t *HawkbitPipelinedFlashSink::receiveFree() {
+  uint8_t *buffer;
+  xQueueReceive(this->_freeQueue, &buffer, portMAX_DELAY);
+  return buffer;
+}
+#elif defined(HB_PIPELINE_THREADED)
+bool HawkbitPipelinedFlashSink::startWriter() {
+  this->_writer = std::thread(&HawkbitPipelinedFlashSink::writeBlocks, this);
+  return true;
+}
+
+void HawkbitPipelinedFlashSink::joinWriter() {
+  this->_writer.join();
+}
+
+bool HawkbitPipelinedFlashSink::createQueues() {
+  return true;
+}
+
+void HawkbitPipelinedFlashSink::deleteQueues() {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  this->_fullQueue.clear();
+  this->_freeQueue.clear();
+}
+
+/* Both queues are bounded by the number of buffers, only the receivers wait */
+void HawkbitPipelinedFlashSink::sendFull(const t_block &block) {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  this->_fullQueue.push_back(block);
+  this->_queued.notify_all();
+}
+
+void HawkbitPipelinedFlashSink::receiveFull(t_block *block) {
+  std::unique_lock<std::mutex> lock(this->_mutex);
+  this->_queued.wait(lock, [this] { return !this->_fullQueue.empty(); });
+  *block = this->_fullQueue.front();
+  this->_fullQueue.pop_front();
+}
+
+void HawkbitPipelinedFlashSink::sendFree(uint8_t *buffer) {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  this->_freeQueue.push_back(buffer);
+  this->_queued.notify_all();
+}
+
+uint8_t *HawkbitPipelinedFlashSink::receiveFree() {
+  uint8_t *buffer;
+  std::unique_lock<std::mutex> lock(this->_mutex);
+  this->_queued.wait(lock, [this] { return !this->_freeQueue.empty(); });
+  buffer = this->_freeQueue.front();
+  this->_freeQueue.pop_front();
+  return buffer;
+}
+#endif
+
+size_t HawkbitPipelinedFlashSink::write(uint8_t *data, size_t len) {
+  size_t copied = 0;
+  if (!this->_running) {
+    return this->_sink->write(data, len);
+  }
+#ifdef HB_PIPELINE_THREADED
+  while (copied < len && !this->_failed) {
+    size_t toCopy;
+    if (this->_current == NULL) {
+      /* Backpressure: wait until the writer has released a buffer */
+      this->_current = this->receiveFree();
+      this->_fill = 0;
+    }
+    toCopy = len - copied;
+    if (toCopy > HB_PIPELINE_BUFFER_SIZE - this->_fill) {
+      toCopy = HB_PIPELINE_BUFFER_SIZE - this->_fill;
+    }
+    memcpy(this->_current + this->_fill, data + copied, toCopy);
+    this->_fill += toCopy;
+    copied += toCopy;
+    if (this->_fill == HB_PIPELINE_BUFFER_SIZE) {
+      this->submit();
+    }
+  }
+#endif
+  return this->_failed ? 0 : copied;
+}
+
+bool HawkbitPipelinedFlashSink::submit() {
+#ifdef HB_PIPELINE_THREADED
+  t_block block;
+  if (this->_current == NULL || this->_fill == 0) {
+    return true;
+  }
+  block.data = this->_current;
+  block.len = this->_fill;
+  this->_current = NULL;
+  this->_fill = 0;
+  this->sendFull(block);
+#endif
+  return true;
+}
+
+/* Stop the writer task after the queued blocks, cancel skips writing them */
+void HawkbitPipelinedFlashSink::stop(bool cancel) {
+#ifdef HB_PIPELINE_THREADED
+  t_block block = { NULL, 0 };
+  if (this->_running) {
+    this->_canceled = cancel;
+    if (!cancel) {
+      this->submit();
+    }
+    this->sendFull(block);
+    this->joinWriter();
+    this->_running = false;
+  }
+  this->deleteQueues();
+#else
+  (void)cancel;
+#endif
+  for (int i = 0; i < HB_PIPELINE_BUFFERS; i++) {
+    free(this->_buffers[i]);
+    this->_buffers[i] = NULL;
+  }
+  this->_current = NULL;
+  this->_fill = 0;
+}
+
+bool HawkbitPipelinedFlashSink::end() {
+  if (!this->commit()) {
+    this->_sink->abort();
+    return false;
+  }
+  return this->_sink->end();
+}
+
+/* Wait for the writer to store the remaining blocks */
+bool HawkbitPipelinedFlashSink::commit() {
+  this->stop(false);
+  return !this->_failed;
+}
+
+void HawkbitPipelinedFlashSink::abort() {
+  this->stop(true);
+  this->_sink->abort();
+}
@@ -0,0 +1,144 @@
+/**
+
+   @file HawkbitPipeline.h
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#ifndef ___HAWKBIT_PIPELINE_H___
+#define ___HAWKBIT_PIPELINE_H___
+
+#include <Arduino.h>
+#include "HawkbitPlatform.h"
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#define HB_PIPELINE_THREADED
+#elif defined(__linux__) && !defined(ARDUINO)
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#define HB_PIPELINE_THREADED
+#endif
+
+/* Number of buffers in the ring between network reads and flash writes */
+#ifndef HB_PIPELINE_BUFFERS
+#define HB_PIPELINE_BUFFERS 2
+#endif
+
+/* Size of one buffer, a multiple of the flash sector size */
+#ifndef HB_PIPELINE_BUFFER_SIZE
+#define HB_PIPELINE_BUFFER_SIZE 4096
+#endif
+
+#ifndef HB_PIPELINE_TASK_STACK
+#define HB_PIPELINE_TASK_STACK 4096
+#endif
+
+/* Flash sink decorator that commits full, sector aligned buffers to the
+   wrapped sink in a separate task, so the next buffer can be received while
+   the previous one is erased and programmed. write() blocks while all
+   buffers are in flight. The task is a FreeRTOS task on ESP32 and a
+   std::thread in the host build, elsewhere data is written through */
+class HawkbitPipelinedFlashSink : public HawkbitFlashSink
+{
+  public:
+    HawkbitPipelinedFlashSink(void);
+    ~HawkbitPipelinedFlashSink(void);
+
+    void setSink(HawkbitFlashSink *sink) {
+      this->_sink = sink;
+    }
+
+    bool begin(size_t size) override;
+    size_t write(uint8_t *data, size_t len) override;
+    bool end() override;
+    bool commit() override;
+    void abort() override;
+
+    bool isFinished() override {
+      return this->_sink->isFinished();
+    }
+
+    int getError() override {
+      return this->_sink->getError();
+    }
+
+    /* Bytes accepted by write() may not be committed yet, so the download
+       progress cannot be saved for a resume after reboot */
+    bool canResume() override {
+      return false;
+    }
+
+  private:
+    typedef struct str_block {
+      uint8_t *data;
+      size_t len;
+    } t_block;
+
+    HawkbitFlashSink *_sink = NULL;
+    uint8_t *_buffers[HB_PIPELINE_BUFFERS];
+    uint8_t *_current = NULL;
+    size_t _fill = 0;
+    bool _running = false;
+#ifdef ARDUINO_ARCH_ESP32
+    volatile bool _failed = false;
+    volatile bool _canceled = false;
+    QueueHandle_t _fullQueue = NULL;
+    QueueHandle_t _freeQueue = NULL;
+    SemaphoreHandle_t _writerDone = NULL;
+
+    static void writerTask(void *param);
+#elif defined(HB_PIPELINE_THREADED)
+    std::atomic<bool> _failed;
+    std::atomic<bool> _canceled;
+    std::thread _writer;
+    std::mutex _mutex;
+    std::condition_variable _queued;
+    std::deque<t_block> _fullQueue;
+    std::deque<uint8_t *> _freeQueue;
+#else
+    bool _failed = false;
+    bool _canceled = false;
+#endif
+
+#ifdef HB_PIPELINE_THREADED
+    /* Primitives of the platform, they wait as long as needed */
+    bool startWriter();
+    void joinWriter();
+    bool createQueues();
+    void deleteQueues();
+    void sendFull(const t_block &block);
+    void receiveFull(t_block *block);
+    void sendFree(uint8_t *buffer);
+    uint8_t *receiveFree();
+    void writeBlocks();
+#endif
+    bool submit();
+    void stop(bool cancel);
+};
+
+#endif /* ___HAWKBIT_PIPELINE_H___ */
@@ -0,0 +1,134 @@
+/**
+
+   @file HawkbitPlatform.h
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#ifndef ___HAWKBIT_PLATFORM_H___
+#define ___HAWKBIT_PLATFORM_H___
+
+#include <Arduino.h>
+#include <time.h>
+#include "HawkbitSessionCache.h"
+
+/* Byte stream connection to a DDI or artifact server */
+class HawkbitTransport : public Stream
+{
+  public:
+    virtual ~HawkbitTransport(void) {}
+
+    virtual bool connect(const char *serverName, uint16_t serverPort) = 0;
+    virtual bool connected() = 0;
+    virtual void stop() = 0;
+
+    /* Whether connections use TLS, selects the default port of the Host header */
+    virtual bool isSecure() {
+      return true;
+    }
+
+    /* Optional TLS session resumption, offer a cached session before connect() */
+    virtual bool setSession(const uint8_t *session, size_t len) {
+      return false;
+    }
+
+    /* Whether the last connect() used an abbreviated handshake */
+    virtual bool sessionResumed() {
+      return false;
+    }
+
+    /* Store the session of the current connection after a full handshake */
+    virtual void saveSession(HawkbitSessionCache &cache, const char *serverName, uint16_t serverPort) {
+    }
+};
+
+/* Destination for the downloaded firmware image */
+class HawkbitFlashSink
+{
+  public:
+    virtual ~HawkbitFlashSink(void) {}
+
+    virtual bool begin(size_t size) = 0;
+    virtual size_t write(uint8_t *data, size_t len) = 0;
+    /* Finalize the image, returns false on error */
+    virtual bool end() = 0;
+    /* Make sure all data passed to write() is in flash without activating the
+       image yet, end() is called later. Returns false on error */
+    virtual bool commit() {
+      return true;
+    }
+    /* Whether the complete image has been written and verified */
+    virtual bool isFinished() = 0;
+    virtual void abort() = 0;
+    virtual int getError() = 0;
+
+    /* Whether data passed to write() survives a reboot, so a download can be
+       continued with resume() */
+    virtual bool canResume() {
+      return false;
+    }
+
+    /* Continue an image of which offset bytes have already been written */
+    virtual bool resume(size_t size, size_t offset) {
+      return false;
+    }
+
+    /* Read back already written data, resumable sinks need this to verify the
+       artifact hash over the part written before a reboot */
+    virtual size_t read(size_t offset, uint8_t *data, size_t len) {
+      return 0;
+    }
+};
+
+/* Non-volatile key/value storage for state that has to survive a reboot */
+class HawkbitStorage
+{
+  public:
+    virtual ~HawkbitStorage(void) {}
+
+    /* Returns the number of bytes read, 0 if the key does not exist */
+    virtual size_t load(const char *key, void *data, size_t len) = 0;
+    virtual bool save(const char *key, const void *data, size_t len) = 0;
+    virtual void remove(const char *key) = 0;
+};
+
+/* Clock, log output and reboot of the device */
+class HawkbitPlatform
+{
+  public:
+    virtual ~HawkbitPlatform(void) {}
+
+    virtual unsigned long millis() = 0;
+    virtual Print &log() = 0;
+    virtual void restart() = 0;
+
+    /* Wall clock time for the timestamps of the feedback, 0 if unknown */
+    virtual time_t time() {
+      return 0;
+    }
+
+    /* Free heap in bytes for the statistics, 0 if unknown */
+    virtual uint32_t freeHeap() {
+      return 0;
+    }
+};
+
+#endif /* ___HAWKBIT_PLATFORM_H___ */
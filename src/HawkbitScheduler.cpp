@@ -0,0 +1,71 @@
+/**
+
+   @file HawkbitScheduler.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "HawkbitScheduler.h"
+
+void HawkbitScheduler::begin(const char *controllerId, unsigned long now) {
+  /* FNV-1a of the controller ID, so every device gets its own sequence */
+  uint32_t seed = 2166136261UL;
+  while (controllerId != NULL && *controllerId != '\0') {
+    seed = (seed ^ (uint8_t)*controllerId++) * 16777619UL;
+  }
+  /* xorshift must not start at 0 */
+  this->_random = seed != 0 ? seed : 1;
+  this->_failures = 0;
+  this->_nextTime = now + this->jitter(HB_POLL_STARTUP_JITTER);
+}
+
+void HawkbitScheduler::success(unsigned long now, unsigned long interval) {
+  if (interval == 0) {
+    interval = HB_POLL_DEFAULT_INTERVAL;
+  }
+  this->_failures = 0;
+  this->_nextTime = now + interval + this->jitter(interval / 100UL * HB_POLL_JITTER_PERCENT);
+}
+
+void HawkbitScheduler::failure(unsigned long now) {
+  unsigned long delay = HB_POLL_BACKOFF_MIN;
+  for (uint8_t i = 0; i < this->_failures && delay < HB_POLL_BACKOFF_MAX; i++) {
+    delay *= 2;
+  }
+  if (delay > HB_POLL_BACKOFF_MAX) {
+    delay = HB_POLL_BACKOFF_MAX;
+  }
+  if (this->_failures < 255) {
+    this->_failures++;
+  }
+  this->_nextTime = now + delay + this->jitter(delay / 100UL * HB_POLL_JITTER_PERCENT);
+}
+
+/* Pseudo random value in [0, range] */
+unsigned long HawkbitScheduler::jitter(unsigned long range) {
+  this->_random ^= this->_random << 13;
+  this->_random ^= this->_random >> 17;
+  this->_random ^= this->_random << 5;
+  if (range == 0) {
+    return 0;
+  }
+  return this->_random % (range + 1);
+}
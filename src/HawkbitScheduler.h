@@ -0,0 +1,105 @@
+/**
+
+   @file HawkbitScheduler.h
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#ifndef ___HAWKBIT_SCHEDULER_H___
+#define ___HAWKBIT_SCHEDULER_H___
+
+#include <Arduino.h>
+
+/* Poll interval in ms if the server does not send one */
+#ifndef HB_POLL_DEFAULT_INTERVAL
+#define HB_POLL_DEFAULT_INTERVAL 300000UL
+#endif
+
+/* Maximum jitter added to each poll interval in percent of the interval */
+#ifndef HB_POLL_JITTER_PERCENT
+#define HB_POLL_JITTER_PERCENT 10
+#endif
+
+/* Maximum delay of the first poll after begin() in ms. A fleet that comes
+   up at the same time, e.g. after a power outage, polls spread over this
+   time instead of all at once. Pending feedback and config data are sent
+   right away */
+#ifndef HB_POLL_STARTUP_JITTER
+#define HB_POLL_STARTUP_JITTER HB_POLL_DEFAULT_INTERVAL
+#endif
+
+/* Delay after the first failed poll in ms, doubled with each further failure */
+#ifndef HB_POLL_BACKOFF_MIN
+#define HB_POLL_BACKOFF_MIN 5000UL
+#endif
+
+#ifndef HB_POLL_BACKOFF_MAX
+#define HB_POLL_BACKOFF_MAX 600000UL
+#endif
+
+/* Decides when the controller resource is polled next. The jitter is
+   deterministic per device as it is seeded from the controller ID. All
+   times are millis() values and may wrap around. */
+class HawkbitScheduler
+{
+  public:
+    void begin(const char *controllerId, unsigned long now);
+
+    /* Whether the next poll is due */
+    bool isDue(unsigned long now) {
+      return HawkbitScheduler::reached(now, this->_nextTime);
+    }
+
+    /* Schedule the next poll after a successful one, 0 uses the default interval */
+    void success(unsigned long now, unsigned long interval);
+
+    /* Schedule a retry with exponential backoff */
+    void failure(unsigned long now);
+
+    /* Continue a schedule kept across a reboot, the next poll is in delay ms */
+    void resume(unsigned long now, unsigned long delay) {
+      this->_failures = 0;
+      this->_nextTime = now + delay;
+    }
+
+    unsigned long getNextTime() {
+      return this->_nextTime;
+    }
+
+    uint8_t getFailures() {
+      return this->_failures;
+    }
+
+    /* Check whether time has been reached at now, safe across the wraparound
+       of the 32 bit millis() counter */
+    static bool reached(unsigned long now, unsigned long time) {
+      return (int32_t)((uint32_t)now - (uint32_t)time) >= 0;
+    }
+
+  private:
+    uint32_t _random = 1;
+    uint8_t _failures = 0;
+    unsigned long _nextTime = 0;
+
+    unsigned long jitter(unsigned long range);
+};
+
+#endif /* ___HAWKBIT_SCHEDULER_H___ */
@@ -0,0 +1,118 @@
+/**
+
+   @file HawkbitSessionCache.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "HawkbitSessionCache.h"
+
+HawkbitSessionCache::HawkbitSessionCache() {
+  memset(this->_sessions, 0, sizeof(this->_sessions));
+}
+
+HawkbitSessionCache::~HawkbitSessionCache(void) {
+  this->clear();
+}
+
+/* FNV-1a */
+uint32_t HawkbitSessionCache::hashName(const char *serverName) {
+  uint32_t hash = 2166136261UL;
+  while (*serverName != '\0') {
+    hash = (hash ^ (uint8_t)*serverName++) * 16777619UL;
+  }
+  return hash;
+}
+
+HawkbitSessionCache::t_session *HawkbitSessionCache::find(const char *serverName, uint16_t serverPort) {
+  uint32_t hash = HawkbitSessionCache::hashName(serverName);
+  size_t length = strlen(serverName);
+  for (int i = 0; i < HB_TLS_SESSION_CACHE_SLOTS; i++) {
+    if (this->_sessions[i].data != NULL && this->_sessions[i].port == serverPort &&
+        this->_sessions[i].serverHash == hash && this->_sessions[i].serverLength == length) {
+      return &this->_sessions[i];
+    }
+  }
+  return NULL;
+}
+
+void HawkbitSessionCache::release(t_session *session) {
+  free(session->data);
+  memset(session, 0, sizeof(t_session));
+}
+
+bool HawkbitSessionCache::lookup(const char *serverName, uint16_t serverPort, const uint8_t **data, size_t *len) {
+  t_session *session = this->find(serverName, serverPort);
+  if (session == NULL) {
+    return false;
+  }
+  session->lastUsed = ++this->_useCounter;
+  *data = session->data;
+  *len = session->len;
+  return true;
+}
+
+void HawkbitSessionCache::store(const char *serverName, uint16_t serverPort, const uint8_t *data, size_t len) {
+  t_session *session = this->find(serverName, serverPort);
+  if (len == 0 || len > HB_TLS_SESSION_MAX_LEN) {
+    if (session != NULL) {
+      this->release(session);
+    }
+    return;
+  }
+  if (session == NULL) {
+    /* Take a free slot or replace the least recently used one */
+    session = &this->_sessions[0];
+    for (int i = 0; i < HB_TLS_SESSION_CACHE_SLOTS; i++) {
+      if (this->_sessions[i].data == NULL) {
+        session = &this->_sessions[i];
+        break;
+      }
+      if (this->_sessions[i].lastUsed < session->lastUsed) {
+        session = &this->_sessions[i];
+      }
+    }
+  }
+  this->release(session);
+  session->data = (uint8_t *)malloc(len);
+  if (session->data == NULL) {
+    return;
+  }
+  memcpy(session->data, data, len);
+  session->len = len;
+  session->serverHash = HawkbitSessionCache::hashName(serverName);
+  session->serverLength = strlen(serverName);
+  session->port = serverPort;
+  session->lastUsed = ++this->_useCounter;
+}
+
+void HawkbitSessionCache::invalidate(const char *serverName, uint16_t serverPort) {
+  t_session *session = this->find(serverName, serverPort);
+  if (session != NULL) {
+    this->release(session);
+  }
+}
+
+void HawkbitSessionCache::clear() {
+  for (int i = 0; i < HB_TLS_SESSION_CACHE_SLOTS; i++) {
+    this->release(&this->_sessions[i]);
+  }
+}
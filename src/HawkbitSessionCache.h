@@ -0,0 +1,95 @@
+/**
+
+   @file HawkbitSessionCache.h
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#ifndef ___HAWKBIT_SESSION_CACHE_H___
+#define ___HAWKBIT_SESSION_CACHE_H___
+
+#include <Arduino.h>
+
+/* Number of hosts to remember TLS sessions for (management and artifact host) */
+#ifndef HB_TLS_SESSION_CACHE_SLOTS
+#define HB_TLS_SESSION_CACHE_SLOTS 2
+#endif
+
+/* Upper limit for one serialized session (ID or ticket plus master secret) */
+#ifndef HB_TLS_SESSION_MAX_LEN
+#define HB_TLS_SESSION_MAX_LEN 2048
+#endif
+
+/* Small least-recently-used cache of serialized TLS sessions per host and port.
+   A reconnect offers the cached session to the transport so only an abbreviated
+   handshake is needed. */
+class HawkbitSessionCache
+{
+  public:
+    HawkbitSessionCache(void);
+    ~HawkbitSessionCache(void);
+
+    /* Look up the session for a host. Returns false if there is none */
+    bool lookup(const char *serverName, uint16_t serverPort, const uint8_t **data, size_t *len);
+    void store(const char *serverName, uint16_t serverPort, const uint8_t *data, size_t len);
+    void invalidate(const char *serverName, uint16_t serverPort);
+    void clear();
+
+    /* Count the outcome of a handshake */
+    void countHandshake(bool resumed) {
+      if (resumed) {
+        this->_hits++;
+      } else {
+        this->_misses++;
+      }
+    }
+
+    unsigned long getHits() {
+      return this->_hits;
+    }
+
+    unsigned long getMisses() {
+      return this->_misses;
+    }
+
+  private:
+    /* Host names are kept as hash and length, a collision only costs a full
+       handshake as the server does not accept the session of another host */
+    typedef struct str_session {
+      uint32_t serverHash;
+      uint16_t serverLength;
+      uint16_t port;
+      uint8_t *data;
+      size_t len;
+      unsigned long lastUsed;
+    } t_session;
+
+    t_session _sessions[HB_TLS_SESSION_CACHE_SLOTS];
+    unsigned long _useCounter = 0;
+    unsigned long _hits = 0;
+    unsigned long _misses = 0;
+
+    t_session *find(const char *serverName, uint16_t serverPort);
+    static uint32_t hashName(const char *serverName);
+    void release(t_session *session);
+};
+
+#endif /* ___HAWKBIT_SESSION_CACHE_H___ */
@@ -0,0 +1,113 @@
+/**
+
+   @file HawkbitUrl.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "HawkbitUrl.h"
+
+bool HawkbitUrl::parse(const char *url) {
+  const char *authority;
+  const char *authorityEnd;
+  const char *hostEnd;
+  const char *c;
+  unsigned long port = 0;
+  this->_host = NULL;
+  this->_hostLength = 0;
+  this->_path = NULL;
+  this->_pathLength = 0;
+  if (url == NULL) {
+    return false;
+  }
+  if (strncasecmp(url, "https://", 8) == 0) {
+    this->_secure = true;
+    this->_port = 443;
+    authority = url + 8;
+  } else if (strncasecmp(url, "http://", 7) == 0) {
+    this->_secure = false;
+    this->_port = 80;
+    authority = url + 7;
+  } else {
+    return false;
+  }
+  authorityEnd = authority + strcspn(authority, "/?#");
+  /* Skip user information */
+  for (c = authority; c < authorityEnd; c++) {
+    if (*c == '@') {
+      authority = c + 1;
+    }
+  }
+  if (*authority == '[') {
+    /* IPv6 literal */
+    hostEnd = (const char *)memchr(authority, ']', authorityEnd - authority);
+    if (hostEnd == NULL) {
+      return false;
+    }
+    this->_host = authority + 1;
+    this->_hostLength = hostEnd - this->_host;
+    hostEnd++;
+  } else {
+    hostEnd = (const char *)memchr(authority, ':', authorityEnd - authority);
+    if (hostEnd == NULL) {
+      hostEnd = authorityEnd;
+    }
+    this->_host = authority;
+    this->_hostLength = hostEnd - authority;
+  }
+  if (this->_hostLength == 0) {
+    return false;
+  }
+  if (hostEnd < authorityEnd) {
+    if (*hostEnd != ':') {
+      return false;
+    }
+    for (c = hostEnd + 1; c < authorityEnd; c++) {
+      if (*c < '0' || *c > '9' || port > 65535) {
+        return false;
+      }
+      port = port * 10 + (*c - '0');
+    }
+    /* An empty port means the default one */
+    if (c > hostEnd + 1) {
+      if (port == 0 || port > 65535) {
+        return false;
+      }
+      this->_port = port;
+    }
+  }
+  this->_path = authorityEnd;
+  this->_pathLength = strcspn(authorityEnd, "#");
+  if (this->_pathLength == 0) {
+    this->_path = "/";
+    this->_pathLength = 1;
+  }
+  return true;
+}
+
+bool HawkbitUrl::copyHost(char *buffer, size_t size) {
+  if (this->_hostLength >= size) {
+    return false;
+  }
+  memcpy(buffer, this->_host, this->_hostLength);
+  buffer[this->_hostLength] = '\0';
+  return true;
+}
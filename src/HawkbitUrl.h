@@ -0,0 +1,84 @@
+/**
+
+   @file HawkbitUrl.h
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#ifndef ___HAWKBIT_URL_H___
+#define ___HAWKBIT_URL_H___
+
+#include <Arduino.h>
+
+/* Longest host name that can be copied for connecting */
+#ifndef HB_URL_HOST_SIZE
+#define HB_URL_HOST_SIZE 256
+#endif
+
+/* Splits an absolute http or https URL into views of the original string.
+   The string is neither modified nor copied and has to outlive the views. */
+class HawkbitUrl
+{
+  public:
+    /* Returns false if the URL is not an absolute http(s) URL with a host */
+    bool parse(const char *url);
+
+    bool isSecure() {
+      return this->_secure;
+    }
+
+    /* Host without brackets of IPv6 literals, not terminated */
+    const char *getHost() {
+      return this->_host;
+    }
+
+    size_t getHostLength() {
+      return this->_hostLength;
+    }
+
+    /* Port of the URL or the default port of the scheme */
+    uint16_t getPort() {
+      return this->_port;
+    }
+
+    /* Path including the query up to the end of the string. A fragment
+       is part of it, getPathLength() excludes it */
+    const char *getPath() {
+      return this->_path;
+    }
+
+    size_t getPathLength() {
+      return this->_pathLength;
+    }
+
+    /* Copy the host as terminated string, e.g. for connect() */
+    bool copyHost(char *buffer, size_t size);
+
+  private:
+    bool _secure = false;
+    const char *_host = NULL;
+    size_t _hostLength = 0;
+    uint16_t _port = 0;
+    const char *_path = NULL;
+    size_t _pathLength = 0;
+};
+
+#endif /* ___HAWKBIT_URL_H___ */
@@ -0,0 +1,861 @@
+/**
+
+   @file DdiServer.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "DdiServer.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509v3.h>
+
+/* Time without a request after which a kept alive connection is closed */
+#define DDI_SERVER_IDLE_TIMEOUT 10000
+
+static std::string toPem(X509 *cert, EVP_PKEY *key) {
+  BIO *bio = BIO_new(BIO_s_mem());
+  char *data;
+  long length;
+  std::string pem;
+  if (cert != NULL) {
+    PEM_write_bio_X509(bio, cert);
+  } else {
+    PEM_write_bio_PrivateKey(bio, key, NULL, NULL, 0, NULL, NULL);
+  }
+  length = BIO_get_mem_data(bio, &data);
+  pem.assign(data, length);
+  BIO_free(bio);
+  return pem;
+}
+
+static bool addExtension(X509 *cert, X509 *issuer, int nid, const char *value) {
+  X509V3_CTX ctx;
+  X509_EXTENSION *extension;
+  bool added;
+  X509V3_set_ctx_nodb(&ctx);
+  X509V3_set_ctx(&ctx, issuer, cert, NULL, NULL, 0);
+  extension = X509V3_EXT_conf_nid(NULL, &ctx, nid, value);
+  if (extension == NULL) {
+    return false;
+  }
+  added = X509_add_ext(cert, extension, -1) == 1;
+  X509_EXTENSION_free(extension);
+  return added;
+}
+
+static X509 *createCertificate(EVP_PKEY *key, const char *commonName, X509 *issuer, EVP_PKEY *issuerKey) {
+  X509 *cert = X509_new();
+  X509_NAME *name;
+  bool ok;
+  X509_set_version(cert, 2);
+  ASN1_INTEGER_set(X509_get_serialNumber(cert), issuer == NULL ? 1 : 2);
+  X509_gmtime_adj(X509_getm_notBefore(cert), -3600);
+  X509_gmtime_adj(X509_getm_notAfter(cert), 86400L * 30);
+  X509_set_pubkey(cert, key);
+  name = X509_get_subject_name(cert);
+  X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char *)commonName, -1, -1, 0);
+  X509_set_issuer_name(cert, issuer != NULL ? X509_get_subject_name(issuer) : name);
+  if (issuer == NULL) {
+    ok = addExtension(cert, cert, NID_basic_constraints, "critical,CA:TRUE") &&
+         addExtension(cert, cert, NID_key_usage, "critical,keyCertSign,cRLSign");
+  } else {
+    ok = addExtension(cert, issuer, NID_basic_constraints, "CA:FALSE") &&
+         addExtension(cert, issuer, NID_subject_alt_name, "DNS:localhost,IP:127.0.0.1,IP:::1") &&
+         addExtension(cert, issuer, NID_ext_key_usage, "serverAuth");
+  }
+  if (!ok || X509_sign(cert, issuerKey != NULL ? issuerKey : key, EVP_sha256()) == 0) {
+    X509_free(cert);
+    return NULL;
+  }
+  return cert;
+}
+
+bool TestCertificates::generate() {
+  EVP_PKEY *caKey = EVP_EC_gen("P-256");
+  EVP_PKEY *serverKey = EVP_EC_gen("P-256");
+  X509 *ca = NULL;
+  X509 *server = NULL;
+  bool ok = false;
+  if (caKey != NULL && serverKey != NULL) {
+    ca = createCertificate(caKey, "HawkbitDdi Test CA", NULL, NULL);
+    if (ca != NULL) {
+      server = createCertificate(serverKey, "localhost", ca, caKey);
+    }
+  }
+  if (server != NULL) {
+    this->caCert = toPem(ca, NULL);
+    this->serverCert = toPem(server, NULL);
+    this->serverKey = toPem(NULL, serverKey);
+    ok = true;
+  }
+  X509_free(server);
+  X509_free(ca);
+  EVP_PKEY_free(serverKey);
+  EVP_PKEY_free(caKey);
+  return ok;
+}
+
+static std::string digestHex(const EVP_MD *md, const std::vector<uint8_t> &data) {
+  unsigned char digest[EVP_MAX_MD_SIZE];
+  unsigned int length = 0;
+  char hex[3];
+  std::string result;
+  EVP_Digest(data.data(), data.size(), digest, &length, md, NULL);
+  for (unsigned int i = 0; i < length; i++) {
+    snprintf(hex, sizeof(hex), "%02x", digest[i]);
+    result += hex;
+  }
+  return result;
+}
+
+/* Value of "key":"value" or "key":number in a flat search over the body */
+static std::string jsonValue(const std::string &body, const std::string &key) {
+  size_t pos = body.find("\"" + key + "\"");
+  size_t end;
+  if (pos == std::string::npos) {
+    return "";
+  }
+  pos = body.find(':', pos + key.size() + 2);
+  if (pos == std::string::npos) {
+    return "";
+  }
+  pos = body.find_first_not_of(" \t", pos + 1);
+  if (pos == std::string::npos) {
+    return "";
+  }
+  if (body[pos] == '"') {
+    end = body.find('"', pos + 1);
+    return end == std::string::npos ? "" : body.substr(pos + 1, end - pos - 1);
+  }
+  end = body.find_first_of(",}] ", pos);
+  return body.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+}
+
+static void sleepMs(unsigned long ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+DdiServer::DdiServer(const std::string &tenant) : _tenant(tenant), _stopping(false), _random(1) {
+  memset(&this->_stats, 0, sizeof(this->_stats));
+}
+
+DdiServer::~DdiServer(void) {
+  this->stop();
+  SSL_CTX_free(this->_ctx);
+}
+
+bool DdiServer::start(bool tls, bool ipv6) {
+  struct sockaddr_storage address;
+  socklen_t addressLen;
+  int reuse = 1;
+  BIO *bio;
+  X509 *cert;
+  EVP_PKEY *key;
+  this->_tls = tls;
+  if (tls) {
+    if (!this->_certificates.generate()) {
+      return false;
+    }
+    this->_ctx = SSL_CTX_new(TLS_server_method());
+    bio = BIO_new_mem_buf(this->_certificates.serverCert.c_str(), -1);
+    cert = PEM_read_bio_X509(bio, NULL, NULL, NULL);
+    BIO_free(bio);
+    bio = BIO_new_mem_buf(this->_certificates.serverKey.c_str(), -1);
+    key = PEM_read_bio_PrivateKey(bio, NULL, NULL, NULL);
+    BIO_free(bio);
+    if (this->_ctx == NULL || SSL_CTX_use_certificate(this->_ctx, cert) != 1 || SSL_CTX_use_PrivateKey(this->_ctx, key) != 1) {
+      X509_free(cert);
+      EVP_PKEY_free(key);
+      return false;
+    }
+    X509_free(cert);
+    EVP_PKEY_free(key);
+    SSL_CTX_set_session_id_context(this->_ctx, (const unsigned char *)"ddi", 3);
+    /* SSL_write() to a client that went away must not raise SIGPIPE */
+    signal(SIGPIPE, SIG_IGN);
+    if (this->_maxTlsVersion != 0) {
+      SSL_CTX_set_max_proto_version(this->_ctx, this->_maxTlsVersion);
+    }
+  }
+  memset(&address, 0, sizeof(address));
+  if (ipv6) {
+    struct sockaddr_in6 *address6 = (struct sockaddr_in6 *)&address;
+    address6->sin6_family = AF_INET6;
+    address6->sin6_addr = in6addr_loopback;
+    addressLen = sizeof(*address6);
+    this->_host = "::1";
+  } else {
+    struct sockaddr_in *address4 = (struct sockaddr_in *)&address;
+    address4->sin_family = AF_INET;
+    address4->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addressLen = sizeof(*address4);
+    this->_host = "127.0.0.1";
+  }
+  this->_listen = socket(address.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (this->_listen < 0) {
+    return false;
+  }
+  setsockopt(this->_listen, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  if (bind(this->_listen, (struct sockaddr *)&address, addressLen) != 0 || listen(this->_listen, 8) != 0 ||
+      getsockname(this->_listen, (struct sockaddr *)&address, &addressLen) != 0) {
+    close(this->_listen);
+    this->_listen = -1;
+    return false;
+  }
+  this->_port = ntohs(ipv6 ? ((struct sockaddr_in6 *)&address)->sin6_port : ((struct sockaddr_in *)&address)->sin_port);
+  this->_stopping = false;
+  this->_thread = std::thread(&DdiServer::run, this);
+  return true;
+}
+
+void DdiServer::stop() {
+  this->_stopping = true;
+  if (this->_thread.joinable()) {
+    this->_thread.join();
+  }
+  if (this->_listen >= 0) {
+    close(this->_listen);
+    this->_listen = -1;
+  }
+}
+
+void DdiServer::run() {
+  struct pollfd fd;
+  Connection connection;
+  struct timeval timeout = { 0, 200000 };
+  int noDelay = 1;
+  while (!this->_stopping) {
+    fd.fd = this->_listen;
+    fd.events = POLLIN;
+    if (poll(&fd, 1, 50) <= 0) {
+      continue;
+    }
+    connection.socket = accept4(this->_listen, NULL, NULL, SOCK_CLOEXEC);
+    if (connection.socket < 0) {
+      continue;
+    }
+    connection.ssl = NULL;
+    connection.pending.clear();
+    connection.requests = 0;
+    setsockopt(connection.socket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    setsockopt(connection.socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    {
+      std::lock_guard<std::mutex> lock(this->_mutex);
+      this->_stats.connections++;
+    }
+    if (this->_tls) {
+      connection.ssl = SSL_new(this->_ctx);
+      SSL_set_fd(connection.ssl, connection.socket);
+      if (SSL_accept(connection.ssl) == 1) {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_stats.tlsHandshakes++;
+        if (SSL_session_reused(connection.ssl)) {
+          this->_stats.tlsResumed++;
+        }
+      } else {
+        SSL_free(connection.ssl);
+        close(connection.socket);
+        continue;
+      }
+    }
+    this->serve(connection);
+    if (connection.ssl != NULL) {
+      SSL_shutdown(connection.ssl);
+      SSL_free(connection.ssl);
+    }
+    close(connection.socket);
+  }
+}
+
+void DdiServer::serve(Connection &connection) {
+  Request request;
+  while (!this->_stopping && this->readRequest(connection, request)) {
+    if (connection.requests++ > 0 && this->dropReused()) {
+      break;
+    }
+    if (this->_latency > 0) {
+      sleepMs(this->_latency);
+    }
+    if (!this->handle(connection, request) || this->closesAfter(connection, request)) {
+      break;
+    }
+  }
+}
+
+/* Wait for data until the idle timeout, returns 0 if the connection is closed */
+int DdiServer::receive(Connection &connection, char *buffer, size_t length) {
+  struct pollfd fd;
+  int idle = 0;
+  int ret;
+  while (!this->_stopping && idle < DDI_SERVER_IDLE_TIMEOUT) {
+    if (connection.ssl == NULL || SSL_pending(connection.ssl) == 0) {
+      fd.fd = connection.socket;
+      fd.events = POLLIN;
+      if (poll(&fd, 1, 50) <= 0) {
+        idle += 50;
+        continue;
+      }
+    }
+    if (connection.ssl != NULL) {
+      ret = SSL_read(connection.ssl, buffer, length);
+      if (ret <= 0 && SSL_get_error(connection.ssl, ret) == SSL_ERROR_WANT_READ) {
+        continue;
+      }
+    } else {
+      ret = recv(connection.socket, buffer, length, 0);
+      if (ret < 0 && (errno == EAGAIN || errno == EINTR)) {
+        continue;
+      }
+    }
+    return ret > 0 ? ret : 0;
+  }
+  return 0;
+}
+
+bool DdiServer::send(Connection &connection, const char *data, size_t length) {
+  size_t sent = 0;
+  int ret;
+  while (sent < length) {
+    if (connection.ssl != NULL) {
+      ret = SSL_write(connection.ssl, data + sent, length - sent);
+    } else {
+      ret = ::send(connection.socket, data + sent, length - sent, MSG_NOSIGNAL);
+    }
+    if (ret <= 0) {
+      return false;
+    }
+    sent += ret;
+  }
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  this->_stats.bytesOut += length;
+  return true;
+}
+
+bool DdiServer::readRequest(Connection &connection, Request &request) {
+  char buffer[4096];
+  size_t headEnd;
+  size_t lineEnd;
+  size_t pos;
+  size_t contentLength = 0;
+  std::string line;
+  std::string name;
+  std::string value;
+  int received;
+  while ((headEnd = connection.pending.find("\r\n\r\n")) == std::string::npos) {
+    received = this->receive(connection, buffer, sizeof(buffer));
+    if (received <= 0) {
+      return false;
+    }
+    connection.pending.append(buffer, received);
+  }
+  request = Request();
+  request.close = false;
+  pos = 0;
+  while (pos < headEnd) {
+    lineEnd = connection.pending.find("\r\n", pos);
+    line = connection.pending.substr(pos, lineEnd - pos);
+    pos = lineEnd + 2;
+    if (request.method.empty()) {
+      size_t space = line.find(' ');
+      request.method = line.substr(0, space);
+      request.path = line.substr(space + 1, line.find(' ', space + 1) - space - 1);
+      continue;
+    }
+    name = line.substr(0, line.find(':'));
+    value = line.substr(line.find(':') + 1);
+    value.erase(0, value.find_first_not_of(" \t"));
+    if (strcasecmp(name.c_str(), "Host") == 0) {
+      request.host = value;
+    } else if (strcasecmp(name.c_str(), "If-None-Match") == 0) {
+      request.ifNoneMatch = value;
+    } else if (strcasecmp(name.c_str(), "Range") == 0) {
+      request.range = value;
+    } else if (strcasecmp(name.c_str(), "Connection") == 0) {
+      request.close = strcasecmp(value.c_str(), "close") == 0;
+    } else if (strcasecmp(name.c_str(), "Content-Length") == 0) {
+      contentLength = strtoul(value.c_str(), NULL, 10);
+    }
+  }
+  connection.pending.erase(0, headEnd + 4);
+  while (connection.pending.size() < contentLength) {
+    received = this->receive(connection, buffer, sizeof(buffer));
+    if (received <= 0) {
+      return false;
+    }
+    connection.pending.append(buffer, received);
+  }
+  request.body = connection.pending.substr(0, contentLength);
+  connection.pending.erase(0, contentLength);
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  this->_stats.requests++;
+  this->_stats.bytesIn += headEnd + 4 + contentLength;
+  this->_hostHeaders.push_back(request.host);
+  return true;
+}
+
+/* Whether the connection is closed after the response to this request */
+bool DdiServer::closesAfter(const Connection &connection, const Request &request) {
+  return request.close || !this->_keepAlive || (this->_keepAliveMax > 0 && connection.requests >= this->_keepAliveMax);
+}
+
+std::string DdiServer::connectionHeader(const Connection &connection, const Request &request) {
+  if (this->closesAfter(connection, request)) {
+    return "Connection: close\r\n";
+  }
+  if (this->_keepAliveMax > 0) {
+    return "Connection: keep-alive\r\nKeep-Alive: timeout=5, max=" + std::to_string(this->_keepAliveMax - connection.requests) + "\r\n";
+  }
+  return "Connection: keep-alive\r\nKeep-Alive: timeout=5\r\n";
+}
+
+/* Count a request on a kept-alive connection that is closed unanswered */
+bool DdiServer::dropReused() {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  if (this->_dropReused == 0) {
+    return false;
+  }
+  this->_dropReused--;
+  this->_stats.requestsDropped++;
+  return true;
+}
+
+bool DdiServer::respond(Connection &connection, const Request &request, int status, const std::string &body,
+                        const std::string &headers, const char *contentType) {
+  char head[512];
+  bool close = this->closesAfter(connection, request);
+  size_t split;
+  snprintf(head, sizeof(head), "HTTP/1.1 %d %s\r\n%s%s%s%s%s",
+           status, status < 300 ? "OK" : status == 304 ? "Not Modified" : "Error",
+           headers.c_str(),
+           status == 304 ? "" : "Content-Type: ",
+           status == 304 ? "" : contentType,
+           status == 304 ? "" : "\r\n",
+           this->connectionHeader(connection, request).c_str());
+  std::string response = head;
+  if (status != 304) {
+    response += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+  }
+  response += "\r\n";
+  if (this->_bodyPause > 0 && body.size() > 1) {
+    split = response.size() + body.size() / 2;
+    response += body;
+    if (!this->send(connection, response.data(), split)) {
+      return false;
+    }
+    sleepMs(this->_bodyPause);
+    return this->send(connection, response.data() + split, response.size() - split) && !close;
+  }
+  response += body;
+  return this->send(connection, response.data(), response.size()) && !close;
+}
+
+/* Links point to the host the client asked for, like hawkBit does */
+std::string DdiServer::baseUrl(const Request &request) {
+  std::string host = this->_host.find(':') != std::string::npos ? "[" + this->_host + "]" : this->_host;
+  if (request.host.empty()) {
+    host += ":" + std::to_string(this->_port);
+  } else {
+    host = request.host;
+  }
+  std::string scheme = !this->_linkScheme.empty() ? this->_linkScheme : this->_tls ? "https" : "http";
+  return scheme + "://" + host + "/" + this->_tenant + "/controller/v1/";
+}
+
+std::string DdiServer::controllerResource(const Request &request, const std::string &controllerId) {
+  std::string base = this->baseUrl(request) + controllerId;
+  std::string links;
+  std::map<std::string, Action>::iterator action = this->_actions.find(controllerId);
+  if (action != this->_actions.end() && !action->second.closed) {
+    if (action->second.cancelId > 0) {
+      links += "\"cancelAction\":{\"href\":\"" + base + "/cancelAction/" + std::to_string(action->second.cancelId) + "\"}";
+    } else {
+      links += "\"deploymentBase\":{\"href\":\"" + base + "/deploymentBase/" + std::to_string(action->second.id) +
+               "?c=" + std::to_string(std::hash<std::string>()(action->second.update + action->second.download) % 100000) + "\"}";
+    }
+  }
+  if (this->_configDataRequested) {
+    links += std::string(links.empty() ? "" : ",") + "\"configData\":{\"href\":\"" + base + "/configData\"}";
+  }
+  return "{\"config\":{\"polling\":{\"sleep\":\"" + this->_pollingSleep + "\"}},\"_links\":{" + links + "}}";
+}
+
+std::string DdiServer::deploymentBase(const Request &request, const std::string &controllerId, const Action &action) {
+  std::string base = this->baseUrl(request) + controllerId;
+  std::string artifactUrl = base + "/softwaremodules/" + std::to_string(action.id) + "/artifacts/firmware.bin";
+  std::string body = "{\"id\":\"" + std::to_string(action.id) + "\",\"deployment\":{\"download\":\"" + action.download +
+                     "\",\"update\":\"" + action.update + "\",\"chunks\":[{\"part\":\"os\",\"version\":\"1." +
+                     std::to_string(action.id) + "\",\"name\":\"firmware\",\"artifacts\":[{\"filename\":\"firmware.bin\","
+                     "\"hashes\":{\"sha1\":\"" + action.sha1 + "\",\"md5\":\"" + action.md5 + "\",\"sha256\":\"" + action.sha256 +
+                     "\"},\"size\":" + std::to_string(action.artifact.size()) + ",\"_links\":{\"download\":{\"href\":\"" +
+                     artifactUrl + "\"},\"md5sum\":{\"href\":\"" + artifactUrl + ".MD5SUM\"}}}]}";
+  for (unsigned int i = 0; i < this->_padding; i++) {
+    std::string name = "module-" + std::to_string(i);
+    std::string url = base + "/softwaremodules/" + std::to_string(1000 + i) + "/artifacts/" + name + ".bin";
+    body += ",{\"part\":\"app\",\"version\":\"2.0." + std::to_string(i) + "\",\"name\":\"" + name + "\",\"metadata\":"
+            "[{\"key\":\"description\",\"value\":\"Additional software module for the benchmark of the parser\"}],"
+            "\"artifacts\":[{\"filename\":\"" + name + ".bin\",\"hashes\":{\"sha1\":\"" + action.sha1 + "\",\"md5\":\"" +
+            action.md5 + "\",\"sha256\":\"" + action.sha256 + "\"},\"size\":65536,\"_links\":{\"download\":{\"href\":\"" +
+            url + "\"},\"md5sum\":{\"href\":\"" + url + ".MD5SUM\"}}}]}";
+  }
+  return body + "]},\"actionHistory\":{\"status\":\"RUNNING\",\"messages\":[\"Assignment initiated by user 'test'\"]}}";
+}
+
+/* Answer one request, returns false if the connection has to be closed */
+bool DdiServer::handle(Connection &connection, const Request &request) {
+  std::string prefix = "/" + this->_tenant + "/controller/v1/";
+  std::string path = request.path.substr(0, request.path.find('?'));
+  std::string controllerId;
+  std::string resource;
+  std::string body;
+  std::string headers;
+  int status = 200;
+  size_t slash;
+  if (path.compare(0, prefix.size(), prefix) != 0) {
+    return this->respond(connection, request, 404, "");
+  }
+  path.erase(0, prefix.size());
+  slash = path.find('/');
+  controllerId = path.substr(0, slash);
+  resource = slash == std::string::npos ? "" : path.substr(slash);
+  std::unique_lock<std::mutex> lock(this->_mutex);
+  std::map<std::string, Action>::iterator action = this->_actions.find(controllerId);
+  if (resource.empty() && request.method == "GET") {
+    this->_stats.polls++;
+    body = this->controllerResource(request, controllerId);
+    if (this->_etag) {
+      std::string etag = "\"" + std::to_string(std::hash<std::string>()(body)) + "\"";
+      headers = "ETag: " + etag + "\r\n";
+      if (request.ifNoneMatch == etag) {
+        this->_stats.notModified++;
+        lock.unlock();
+        return this->respond(connection, request, 304, "", headers);
+      }
+    }
+  } else if (resource == "/configData" && request.method == "PUT") {
+    this->_stats.configData++;
+    this->_configData.push_back(request.body);
+    this->_configDataControllers.push_back(controllerId);
+  } else if (resource.compare(0, 16, "/deploymentBase/") == 0 && action != this->_actions.end() &&
+             atoi(resource.c_str() + 16) == action->second.id) {
+    if (resource.find("/feedback") == std::string::npos && request.method == "GET") {
+      this->_stats.deploymentBase++;
+      body = this->deploymentBase(request, controllerId, action->second);
+    } else if (request.method == "POST") {
+      Feedback feedback;
+      this->_stats.feedback++;
+      if (this->_feedbackLoss > 0 && std::uniform_real_distribution<double>(0, 1)(this->_random) < this->_feedbackLoss) {
+        this->_stats.feedbackLost++;
+        if (this->_feedbackLossStatus == 0) {
+          return false;
+        }
+        lock.unlock();
+        return this->respond(connection, request, this->_feedbackLossStatus, "");
+      }
+      feedback.controllerId = controllerId;
+      feedback.actionId = atoi(jsonValue(request.body, "id").c_str());
+      feedback.execution = jsonValue(request.body, "execution");
+      feedback.finished = jsonValue(request.body, "finished");
+      feedback.progress = jsonValue(request.body, "cnt").empty() ? -1 : atoi(jsonValue(request.body, "cnt").c_str());
+      this->_feedback.push_back(feedback);
+      action->second.last = feedback;
+      if (feedback.execution == "closed") {
+        action->second.closed = true;
+        action->second.cancelId = 0;
+      }
+    } else {
+      status = 405;
+    }
+  } else if (resource.compare(0, 14, "/cancelAction/") == 0 && action != this->_actions.end() &&
+             atoi(resource.c_str() + 14) == action->second.cancelId) {
+    if (request.method == "GET") {
+      this->_stats.cancelAction++;
+      body = "{\"id\":\"" + std::to_string(action->second.cancelId) + "\",\"cancelAction\":{";
+      if (this->_cancelStopId) {
+        body += "\"stopId\":\"" + std::to_string(action->second.id) + "\"";
+      }
+      body += "}}";
+    } else {
+      this->_stats.feedback++;
+      if (jsonValue(request.body, "execution") == "closed") {
+        action->second.closed = true;
+        action->second.cancelId = 0;
+      }
+    }
+  } else if (resource.compare(0, 17, "/softwaremodules/") == 0 && action != this->_actions.end() &&
+             atoi(resource.c_str() + 17) == action->second.id && request.method == "GET") {
+    this->_stats.downloads++;
+    lock.unlock();
+    return this->sendArtifact(connection, request, action->second);
+  } else {
+    status = 404;
+  }
+  lock.unlock();
+  return this->respond(connection, request, status, body, headers);
+}
+
+bool DdiServer::sendArtifact(Connection &connection, const Request &request, Action &action) {
+  std::vector<uint8_t> artifact;
+  size_t first = 0;
+  size_t last;
+  size_t length;
+  size_t sent = 0;
+  size_t part;
+  long cut = -1;
+  size_t total;
+  bool partial = false;
+  char head[256];
+  std::chrono::steady_clock::time_point start;
+  {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    artifact = action.artifact;
+    total = this->_rangeTotal > 0 ? this->_rangeTotal : artifact.size();
+    if (this->_downloadCuts > 0 && std::uniform_real_distribution<double>(0, 1)(this->_random) < this->_downloadCuts) {
+      cut = 0;
+    }
+  }
+  last = artifact.size() - 1;
+  if (this->_ranges && request.range.compare(0, 6, "bytes=") == 0) {
+    first = strtoul(request.range.c_str() + 6, NULL, 10);
+    if (request.range.find('-') + 1 < request.range.size()) {
+      last = strtoul(request.range.c_str() + request.range.find('-') + 1, NULL, 10);
+    }
+    if (last >= artifact.size()) {
+      last = artifact.size() - 1;
+    }
+    if (first > last) {
+      return this->respond(connection, request, 416, "");
+    }
+    partial = true;
+  }
+  length = last - first + 1;
+  if (cut == 0) {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    cut = std::uniform_int_distribution<long>(0, length - 1)(this->_random);
+    this->_stats.downloadCuts++;
+  }
+  if (partial) {
+    snprintf(head, sizeof(head), "HTTP/1.1 206 Partial Content\r\nContent-Range: bytes %zu-%zu/%zu\r\n", first, last, total);
+  } else {
+    snprintf(head, sizeof(head), "HTTP/1.1 200 OK\r\nAccept-Ranges: bytes\r\n");
+  }
+  std::string response = head;
+  response += "Content-Type: application/octet-stream\r\nContent-Length: " + std::to_string(length) + "\r\n";
+  response += this->connectionHeader(connection, request) + "\r\n";
+  if (!this->send(connection, response.data(), response.size())) {
+    return false;
+  }
+  start = std::chrono::steady_clock::now();
+  while (sent < length) {
+    part = std::min<size_t>(4096, length - sent);
+    if (cut >= 0 && sent + part > (size_t)cut) {
+      part = cut - sent;
+    }
+    if (part > 0 && !this->send(connection, (const char *)artifact.data() + first + sent, part)) {
+      return false;
+    }
+    sent += part;
+    {
+      std::lock_guard<std::mutex> lock(this->_mutex);
+      this->_stats.downloadBytes += part;
+    }
+    if (cut >= 0 && sent == (size_t)cut) {
+      return false;
+    }
+    if (this->_rateLimit > 0) {
+      std::chrono::steady_clock::time_point due = start + std::chrono::microseconds((unsigned long long)sent * 1000000ULL / this->_rateLimit);
+      std::this_thread::sleep_until(due);
+    }
+  }
+  return !this->closesAfter(connection, request);
+}
+
+void DdiServer::setPollingSleep(const std::string &sleep) {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  this->_pollingSleep = sleep;
+}
+
+void DdiServer::setETag(bool etag) {
+  this->_etag = etag;
+}
+
+void DdiServer::setKeepAlive(bool keepAlive) {
+  this->_keepAlive = keepAlive;
+}
+
+void DdiServer::setKeepAliveMax(unsigned int max) {
+  this->_keepAliveMax = max;
+}
+
+void DdiServer::setDropReused(unsigned long count) {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  this->_dropReused = count;
+}
+
+void DdiServer::setConfigDataRequested(bool requested) {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  this->_configDataRequested = requested;
+}
+
+void DdiServer::setLatency(unsigned long latency) {
+  this->_latency = latency;
+}
+
+void DdiServer::setFeedbackLoss(double fraction, int status) {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  this->_feedbackLoss = fraction;
+  this->_feedbackLossStatus = status;
+}
+
+void DdiServer::setDownloadCuts(double fraction) {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  this->_downloadCuts = fraction;
+}
+
+void DdiServer::setRateLimit(unsigned long bytesPerSecond) {
+  this->_rateLimit = bytesPerSecond;
+}
+
+void DdiServer::setRangeSupport(bool ranges) {
+  this->_ranges = ranges;
+}
+
+void DdiServer::setBodyPause(unsigned long pause) {
+  this->_bodyPause = pause;
+}
+
+void DdiServer::setDeploymentPadding(unsigned int chunks) {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  this->_padding = chunks;
+}
+
+void DdiServer::setSeed(unsigned int seed) {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  this->_random.seed(seed);
+}
+
+void DdiServer::setCancelStopId(bool stopId) {
+  this->_cancelStopId = stopId;
+}
+
+void DdiServer::setRangeTotal(size_t total) {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  this->_rangeTotal = total;
+}
+
+void DdiServer::setLinkScheme(const std::string &scheme) {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  this->_linkScheme = scheme;
+}
+
+int DdiServer::deploy(const std::string &controllerId, size_t size, const std::string &update, const std::string &download) {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  Action action;
+  action.id = this->_nextId++;
+  action.artifact.resize(size);
+  for (size_t i = 0; i < size; i++) {
+    action.artifact[i] = (uint8_t)(this->_random() >> 24);
+  }
+  action.update = update;
+  action.download = download;
+  action.md5 = digestHex(EVP_md5(), action.artifact);
+  action.sha1 = digestHex(EVP_sha1(), action.artifact);
+  action.sha256 = digestHex(EVP_sha256(), action.artifact);
+  action.closed = false;
+  action.cancelId = 0;
+  action.last.actionId = 0;
+  action.last.progress = -1;
+  this->_actions[controllerId] = action;
+  return action.id;
+}
+
+void DdiServer::setUpdateMode(const std::string &controllerId, const std::string &update) {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  this->_actions[controllerId].update = update;
+}
+
+void DdiServer::cancel(const std::string &controllerId) {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  std::map<std::string, Action>::iterator action = this->_actions.find(controllerId);
+  if (action != this->_actions.end() && !action->second.closed) {
+    action->second.cancelId = this->_nextId++;
+  }
+}
+
+DdiServer::Stats DdiServer::getStats() {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  return this->_stats;
+}
+
+void DdiServer::resetStats() {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  memset(&this->_stats, 0, sizeof(this->_stats));
+  this->_feedback.clear();
+  this->_configData.clear();
+  this->_configDataControllers.clear();
+  this->_hostHeaders.clear();
+}
+
+std::vector<DdiServer::Feedback> DdiServer::getFeedback() {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  return this->_feedback;
+}
+
+std::vector<std::string> DdiServer::getConfigData() {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  return this->_configData;
+}
+
+std::vector<std::string> DdiServer::getConfigDataControllers() {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  return this->_configDataControllers;
+}
+
+std::vector<std::string> DdiServer::getHostHeaders() {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  return this->_hostHeaders;
+}
+
+std::vector<uint8_t> DdiServer::getArtifact(const std::string &controllerId) {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  return this->_actions[controllerId].artifact;
+}
+
+bool DdiServer::isClosed(const std::string &controllerId) {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  std::map<std::string, Action>::iterator action = this->_actions.find(controllerId);
+  return action == this->_actions.end() || action->second.closed;
+}
+
+DdiServer::Feedback DdiServer::getLastFeedback(const std::string &controllerId) {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  return this->_actions[controllerId].last;
+}
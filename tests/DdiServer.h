@@ -0,0 +1,250 @@
+/**
+
+   @file DdiServer.h
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#ifndef ___HAWKBIT_TEST_DDI_SERVER_H___
+#define ___HAWKBIT_TEST_DDI_SERVER_H___
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <openssl/ssl.h>
+
+/* Self-signed CA and a server certificate for localhost issued by it */
+struct TestCertificates {
+  std::string caCert;
+  std::string serverCert;
+  std::string serverKey;
+
+  bool generate();
+};
+
+/* Scripted stand-in for the DDI API of a hawkBit server on the loopback
+   interface. It serves one connection at a time in its own thread, which
+   is all a HawkbitDdi uses, over plain HTTP/1.1 or TLS. Deployments are
+   scripted per controller, the requests and traffic are recorded */
+class DdiServer
+{
+  public:
+    struct Stats {
+      unsigned long connections;
+      unsigned long requests;
+      unsigned long polls;
+      unsigned long notModified;
+      unsigned long configData;
+      unsigned long deploymentBase;
+      unsigned long cancelAction;
+      unsigned long feedback;
+      /* Feedback that was answered with an error or not at all */
+      unsigned long feedbackLost;
+      unsigned long downloads;
+      unsigned long downloadCuts;
+      unsigned long downloadBytes;
+      unsigned long bytesIn;
+      unsigned long bytesOut;
+      unsigned long tlsHandshakes;
+      unsigned long tlsResumed;
+      /* Requests on a kept-alive connection closed without a response */
+      unsigned long requestsDropped;
+    };
+
+    struct Feedback {
+      std::string controllerId;
+      int actionId;
+      std::string execution;
+      std::string finished;
+      /* Progress in percent, -1 if the feedback has none */
+      int progress;
+    };
+
+    DdiServer(const std::string &tenant = "DEFAULT");
+    ~DdiServer(void);
+
+    /* Highest TLS version to negotiate, e.g. TLS1_2_VERSION, before start() */
+    void setMaxTlsVersion(int version) {
+      this->_maxTlsVersion = version;
+    }
+
+    /* Listen on an ephemeral port of 127.0.0.1 or ::1 */
+    bool start(bool tls = false, bool ipv6 = false);
+    void stop();
+
+    uint16_t getPort() {
+      return this->_port;
+    }
+
+    /* Host as used in the links, "localhost" also works with TLS */
+    const std::string &getHost() {
+      return this->_host;
+    }
+
+    const std::string &getCACert() {
+      return this->_certificates.caCert;
+    }
+
+    /* Scripting, may be called while the server runs */
+    void setPollingSleep(const std::string &sleep);
+    void setETag(bool etag);
+    void setKeepAlive(bool keepAlive);
+    /* Requests per connection, announced with Keep-Alive: max, 0 for no limit */
+    void setKeepAliveMax(unsigned int max);
+    /* Close this many kept-alive connections when their next request arrives
+       instead of answering, like an idle timeout that ran out meanwhile */
+    void setDropReused(unsigned long count);
+    void setConfigDataRequested(bool requested);
+    /* Delay before each response in ms */
+    void setLatency(unsigned long latency);
+    /* Answer this fraction of the feedback with status, 0 closes the
+       connection without a response */
+    void setFeedbackLoss(double fraction, int status = 0);
+    /* Close this fraction of the artifact responses at a random offset */
+    void setDownloadCuts(double fraction);
+    /* Artifact bytes per second, 0 for unlimited */
+    void setRateLimit(unsigned long bytesPerSecond);
+    void setRangeSupport(bool ranges);
+    /* Send the first part of JSON bodies, wait pause ms, then the rest */
+    void setBodyPause(unsigned long pause);
+    /* Chunks of padding in deployment documents, e.g. for parser benchmarks */
+    void setDeploymentPadding(unsigned int chunks);
+    void setSeed(unsigned int seed);
+    /* Leave the stopId out of the cancel action, like a broken proxy */
+    void setCancelStopId(bool stopId);
+    /* Announce this artifact size in Content-Range, 0 for the real one */
+    void setRangeTotal(size_t total);
+    /* Scheme of the links, e.g. "http" behind a proxy that terminates TLS,
+       empty for the one the server uses */
+    void setLinkScheme(const std::string &scheme);
+
+    /* Start a deployment of an artifact with size random bytes, returns its
+       action id. update and download are "skip", "attempt" or "forced" */
+    int deploy(const std::string &controllerId, size_t size, const std::string &update = "forced",
+               const std::string &download = "forced");
+    void setUpdateMode(const std::string &controllerId, const std::string &update);
+    /* Ask the controller to cancel its current action */
+    void cancel(const std::string &controllerId);
+
+    Stats getStats();
+    void resetStats();
+    std::vector<Feedback> getFeedback();
+    std::vector<std::string> getConfigData();
+    /* Controller of each config data body */
+    std::vector<std::string> getConfigDataControllers();
+    std::vector<std::string> getHostHeaders();
+    std::vector<uint8_t> getArtifact(const std::string &controllerId);
+    /* Whether the current action of the controller is closed */
+    bool isClosed(const std::string &controllerId);
+    /* Last feedback of the current action, empty if none */
+    Feedback getLastFeedback(const std::string &controllerId);
+
+  private:
+    struct Action {
+      int id;
+      std::vector<uint8_t> artifact;
+      std::string update;
+      std::string download;
+      std::string md5;
+      std::string sha1;
+      std::string sha256;
+      bool closed;
+      int cancelId;
+      Feedback last;
+    };
+
+    struct Request {
+      std::string method;
+      std::string path;
+      std::string host;
+      std::string ifNoneMatch;
+      std::string range;
+      bool close;
+      std::string body;
+    };
+
+    struct Connection {
+      int socket;
+      SSL *ssl;
+      std::string pending;
+      unsigned int requests;
+    };
+
+    std::string _tenant;
+    std::string _host;
+    uint16_t _port = 0;
+    bool _tls = false;
+    int _maxTlsVersion = 0;
+    int _listen = -1;
+    SSL_CTX *_ctx = NULL;
+    TestCertificates _certificates;
+    std::thread _thread;
+    std::atomic<bool> _stopping;
+    std::mutex _mutex;
+    std::mt19937 _random;
+
+    std::string _pollingSleep = "00:05:00";
+    bool _etag = true;
+    bool _keepAlive = true;
+    unsigned int _keepAliveMax = 0;
+    unsigned long _dropReused = 0;
+    bool _configDataRequested = false;
+    unsigned long _latency = 0;
+    double _feedbackLoss = 0;
+    int _feedbackLossStatus = 0;
+    double _downloadCuts = 0;
+    unsigned long _rateLimit = 0;
+    bool _ranges = true;
+    unsigned long _bodyPause = 0;
+    unsigned int _padding = 0;
+    bool _cancelStopId = true;
+    size_t _rangeTotal = 0;
+    std::string _linkScheme;
+    int _nextId = 1;
+    std::map<std::string, Action> _actions;
+    Stats _stats;
+    std::vector<Feedback> _feedback;
+    std::vector<std::string> _configData;
+    std::vector<std::string> _configDataControllers;
+    std::vector<std::string> _hostHeaders;
+
+    void run();
+    void serve(Connection &connection);
+    bool readRequest(Connection &connection, Request &request);
+    int receive(Connection &connection, char *buffer, size_t length);
+    bool send(Connection &connection, const char *data, size_t length);
+    bool closesAfter(const Connection &connection, const Request &request);
+    std::string connectionHeader(const Connection &connection, const Request &request);
+    bool dropReused();
+    bool respond(Connection &connection, const Request &request, int status, const std::string &body,
+                 const std::string &headers = "", const char *contentType = "application/hal+json");
+    bool handle(Connection &connection, const Request &request);
+    bool sendArtifact(Connection &connection, const Request &request, Action &action);
+    std::string baseUrl(const Request &request);
+    std::string controllerResource(const Request &request, const std::string &controllerId);
+    std::string deploymentBase(const Request &request, const std::string &controllerId, const Action &action);
+};
+
+#endif /* ___HAWKBIT_TEST_DDI_SERVER_H___ */
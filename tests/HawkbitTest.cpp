@@ -0,0 +1,260 @@
+/**
+
+   @file HawkbitTest.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "HawkbitTest.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <ftw.h>
+#include <malloc.h>
+#include <pthread.h>
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void __libc_free(void *ptr);
+}
+
+static int failures = 0;
+
+bool hawkbitCheck(bool ok, const char *expression, const char *file, int line) {
+  if (!ok) {
+    fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+    failures++;
+  }
+  return ok;
+}
+
+bool hawkbitCheckEqual(long long expected, long long actual, const char *expression, const char *file, int line) {
+  if (expected != actual) {
+    fprintf(stderr, "%s:%d: check failed: %s is %lld, expected %lld\n", file, line, expression, actual, expected);
+    failures++;
+  }
+  return expected == actual;
+}
+
+int testResult() {
+  if (failures > 0) {
+    fprintf(stderr, "%d check(s) failed\n", failures);
+    return 1;
+  }
+  return 0;
+}
+
+double wallMs() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
+}
+
+double cpuMs() {
+  struct timespec now;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+  return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
+}
+
+void printResult(const char *benchmark, const std::string &values) {
+  printf("{\"benchmark\":\"%s\",%s}\n", benchmark, values.c_str());
+  fflush(stdout);
+}
+
+static bool heapTracking = false;
+static pthread_t heapThread;
+static HeapStats heapStats;
+
+void heapTrackingStart() {
+  heapStats = HeapStats();
+  heapThread = pthread_self();
+  heapTracking = true;
+}
+
+HeapStats heapTrackingStop() {
+  heapTracking = false;
+  return heapStats;
+}
+
+static bool heapTracked() {
+  return heapTracking && pthread_equal(pthread_self(), heapThread);
+}
+
+static void heapAllocated(void *ptr) {
+  if (ptr != NULL && heapTracked()) {
+    heapStats.allocations++;
+    heapStats.current += malloc_usable_size(ptr);
+    if (heapStats.current > heapStats.peak) {
+      heapStats.peak = heapStats.current;
+    }
+  }
+}
+
+static void heapFreed(void *ptr) {
+  if (ptr != NULL && heapTracked()) {
+    heapStats.current -= malloc_usable_size(ptr);
+  }
+}
+
+/* Replace the allocator of glibc, operator new uses it as well */
+extern "C" void *malloc(size_t size) {
+  void *ptr = __libc_malloc(size);
+  heapAllocated(ptr);
+  return ptr;
+}
+
+extern "C" void *calloc(size_t count, size_t size) {
+  void *ptr = __libc_calloc(count, size);
+  heapAllocated(ptr);
+  return ptr;
+}
+
+extern "C" void *realloc(void *ptr, size_t size) {
+  void *result;
+  heapFreed(ptr);
+  result = __libc_realloc(ptr, size);
+  heapAllocated(result != NULL ? result : (size > 0 ? ptr : NULL));
+  return result;
+}
+
+extern "C" void free(void *ptr) {
+  heapFreed(ptr);
+  __libc_free(ptr);
+}
+
+Print &SimPlatform::log() {
+  if (getenv("HB_TEST_VERBOSE") != NULL) {
+    return Serial;
+  }
+  return this->_null;
+}
+
+TestDirectory::TestDirectory(void) {
+  char path[] = "/tmp/hawkbit-test-XXXXXX";
+  if (mkdtemp(path) != NULL) {
+    this->_path = path;
+  }
+}
+
+static int removeEntry(const char *path, const struct stat *status, int flag, struct FTW *ftw) {
+  return ::remove(path);
+}
+
+TestDirectory::~TestDirectory(void) {
+  if (!this->_path.empty()) {
+    nftw(this->_path.c_str(), removeEntry, 8, FTW_DEPTH | FTW_PHYS);
+  }
+}
+
+TestDevice::TestDevice(DdiServer &server, const char *controllerId)
+    : controllerId(controllerId), flash(directory.file("image.bin").c_str()),
+      storage(directory.file("storage").c_str()), _server(server) {
+  if (!server.getCACert().empty()) {
+    this->transport.setCACert(server.getCACert().c_str());
+  }
+}
+
+TestDevice::~TestDevice(void) {
+  delete this->_ddi;
+}
+
+void TestDevice::boot(void (*configure)(HawkbitDdi &ddi)) {
+  delete this->_ddi;
+  this->transport.stop();
+  this->_configure = configure;
+  this->_ddi = new HawkbitDdi(this->host.empty() ? this->_server.getHost().c_str() : this->host.c_str(), this->_server.getPort(), "DEFAULT",
+                              this->controllerId.c_str(), "token", HB_SEC_TARGETTOKEN);
+  if (configure != NULL) {
+    configure(*this->_ddi);
+  }
+  this->_ddi->begin(&this->transport, &this->flash, &this->platform, &this->storage);
+}
+
+bool TestDevice::runFor(unsigned long simMs, bool (*done)(TestDevice &device)) {
+  unsigned long end = this->platform.millis() + simMs;
+  unsigned long sleepTime;
+  double started = wallMs();
+  double callStart;
+  double callTime;
+  while ((long)(end - this->platform.millis()) > 0) {
+    if (done != NULL && done(*this)) {
+      return true;
+    }
+    /* Safety net against a state machine that does not advance */
+    if (wallMs() - started > 60000) {
+      fprintf(stderr, "runFor() did not finish in time\n");
+      return false;
+    }
+    callStart = wallMs();
+    this->_ddi->work();
+    callTime = wallMs() - callStart;
+    this->workCalls++;
+    if (callTime > this->maxWorkTime) {
+      this->maxWorkTime = callTime;
+    }
+    if (this->_ddi->getWorkState() != HB_STATE_IDLE) {
+      /* Waiting for the server takes real time */
+      usleep(200);
+      continue;
+    }
+    sleepTime = this->_ddi->getSleepTime();
+    if (sleepTime == 0) {
+      /* Pending work that is delayed, e.g. a retry */
+      sleepTime = 20;
+    }
+    if ((long)(end - this->platform.millis()) < (long)sleepTime) {
+      sleepTime = end - this->platform.millis();
+    }
+    /* Do not skip idle time past the moment the caller waits for */
+    if (done != NULL && done(*this)) {
+      return true;
+    }
+    this->platform.advance(sleepTime);
+  }
+  return done == NULL || done(*this);
+}
+
+bool TestDevice::runUntilRestart(unsigned long simMs) {
+  unsigned long restarts = this->platform.getRestarts();
+  unsigned long end = this->platform.millis() + simMs;
+  while (this->platform.getRestarts() == restarts && (long)(end - this->platform.millis()) > 0) {
+    this->runFor(100);
+  }
+  return this->platform.getRestarts() > restarts;
+}
+
+std::vector<uint8_t> readImage(TestDevice &device) {
+  std::vector<uint8_t> image;
+  FILE *file = fopen(device.directory.file("image.bin").c_str(), "rb");
+  int c;
+  if (file == NULL) {
+    return image;
+  }
+  while ((c = fgetc(file)) != EOF) {
+    image.push_back((uint8_t)c);
+  }
+  fclose(file);
+  return image;
+}
@@ -0,0 +1,158 @@
+/**
+
+   @file HawkbitTest.h
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#ifndef ___HAWKBIT_TEST_H___
+#define ___HAWKBIT_TEST_H___
+
+#include <HawkbitDdi.h>
+#include <HawkbitLinux.h>
+#include <string>
+#include "DdiServer.h"
+
+/* Checks count the failures and continue, main() returns testResult() */
+#define CHECK(condition) hawkbitCheck((condition), #condition, __FILE__, __LINE__)
+#define CHECK_EQUAL(expected, actual) \
+  hawkbitCheckEqual((long long)(expected), (long long)(actual), #actual, __FILE__, __LINE__)
+
+bool hawkbitCheck(bool ok, const char *expression, const char *file, int line);
+bool hawkbitCheckEqual(long long expected, long long actual, const char *expression, const char *file, int line);
+int testResult();
+
+/* Wall clock time in ms for measurements */
+double wallMs();
+/* CPU time of the calling thread in ms, without the server thread */
+double cpuMs();
+
+/* Print a benchmark result as one line of JSON, value is "name":value pairs */
+void printResult(const char *benchmark, const std::string &values);
+
+/* Heap use of the thread that called heapTrackingStart(), the server thread
+   is not counted. Sizes are the usable sizes of the allocations */
+struct HeapStats {
+  unsigned long allocations;
+  long current;
+  long peak;
+};
+
+void heapTrackingStart();
+HeapStats heapTrackingStop();
+
+class NullPrint : public Print
+{
+  public:
+    size_t write(uint8_t data) override {
+      return 1;
+    }
+
+    size_t write(const uint8_t *buffer, size_t size) override {
+      return size;
+    }
+};
+
+/* Platform with a clock that can be moved ahead, so idle time until the next
+   poll takes no real time. The log is quiet unless HB_TEST_VERBOSE is set */
+class SimPlatform : public HawkbitLinuxPlatform
+{
+  public:
+    unsigned long millis() override {
+      return HawkbitLinuxPlatform::millis() + this->_offset;
+    }
+
+    Print &log() override;
+
+    time_t time() override {
+      return 1760000000 + this->millis() / 1000;
+    }
+
+    void advance(unsigned long ms) {
+      this->_offset += ms;
+    }
+
+  private:
+    unsigned long _offset = 0;
+    NullPrint _null;
+};
+
+/* Temporary directory that is removed with its files */
+class TestDirectory
+{
+  public:
+    TestDirectory(void);
+    ~TestDirectory(void);
+
+    std::string file(const char *name) {
+      return this->_path + "/" + name;
+    }
+
+  private:
+    std::string _path;
+};
+
+/* A device running one HawkbitDdi against a DdiServer. reboot() replaces the
+   HawkbitDdi like a restart would, the storage and image file are kept */
+class TestDevice
+{
+  public:
+    TestDevice(DdiServer &server, const char *controllerId);
+    ~TestDevice(void);
+
+    /* Create a new HawkbitDdi, configure is called before begin() */
+    void boot(void (*configure)(HawkbitDdi &ddi) = NULL);
+    void reboot() {
+      this->boot(this->_configure);
+    }
+
+    /* Call work() until simMs of simulated time passed or done returns true.
+       Idle time is skipped, waiting for the server takes real time */
+    bool runFor(unsigned long simMs, bool (*done)(TestDevice &device) = NULL);
+    /* Like runFor() until the next restart() */
+    bool runUntilRestart(unsigned long simMs);
+
+    HawkbitDdi &ddi() {
+      return *this->_ddi;
+    }
+
+    std::string controllerId;
+    /* Server name the HawkbitDdi connects to, the host of the server if empty */
+    std::string host;
+    TestDirectory directory;
+    SimPlatform platform;
+    HawkbitLinuxTransport transport;
+    HawkbitFileFlashSink flash;
+    HawkbitFileStorage storage;
+    /* Longest single work() call in ms */
+    double maxWorkTime = 0;
+    unsigned long workCalls = 0;
+
+  private:
+    DdiServer &_server;
+    HawkbitDdi *_ddi = NULL;
+    void (*_configure)(HawkbitDdi &ddi) = NULL;
+};
+
+/* Image in the flash file of the device */
+std::vector<uint8_t> readImage(TestDevice &device);
+
+#endif /* ___HAWKBIT_TEST_H___ */
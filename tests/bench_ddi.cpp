@@ -0,0 +1,209 @@
+/**
+
+   @file bench_ddi.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "HawkbitTest.h"
+
+/* Scenarios of a device against the stand-in server. Each prints the wall
+   and simulated time, the heap use of the client and the traffic as one
+   line of JSON, bytesIn and bytesOut as seen by the server. The first
+   argument is the size of the artifact of the lossy download */
+
+struct Scenario {
+  const char *name;
+  double start;
+  unsigned long simStart;
+};
+
+static void begin(Scenario &scenario, TestDevice &device, const char *name) {
+  scenario.name = name;
+  scenario.simStart = device.platform.millis();
+  scenario.start = wallMs();
+  heapTrackingStart();
+}
+
+static void finish(Scenario &scenario, TestDevice &device, DdiServer &server, unsigned long polls,
+                   const std::string &extra = "") {
+  HeapStats heap = heapTrackingStop();
+  DdiServer::Stats stats = server.getStats();
+  char values[512];
+  snprintf(values, sizeof(values),
+           "\"wallMs\":%.3f,\"simMs\":%lu,\"allocations\":%lu,\"peakHeap\":%ld,\"maxWorkMs\":%.3f,"
+           "\"connections\":%lu,\"requests\":%lu,\"polls\":%lu,\"bytesIn\":%lu,\"bytesOut\":%lu,"
+           "\"downloadBytes\":%lu,\"downloadCuts\":%lu,\"feedbackLost\":%lu",
+           wallMs() - scenario.start, device.platform.millis() - scenario.simStart, heap.allocations,
+           heap.peak, device.maxWorkTime, stats.connections, stats.requests, polls, stats.bytesIn,
+           stats.bytesOut, stats.downloadBytes, stats.downloadCuts, stats.feedbackLost);
+  printResult(scenario.name, values + extra);
+}
+
+/* Skip the first poll cycle after begin() */
+static void settle(TestDevice &device, DdiServer &server) {
+  device.runFor(HB_POLL_STARTUP_JITTER + 60000);
+  server.resetStats();
+  device.maxWorkTime = 0;
+}
+
+static void idlePolls() {
+  DdiServer server;
+  Scenario scenario;
+  CHECK(server.start());
+  TestDevice device(server, "device1");
+  device.boot();
+  settle(device, server);
+  begin(scenario, device, "idle_poll");
+  device.runFor(3600000);
+  finish(scenario, device, server, server.getStats().polls);
+  CHECK(server.getStats().polls >= 11);
+  CHECK_EQUAL(server.getStats().polls, server.getStats().notModified);
+}
+
+static char configData[] = "{\"hwRevision\":\"2\",\"serial\":\"0042\",\"site\":\"hall 3\"}";
+
+static void setConfigData(HawkbitDdi &ddi) {
+  ddi.setConfigData(configData);
+}
+
+static void pollWithConfigData() {
+  DdiServer server;
+  Scenario scenario;
+  CHECK(server.start());
+  TestDevice device(server, "device1");
+  server.setConfigDataRequested(true);
+  device.boot(setConfigData);
+  begin(scenario, device, "poll_config_data");
+  device.runFor(60000);
+  finish(scenario, device, server, server.getStats().polls);
+  CHECK_EQUAL(1, server.getStats().configData);
+}
+
+static void deployment(const char *name, const char *update, size_t size) {
+  DdiServer server;
+  Scenario scenario;
+  CHECK(server.start());
+  TestDevice device(server, "device1");
+  device.boot();
+  settle(device, server);
+  server.deploy("device1", size, update, "forced");
+  begin(scenario, device, name);
+  CHECK(device.runUntilRestart(3600000));
+  finish(scenario, device, server, server.getStats().polls);
+  CHECK(server.getLastFeedback("device1").finished == "success");
+  CHECK(readImage(device) == server.getArtifact("device1"));
+}
+
+static bool downloading(TestDevice &device) {
+  return device.ddi().getStats().downloadBytes > 0;
+}
+
+/* Progress is only reported between segments, which need keep-alive */
+static void enableProgress(HawkbitDdi &ddi) {
+  ddi.setProgressFeedback(true);
+  ddi.setKeepAlive(true);
+}
+
+static void enableKeepAlive(HawkbitDdi &ddi) {
+  ddi.setKeepAlive(true);
+}
+
+/* Throughput of a download at 4 MB/s with 20 ms latency per request, with
+   and without progress feedback */
+static void progressDownload(const char *name, bool progress, size_t size) {
+  DdiServer server;
+  Scenario scenario;
+  char values[128];
+  double start;
+  CHECK(server.start());
+  TestDevice device(server, "device1");
+  server.setLatency(20);
+  server.setRateLimit(4194304);
+  device.boot(progress ? enableProgress : enableKeepAlive);
+  settle(device, server);
+  server.deploy("device1", size);
+  begin(scenario, device, name);
+  start = wallMs();
+  CHECK(device.runUntilRestart(3600000));
+  snprintf(values, sizeof(values), ",\"downloads\":%lu,\"mbPerSecond\":%.3f", server.getStats().downloads,
+           size / 1048576.0 / ((wallMs() - start) / 1000));
+  finish(scenario, device, server, server.getStats().polls, values);
+  CHECK(server.getLastFeedback("device1").finished == "success");
+  CHECK(readImage(device) == server.getArtifact("device1"));
+  /* Far fewer segments than HB_PROGRESS_BYTES would give */
+  CHECK(server.getStats().downloads <= (progress ? 3 : 1));
+}
+
+static void cancelDownload() {
+  DdiServer server;
+  Scenario scenario;
+  CHECK(server.start());
+  TestDevice device(server, "device1");
+  /* Polled between the segments of a slow download, which after the first
+     one end when a progress report is due */
+  server.setPollingSleep("00:00:01");
+  server.setRateLimit(262144);
+  device.boot(enableProgress);
+  settle(device, server);
+  server.deploy("device1", 8388608);
+  begin(scenario, device, "cancel_download");
+  CHECK(device.runFor(600000, downloading));
+  server.cancel("device1");
+  device.runFor(600000);
+  finish(scenario, device, server, server.getStats().polls);
+  CHECK(server.isClosed("device1"));
+  CHECK_EQUAL(1, server.getStats().cancelAction);
+  CHECK(server.getStats().downloadBytes < 8388608);
+  CHECK_EQUAL(0, device.platform.getRestarts());
+}
+
+static void lossyDownload(size_t size) {
+  DdiServer server;
+  Scenario scenario;
+  CHECK(server.start());
+  TestDevice device(server, "device1");
+  server.setSeed(1);
+  server.setDownloadCuts(0.3);
+  server.setFeedbackLoss(0.2, 503);
+  device.boot();
+  settle(device, server);
+  server.deploy("device1", size);
+  begin(scenario, device, "lossy_download");
+  CHECK(device.runUntilRestart(3600000));
+  finish(scenario, device, server, server.getStats().polls);
+  CHECK(server.getStats().downloadCuts > 0);
+  CHECK(server.getLastFeedback("device1").finished == "success");
+  CHECK(readImage(device) == server.getArtifact("device1"));
+}
+
+int main(int argc, char **argv) {
+  size_t size = argc > 1 ? strtoul(argv[1], NULL, 10) : 4 * 1048576;
+  idlePolls();
+  pollWithConfigData();
+  deployment("attempt_deployment", "attempt", 262144);
+  deployment("forced_deployment", "forced", 262144);
+  cancelDownload();
+  lossyDownload(size);
+  progressDownload("download_progress", true, size);
+  progressDownload("download_no_progress", false, size);
+  return testResult();
+}
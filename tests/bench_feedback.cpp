@@ -0,0 +1,196 @@
+/**
+
+   @file bench_feedback.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include <HawkbitJson.h>
+#include <time.h>
+#include "HawkbitTest.h"
+
+/* Encoding a progress feedback body the way postDeploymentBaseFeedback()
+   does with HawkbitJsonWriter, against snprintf() into the same buffer and
+   against concatenating a String. Prints the time and allocations per
+   feedback, then checks the bodies a deployment sends with the server */
+
+struct Feedback {
+  int actionId;
+  const char *execution;
+  const char *finished;
+  unsigned long bytes;
+  unsigned long total;
+};
+
+static const Feedback FEEDBACK = { 1742, "proceeding", "none", 1363148, 3145728 };
+static const time_t NOW = 1760616000;
+
+static void formatTime(char *timestamp, size_t size) {
+  struct tm utc;
+  gmtime_r(&NOW, &utc);
+  snprintf(timestamp, size, "%04u%02u%02uT%02u%02u%02u",
+           (unsigned)(utc.tm_year + 1900) % 10000U, (unsigned)(utc.tm_mon + 1) % 100U, (unsigned)utc.tm_mday % 100U,
+           (unsigned)utc.tm_hour % 100U, (unsigned)utc.tm_min % 100U, (unsigned)utc.tm_sec % 100U);
+}
+
+static size_t encodeWriter(char *body, size_t size, const Feedback &feedback) {
+  char timestamp[24];
+  char details[48];
+  HawkbitJsonWriter json(body, size);
+  formatTime(timestamp, sizeof(timestamp));
+  json.raw("{\"id\":\"").number(feedback.actionId).raw("\"");
+  json.raw(",\"time\":\"").raw(timestamp).raw("\"");
+  json.raw(",\"status\":{\"execution\":").string(feedback.execution);
+  json.raw(",\"result\":{\"finished\":").string(feedback.finished);
+  snprintf(details, sizeof(details), "Downloaded %lu of %lu bytes", feedback.bytes, feedback.total);
+  json.raw(",\"progress\":{\"cnt\":").number((long)((uint64_t)feedback.bytes * 100 / feedback.total)).raw(",\"of\":100}}");
+  json.raw(",\"details\":[").string(details).raw("]}}");
+  return json.overflow() ? 0 : json.length();
+}
+
+/* The strings are known not to need escaping */
+static size_t encodePrintf(char *body, size_t size, const Feedback &feedback) {
+  char timestamp[24];
+  int length;
+  formatTime(timestamp, sizeof(timestamp));
+  length = snprintf(body, size,
+                    "{\"id\":\"%d\",\"time\":\"%s\",\"status\":{\"execution\":\"%s\",\"result\":{\"finished\":\"%s\","
+                    "\"progress\":{\"cnt\":%lu,\"of\":100}},\"details\":[\"Downloaded %lu of %lu bytes\"]}}",
+                    feedback.actionId, timestamp, feedback.execution, feedback.finished,
+                    (unsigned long)((uint64_t)feedback.bytes * 100 / feedback.total), feedback.bytes, feedback.total);
+  return length > 0 && (size_t)length < size ? length : 0;
+}
+
+static String encodeString(const Feedback &feedback) {
+  char timestamp[24];
+  formatTime(timestamp, sizeof(timestamp));
+  return String("{\"id\":\"") + String(std::to_string(feedback.actionId).c_str()) + "\",\"time\":\"" + timestamp +
+         "\",\"status\":{\"execution\":\"" + feedback.execution + "\",\"result\":{\"finished\":\"" + feedback.finished +
+         "\",\"progress\":{\"cnt\":" + String(std::to_string((uint64_t)feedback.bytes * 100 / feedback.total).c_str()) +
+         ",\"of\":100}},\"details\":[\"Downloaded " + String(std::to_string(feedback.bytes).c_str()) + " of " +
+         String(std::to_string(feedback.total).c_str()) + " bytes\"]}}";
+}
+
+static void benchEncode(unsigned long iterations) {
+  char body[HB_FEEDBACK_BODY_SIZE];
+  char expected[HB_FEEDBACK_BODY_SIZE];
+  char values[256];
+  size_t length = 0;
+  double start;
+  double writerNs;
+  double printfNs;
+  double stringNs;
+  HeapStats writerHeap;
+  HeapStats stringHeap;
+
+  CHECK(encodePrintf(expected, sizeof(expected), FEEDBACK) > 0);
+  CHECK(encodeWriter(body, sizeof(body), FEEDBACK) > 0);
+  CHECK(strcmp(expected, body) == 0);
+  CHECK(encodeString(FEEDBACK) == String(expected));
+
+  heapTrackingStart();
+  start = wallMs();
+  for (unsigned long i = 0; i < iterations; i++) {
+    length += encodeWriter(body, sizeof(body), FEEDBACK);
+  }
+  writerNs = (wallMs() - start) * 1e6 / iterations;
+  writerHeap = heapTrackingStop();
+
+  start = wallMs();
+  for (unsigned long i = 0; i < iterations; i++) {
+    length += encodePrintf(body, sizeof(body), FEEDBACK);
+  }
+  printfNs = (wallMs() - start) * 1e6 / iterations;
+
+  heapTrackingStart();
+  start = wallMs();
+  for (unsigned long i = 0; i < iterations; i++) {
+    length += encodeString(FEEDBACK).length();
+  }
+  stringNs = (wallMs() - start) * 1e6 / iterations;
+  stringHeap = heapTrackingStop();
+
+  snprintf(values, sizeof(values),
+           "\"bytes\":%zu,\"writerNs\":%.1f,\"printfNs\":%.1f,\"stringNs\":%.1f,\"writerAllocations\":%.1f,\"stringAllocations\":%.1f",
+           length / iterations / 3, writerNs, printfNs, stringNs, (double)writerHeap.allocations / iterations,
+           (double)stringHeap.allocations / iterations);
+  printResult("feedback_encode", values);
+  CHECK_EQUAL(0, writerHeap.allocations);
+}
+
+static void testEscape() {
+  char buffer[64];
+  HawkbitJsonWriter json(buffer, sizeof(buffer));
+  json.string("a\"b\\c\nd\x01").raw(",").string("").raw(",").string("plain");
+  CHECK(strcmp(buffer, "\"a\\\"b\\\\c\\u000ad\\u0001\",\"\",\"plain\"") == 0);
+  CHECK(!json.overflow());
+}
+
+/* A body that does not fit is reported and nothing is written past the buffer */
+static void testOverflow() {
+  char buffer[64 + 8];
+  memset(buffer, 'x', sizeof(buffer));
+  CHECK_EQUAL(0, encodeWriter(buffer, 64, FEEDBACK));
+  CHECK(strlen(buffer) < 64);
+  for (size_t i = 64; i < sizeof(buffer); i++) {
+    CHECK_EQUAL('x', buffer[i]);
+  }
+}
+
+static void enableProgress(HawkbitDdi &ddi) {
+  ddi.setKeepAlive(true);
+  ddi.setProgressFeedback(true);
+}
+
+/* The server parses what the client encoded */
+static void testDeployment() {
+  DdiServer server;
+  std::vector<DdiServer::Feedback> feedback;
+  int progress = -1;
+  CHECK(server.start());
+  server.setRateLimit(262144);
+  TestDevice device(server, "device1");
+  device.boot(enableProgress);
+  device.runFor(60000);
+  server.deploy("device1", 1048576);
+  CHECK(device.runUntilRestart(600000));
+  feedback = server.getFeedback();
+  CHECK(feedback.size() >= 3);
+  for (const DdiServer::Feedback &entry : feedback) {
+    CHECK_EQUAL(1, entry.actionId);
+    CHECK(!entry.execution.empty());
+    CHECK(!entry.finished.empty());
+    if (entry.progress >= 0) {
+      CHECK(entry.progress > progress && entry.progress < 100);
+      progress = entry.progress;
+    }
+  }
+  CHECK(progress > 0);
+  CHECK(feedback.back().finished == "success");
+}
+
+int main(int argc, char **argv) {
+  benchEncode(argc > 1 ? strtoul(argv[1], NULL, 10) : 200000);
+  testEscape();
+  testOverflow();
+  testDeployment();
+  return testResult();
+}
@@ -0,0 +1,114 @@
+/**
+
+   @file bench_fleet.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include <HawkbitScheduler.h>
+#include <queue>
+#include <vector>
+#include "HawkbitTest.h"
+
+/* Spread of the polls of a fleet that boots at the same time, e.g. after a
+   power outage. Each device runs the HawkbitScheduler of the library with
+   its own controller ID, a poll takes 200 ms and the server asks for the
+   default interval. The polls are counted per 10 s window, a fleet that is
+   spread evenly makes devices * 10 s / interval requests per window. No
+   device may poll again earlier than the interval after its last poll */
+
+static const unsigned long WINDOW = 10000;
+static const unsigned long LATENCY = 200;
+
+struct Poll {
+  unsigned long time;
+  size_t device;
+
+  bool operator>(const Poll &other) const {
+    return this->time > other.time;
+  }
+};
+
+/* Largest number of polls in a window within [from, to) */
+static unsigned long peak(const std::vector<unsigned long> &windows, unsigned long from, unsigned long to) {
+  unsigned long result = 0;
+  for (size_t i = from / WINDOW; i < to / WINDOW && i < windows.size(); i++) {
+    if (windows[i] > result) {
+      result = windows[i];
+    }
+  }
+  return result;
+}
+
+int main(int argc, char **argv) {
+  size_t devices = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000;
+  const unsigned long duration = 6 * 3600000UL;
+  const unsigned long interval = HB_POLL_DEFAULT_INTERVAL;
+  std::vector<HawkbitScheduler> schedulers(devices);
+  std::vector<unsigned long> windows(duration / WINDOW, 0);
+  std::vector<unsigned long> last(devices, 0);
+  unsigned long shortestGap = duration;
+  std::priority_queue<Poll, std::vector<Poll>, std::greater<Poll>> polls;
+  double even = (double)devices * WINDOW / interval;
+  unsigned long settled = 0;
+  char values[512];
+  char controllerId[32];
+
+  for (size_t i = 0; i < devices; i++) {
+    snprintf(controllerId, sizeof(controllerId), "device%zu", i);
+    schedulers[i].begin(controllerId, 0);
+    polls.push({schedulers[i].getNextTime(), i});
+  }
+  while (!polls.empty() && polls.top().time < duration) {
+    Poll poll = polls.top();
+    polls.pop();
+    windows[poll.time / WINDOW]++;
+    if (last[poll.device] > 0 && poll.time - last[poll.device] < shortestGap) {
+      shortestGap = poll.time - last[poll.device];
+    }
+    last[poll.device] = poll.time;
+    schedulers[poll.device].success(poll.time + LATENCY, interval);
+    polls.push({schedulers[poll.device].getNextTime(), poll.device});
+  }
+  /* First interval after which no window exceeds twice the even load */
+  for (unsigned long start = 0; start + interval <= duration; start += interval) {
+    if (peak(windows, start, duration) <= 2 * even) {
+      settled = start;
+      break;
+    }
+    settled = duration;
+  }
+
+  snprintf(values, sizeof(values),
+           "\"devices\":%zu,\"intervalMs\":%lu,\"evenPerWindow\":%.1f,\"peakFirstMinute\":%lu,"
+           "\"peakSecondInterval\":%lu,\"peakFirstHour\":%lu,\"peakLastHour\":%lu,\"settledMs\":%lu,\"shortestGapMs\":%lu",
+           devices, interval, even, peak(windows, 0, 60000), peak(windows, interval, 2 * interval),
+           peak(windows, 0, 3600000), peak(windows, duration - 3600000, duration), settled, shortestGap);
+  printResult("fleet_boot", values);
+
+  /* Spread from the first poll on */
+  CHECK(peak(windows, 0, 60000) <= 2 * even);
+  CHECK(peak(windows, interval, 2 * interval) <= 2 * even);
+  CHECK_EQUAL(0, settled);
+  CHECK(shortestGap >= interval + LATENCY);
+  CHECK(peak(windows, duration - 3600000, duration) <= 2 * even);
+  return testResult();
+}
@@ -0,0 +1,100 @@
+/**
+
+   @file bench_hash.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "HawkbitTest.h"
+#include <HawkbitHash.h>
+
+/* Throughput of the artifact digests compared with the download throughput
+   over loopback, both in MB/s. The first argument is the artifact size in
+   bytes, the default keeps the run short for ctest */
+
+static const char *hashNames[] = { "none", "md5", "sha1", "sha256" };
+
+static void testVectors() {
+  HawkbitHash hash;
+  /* Expected digest in a longer buffer, as it is stored after parsing */
+  char expected[80];
+  hash.begin(HB_HASH_SHA256);
+  hash.update((const uint8_t *)"abc", 3);
+  CHECK(hash.verify("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"));
+  hash.begin(HB_HASH_SHA1);
+  hash.update((const uint8_t *)"abc", 3);
+  CHECK(hash.verify("A9993E364706816ABA3E25717850C26C9CD0D89D"));
+  hash.begin(HB_HASH_MD5);
+  hash.update((const uint8_t *)"abc", 3);
+  memset(expected, 'f', sizeof(expected));
+  memcpy(expected, "900150983cd24fb0d6963f7d28e17f72", 33);
+  CHECK(hash.verify(expected));
+  hash.begin(HB_HASH_MD5);
+  hash.update((const uint8_t *)"abd", 3);
+  CHECK(!hash.verify("900150983cd24fb0d6963f7d28e17f72"));
+}
+
+static void benchmarkHash(size_t size) {
+  std::vector<uint8_t> data(size, 0xa5);
+  HawkbitHash hash;
+  double start;
+  double elapsed;
+  char values[128];
+  for (int type = HB_HASH_MD5; type < HB_HASH_MAX; type++) {
+    start = wallMs();
+    hash.begin((HB_HASH_TYPE)type);
+    /* Same block size as the download writes to flash */
+    for (size_t offset = 0; offset < size; offset += HB_DOWNLOAD_CHUNK_SIZE) {
+      hash.update(data.data() + offset, std::min<size_t>(HB_DOWNLOAD_CHUNK_SIZE, size - offset));
+    }
+    hash.verify("");
+    elapsed = wallMs() - start;
+    snprintf(values, sizeof(values), "\"hash\":\"%s\",\"bytes\":%zu,\"ms\":%.3f,\"mbps\":%.1f",
+             hashNames[type], size, elapsed, size / 1048576.0 / (elapsed / 1000.0));
+    printResult("hash", values);
+  }
+}
+
+static void benchmarkDownload(size_t size) {
+  DdiServer server;
+  CHECK(server.start());
+  TestDevice device(server, "device1");
+  double start;
+  double elapsed;
+  char values[160];
+  server.deploy("device1", size);
+  start = wallMs();
+  device.boot();
+  CHECK(device.runUntilRestart(3600000));
+  elapsed = wallMs() - start;
+  CHECK(server.getLastFeedback("device1").finished == "success");
+  snprintf(values, sizeof(values), "\"bytes\":%zu,\"ms\":%.3f,\"mbps\":%.1f,\"flashWriteMs\":%lu",
+           size, elapsed, size / 1048576.0 / (elapsed / 1000.0), device.ddi().getStats().flashWriteTime);
+  printResult("download_sha256", values);
+}
+
+int main(int argc, char **argv) {
+  size_t size = argc > 1 ? strtoul(argv[1], NULL, 10) : 4 * 1048576;
+  testVectors();
+  benchmarkHash(size);
+  benchmarkDownload(size);
+  return testResult();
+}
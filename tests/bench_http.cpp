@@ -0,0 +1,152 @@
+/**
+
+   @file bench_http.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "HawkbitTest.h"
+
+/* HawkbitHttpResponse and HawkbitBodyStream against the readStringUntil()
+   loop the library used before, on responses in memory. The old loop only
+   skipped the headers and cannot decode a chunked body, the parser also
+   extracts status, length, framing, keep-alive, range and ETag. The first
+   argument is the number of rounds */
+
+static const char pollResponse[] =
+  "HTTP/1.1 200 OK\r\n"
+  "Date: Fri, 16 Oct 2026 12:00:00 GMT\r\n"
+  "Content-Type: application/hal+json;charset=UTF-8\r\n"
+  "Content-Length: 147\r\n"
+  "ETag: \"7f3c2a91\"\r\n"
+  "Connection: keep-alive\r\n"
+  "Keep-Alive: timeout=5, max=100\r\n"
+  "X-Content-Type-Options: nosniff\r\n"
+  "Cache-Control: no-cache, no-store, max-age=0, must-revalidate\r\n"
+  "\r\n"
+  "{\"config\":{\"polling\":{\"sleep\":\"00:05:00\"}},\"_links\":{\"configData\":"
+  "{\"href\":\"https://hawkbit.example.com/DEFAULT/controller/v1/device1/configData\"}}}";
+
+static const char notModifiedResponse[] =
+  "HTTP/1.1 304 Not Modified\r\n"
+  "Date: Fri, 16 Oct 2026 12:00:00 GMT\r\n"
+  "ETag: \"7f3c2a91\"\r\n"
+  "Connection: keep-alive\r\n"
+  "Keep-Alive: timeout=5, max=100\r\n"
+  "\r\n";
+
+static const char chunkedResponse[] =
+  "HTTP/1.1 200 OK\r\n"
+  "Content-Type: application/hal+json\r\n"
+  "Transfer-Encoding: chunked\r\n"
+  "Connection: keep-alive\r\n"
+  "\r\n"
+  "40\r\n"
+  "{\"config\":{\"polling\":{\"sleep\":\"00:05:00\"}},\"_links\":{\"deployment\r\n"
+  "1e\r\n"
+  "Base\":{\"href\":\"https://h/x\"}}}\r\n"
+  "0\r\n"
+  "\r\n";
+
+/* The loop of the original library, the body is read up to its end */
+static size_t parseOld(HawkbitBufferStream &stream, char *body, size_t size) {
+  size_t length = 0;
+  size_t read;
+  for (;;) {
+    String line = stream.readStringUntil('\n');
+    if (line == "\r" || line.length() == 0) {
+      break;
+    }
+  }
+  while ((read = stream.readBytes(body + length, size - length)) > 0) {
+    length += read;
+  }
+  return length;
+}
+
+static size_t parseNew(HawkbitBufferStream &stream, HawkbitHttpResponse &response, HawkbitBodyStream &bodyStream,
+                       char *body, size_t size) {
+  size_t length = 0;
+  size_t read;
+  int c;
+  response.reset();
+  while (!response.complete() && (c = stream.read()) >= 0) {
+    response.feed((char)c);
+  }
+  bodyStream.begin(&stream, response.getContentLength(), response.isChunked());
+  while (length < size && (read = bodyStream.readBytes(body + length, size - length)) > 0) {
+    length += read;
+  }
+  return length;
+}
+
+static void bench(const char *name, const char *text, size_t bodyLength, unsigned long rounds) {
+  HawkbitBufferStream stream;
+  HawkbitHttpResponse response;
+  HawkbitBodyStream bodyStream;
+  char body[512];
+  char values[256];
+  double start;
+  double oldTime;
+  double newTime;
+  HeapStats oldHeap;
+  HeapStats newHeap;
+  size_t length = strlen(text);
+  unsigned long oldErrors = 0;
+  unsigned long errors = 0;
+  /* No data means end of stream here, do not wait for more */
+  stream.setTimeout(0);
+  bodyStream.setTimeout(0);
+  heapTrackingStart();
+  start = wallMs();
+  for (unsigned long i = 0; i < rounds; i++) {
+    stream.begin(text, length);
+    oldErrors += parseOld(stream, body, sizeof(body)) != bodyLength;
+  }
+  oldTime = wallMs() - start;
+  oldHeap = heapTrackingStop();
+  heapTrackingStart();
+  start = wallMs();
+  for (unsigned long i = 0; i < rounds; i++) {
+    stream.begin(text, length);
+    errors += parseNew(stream, response, bodyStream, body, sizeof(body)) != bodyLength;
+  }
+  newTime = wallMs() - start;
+  newHeap = heapTrackingStop();
+  CHECK_EQUAL(0, errors);
+  CHECK(bodyStream.isComplete());
+  CHECK_EQUAL(0, newHeap.allocations);
+  snprintf(values, sizeof(values),
+           "\"bytes\":%zu,\"oldNs\":%.1f,\"newNs\":%.1f,\"oldAllocations\":%.1f,\"newAllocations\":%.1f,"
+           "\"oldBodyCorrect\":%s",
+           length, oldTime * 1e6 / rounds, newTime * 1e6 / rounds, (double)oldHeap.allocations / rounds,
+           (double)newHeap.allocations / rounds, oldErrors == 0 ? "true" : "false");
+  printResult(name, values);
+}
+
+int main(int argc, char **argv) {
+  unsigned long rounds = argc > 1 ? strtoul(argv[1], NULL, 10) : 100000;
+  bench("http_poll", pollResponse, 147, rounds);
+  bench("http_not_modified", notModifiedResponse, 0, rounds);
+  bench("http_chunked", chunkedResponse, 94, rounds);
+  return testResult();
+}
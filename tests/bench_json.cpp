@@ -0,0 +1,155 @@
+/**
+
+   @file bench_json.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "HawkbitTest.h"
+
+/* Deployment documents of growing size, padded with further software
+   modules by the stand-in server. Each is fetched once and parsed by
+   HawkbitJsonExtractor in a loop, then a device runs the whole deployment
+   to measure the peak heap of the client. Bodies above HB_BODY_BUFFER_SIZE
+   are parsed from the connection, so the heap must not grow with them */
+
+/* GET a resource of the server with the transport of the library */
+static std::string fetch(DdiServer &server, const std::string &path) {
+  HawkbitLinuxTransport transport;
+  HawkbitHttpResponse response;
+  HawkbitBodyStream body;
+  std::string request = "GET " + path + " HTTP/1.1\r\nHost: " + server.getHost() + "\r\nConnection: close\r\n"
+                        "Authorization: TargetToken token\r\n\r\n";
+  std::string result;
+  char buffer[1024];
+  size_t read;
+  char c;
+  if (!transport.connect(server.getHost().c_str(), server.getPort())) {
+    return result;
+  }
+  transport.write((const uint8_t *)request.data(), request.size());
+  /* readBytes() waits for the server */
+  while (!response.complete() && transport.readBytes(&c, 1) == 1) {
+    response.feed(c);
+  }
+  body.begin(&transport, response.getContentLength(), response.isChunked());
+  while ((read = body.readBytes(buffer, sizeof(buffer))) > 0) {
+    result.append(buffer, read);
+  }
+  transport.stop();
+  return response.getStatusCode() == 200 ? result : "";
+}
+
+struct Values {
+  unsigned long count;
+  bool download;
+};
+
+static void countValue(void *context, const char *path, const char *value) {
+  Values *values = (Values *)context;
+  values->count++;
+  if (strcmp(path, "deployment.chunks[0].artifacts[0]._links.download.href") == 0) {
+    values->download = true;
+  }
+}
+
+static void benchParse(const char *name, const std::string &document, unsigned long rounds) {
+  HawkbitBufferStream stream;
+  HawkbitJsonExtractor extractor;
+  Values values = { 0, false };
+  HeapStats heap;
+  double start;
+  double time;
+  char result[256];
+  bool ok = true;
+  heapTrackingStart();
+  start = wallMs();
+  for (unsigned long i = 0; i < rounds; i++) {
+    stream.begin(document.data(), document.size());
+    ok &= extractor.parse(stream, countValue, &values);
+  }
+  time = wallMs() - start;
+  heap = heapTrackingStop();
+  CHECK(ok);
+  CHECK(values.download);
+  CHECK_EQUAL(0, heap.allocations);
+  snprintf(result, sizeof(result),
+           "\"bytes\":%zu,\"buffered\":%s,\"values\":%lu,\"usPerDocument\":%.2f,\"mbPerSecond\":%.1f,"
+           "\"extractorBytes\":%zu",
+           document.size(), document.size() <= HB_BODY_BUFFER_SIZE ? "true" : "false", values.count / rounds, time * 1000 / rounds,
+           document.size() * rounds / 1048576.0 / (time / 1000), sizeof(HawkbitJsonExtractor));
+  printResult(name, result);
+}
+
+/* The whole deployment, returns the peak heap of the client. maxWorkMs grows
+   with documents that are parsed from the connection */
+static long runDeployment(const char *name, unsigned int padding) {
+  DdiServer server;
+  HeapStats heap;
+  double start;
+  char result[256];
+  CHECK(server.start());
+  server.setDeploymentPadding(padding);
+  TestDevice device(server, "device1");
+  device.boot();
+  device.runFor(60000);
+  device.maxWorkTime = 0;
+  server.deploy("device1", 65536);
+  start = wallMs();
+  heapTrackingStart();
+  CHECK(device.runUntilRestart(600000));
+  heap = heapTrackingStop();
+  CHECK(server.getLastFeedback("device1").finished == "success");
+  snprintf(result, sizeof(result),
+           "\"responseBytes\":%lu,\"wallMs\":%.3f,\"maxWorkMs\":%.3f,\"allocations\":%lu,\"peakHeap\":%ld",
+           device.ddi().getStats().requests[HB_REQ_DEPLOYMENTBASE].bytesIn, wallMs() - start, device.maxWorkTime, heap.allocations, heap.peak);
+  printResult(name, result);
+  return heap.peak;
+}
+
+int main(int argc, char **argv) {
+  unsigned long rounds = argc > 1 ? strtoul(argv[1], NULL, 10) : 200;
+  static const unsigned int paddings[] = { 0, 16, 256, 1024 };
+  long smallest = 0;
+  long peak;
+  char name[64];
+  for (size_t i = 0; i < sizeof(paddings) / sizeof(paddings[0]); i++) {
+    DdiServer server;
+    std::string document;
+    int id;
+    CHECK(server.start());
+    server.setDeploymentPadding(paddings[i]);
+    id = server.deploy("device1", 65536);
+    document = fetch(server, "/DEFAULT/controller/v1/device1/deploymentBase/" + std::to_string(id));
+    CHECK(!document.empty());
+    snprintf(name, sizeof(name), "json_parse_%u", paddings[i]);
+    benchParse(name, document, paddings[i] > 0 ? rounds * 16 / paddings[i] + 1 : rounds);
+    snprintf(name, sizeof(name), "json_deployment_%u", paddings[i]);
+    peak = runDeployment(name, paddings[i]);
+    if (i == 0) {
+      smallest = peak;
+    }
+    /* Streaming keeps the heap independent of the document size */
+    CHECK(peak <= smallest + 256);
+  }
+  return testResult();
+}
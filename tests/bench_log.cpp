@@ -0,0 +1,85 @@
+/**
+
+   @file bench_log.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include <HawkbitLog.h>
+#include "HawkbitTest.h"
+
+/* Cost of logging. The log level is chosen at compile time, so this is built
+   against the library at HB_LOG_LEVEL NONE, INFO and TRACE as bench_log_none,
+   bench_log and bench_log_trace. Each runs a day of polls and a deployment
+   with the log going to a sink that only counts the bytes */
+
+class CountingPrint : public Print
+{
+  public:
+    size_t write(uint8_t data) override {
+      this->bytes++;
+      return 1;
+    }
+
+    size_t write(const uint8_t *buffer, size_t size) override {
+      this->bytes += size;
+      return size;
+    }
+
+    unsigned long bytes = 0;
+};
+
+static CountingPrint logSink;
+
+static void countLog(HawkbitDdi &ddi) {
+  ddi.setLog(&logSink);
+}
+
+int main() {
+  DdiServer server;
+  char values[256];
+  double start;
+  double cpuStart;
+  HeapStats heap;
+  CHECK(server.start());
+  TestDevice device(server, "device1");
+  device.boot(countLog);
+  device.runFor(60000);
+  logSink.bytes = 0;
+  start = wallMs();
+  cpuStart = cpuMs();
+  heapTrackingStart();
+  device.runFor(86400000);
+  server.deploy("device1", 1048576);
+  CHECK(device.runUntilRestart(600000));
+  heap = heapTrackingStop();
+  CHECK(server.getLastFeedback("device1").finished == "success");
+  snprintf(values, sizeof(values), "\"logLevel\":%d,\"wallMs\":%.3f,\"cpuMs\":%.3f,\"workCalls\":%lu,\"logBytes\":%lu,\"allocations\":%lu",
+           HB_LOG_LEVEL, wallMs() - start, cpuMs() - cpuStart, device.workCalls, logSink.bytes, heap.allocations);
+  printResult("log_level", values);
+  if (HB_LOG_LEVEL == HB_LOG_LEVEL_NONE) {
+    CHECK_EQUAL(0, logSink.bytes);
+  } else {
+    CHECK(logSink.bytes > 0);
+  }
+  return testResult();
+}
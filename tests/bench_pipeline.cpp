@@ -0,0 +1,227 @@
+/**
+
+   @file bench_pipeline.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include <unistd.h>
+#include "HawkbitTest.h"
+
+/* Throughput of the flash pipeline. A producer that receives at a fixed rate
+   writes an image to a flash sink that takes a fixed time per sector, once
+   directly and once through HawkbitPipelinedFlashSink, which should approach
+   the slower of both instead of their sum. The first argument is the image
+   size, the second and third the network and flash time per 4 KB in us */
+
+/* Decorator that mimics the erase and program time of a flash sector */
+class SlowFlashSink : public HawkbitFlashSink
+{
+  public:
+    SlowFlashSink(HawkbitFlashSink *sink, unsigned long sectorTime) : _sink(sink), _sectorTime(sectorTime) {
+    }
+
+    bool begin(size_t size) override {
+      this->_pending = 0;
+      return this->_sink->begin(size);
+    }
+
+    size_t write(uint8_t *data, size_t len) override {
+      if (this->_failAt > 0 && this->_written + len > this->_failAt) {
+        return 0;
+      }
+      this->_pending += len;
+      while (this->_pending >= 4096) {
+        usleep(this->_sectorTime);
+        this->_pending -= 4096;
+      }
+      this->_written += len;
+      return this->_sink->write(data, len);
+    }
+
+    bool end() override {
+      return this->_sink->end();
+    }
+
+    bool commit() override {
+      return this->_sink->commit();
+    }
+
+    bool isFinished() override {
+      return this->_sink->isFinished();
+    }
+
+    void abort() override {
+      this->_sink->abort();
+    }
+
+    int getError() override {
+      return this->_sink->getError();
+    }
+
+    /* Fail the write that crosses offset, 0 never fails */
+    void setFailAt(size_t offset) {
+      this->_failAt = offset;
+      this->_written = 0;
+    }
+
+  private:
+    HawkbitFlashSink *_sink;
+    unsigned long _sectorTime;
+    size_t _pending = 0;
+    size_t _written = 0;
+    size_t _failAt = 0;
+};
+
+static std::vector<uint8_t> makeImage(size_t size) {
+  std::vector<uint8_t> image(size);
+  for (size_t i = 0; i < size; i++) {
+    image[i] = (uint8_t)(i * 2654435761u >> 24);
+  }
+  return image;
+}
+
+static std::vector<uint8_t> readFile(const std::string &path) {
+  std::vector<uint8_t> data;
+  FILE *file = fopen(path.c_str(), "rb");
+  int c;
+  if (file == NULL) {
+    return data;
+  }
+  while ((c = fgetc(file)) != EOF) {
+    data.push_back((uint8_t)c);
+  }
+  fclose(file);
+  return data;
+}
+
+/* Write the image in TCP sized pieces, received at networkTime per 4 KB */
+static size_t produce(HawkbitFlashSink &sink, const std::vector<uint8_t> &image, unsigned long networkTime) {
+  size_t offset = 0;
+  size_t received = 0;
+  size_t len;
+  while (offset < image.size()) {
+    len = image.size() - offset < 1460 ? image.size() - offset : 1460;
+    received += len;
+    while (received >= 4096) {
+      usleep(networkTime);
+      received -= 4096;
+    }
+    if (sink.write((uint8_t *)&image[offset], len) != len) {
+      break;
+    }
+    offset += len;
+  }
+  return offset;
+}
+
+static double writeImage(const char *name, bool pipelined, const std::vector<uint8_t> &image,
+                         unsigned long networkTime, unsigned long flashTime) {
+  TestDirectory directory;
+  std::string path = directory.file("image.bin");
+  HawkbitFileFlashSink file(path.c_str());
+  SlowFlashSink slow(&file, flashTime);
+  HawkbitPipelinedFlashSink pipeline;
+  HawkbitFlashSink *sink = &slow;
+  double started;
+  double time;
+  char values[256];
+  if (pipelined) {
+    pipeline.setSink(&slow);
+    sink = &pipeline;
+  }
+  started = wallMs();
+  CHECK(sink->begin(image.size()));
+  CHECK_EQUAL(image.size(), produce(*sink, image, networkTime));
+  CHECK(sink->end());
+  time = wallMs() - started;
+  CHECK(readFile(path) == image);
+  snprintf(values, sizeof(values), "\"bytes\":%zu,\"wallMs\":%.3f,\"mbPerSecond\":%.3f,\"networkUs\":%lu,\"flashUs\":%lu",
+           image.size(), time, image.size() / 1048576.0 / (time / 1000), networkTime, flashTime);
+  printResult(name, values);
+  return time;
+}
+
+/* A failing flash write has to surface in write() or end() */
+static void writeFailure(const std::vector<uint8_t> &image) {
+  TestDirectory directory;
+  std::string path = directory.file("image.bin");
+  HawkbitFileFlashSink file(path.c_str());
+  SlowFlashSink slow(&file, 0);
+  HawkbitPipelinedFlashSink pipeline;
+  pipeline.setSink(&slow);
+  slow.setFailAt(image.size() / 2);
+  CHECK(pipeline.begin(image.size()));
+  CHECK(produce(pipeline, image, 0) < image.size() || !pipeline.end());
+  CHECK(!file.isFinished());
+}
+
+/* An abort while buffers are in flight stops the writer and discards them */
+static void abortWrite(const std::vector<uint8_t> &image) {
+  TestDirectory directory;
+  std::string path = directory.file("image.bin");
+  HawkbitFileFlashSink file(path.c_str());
+  SlowFlashSink slow(&file, 1000);
+  HawkbitPipelinedFlashSink pipeline;
+  pipeline.setSink(&slow);
+  CHECK(pipeline.begin(image.size()));
+  CHECK_EQUAL(65536, pipeline.write((uint8_t *)&image[0], 65536));
+  pipeline.abort();
+  CHECK(!file.isFinished());
+  /* The sink can be used again afterwards */
+  CHECK(pipeline.begin(image.size()));
+  CHECK_EQUAL(image.size(), produce(pipeline, image, 0));
+  CHECK(pipeline.end());
+  CHECK(readFile(path) == image);
+}
+
+static void enablePipeline(HawkbitDdi &ddi) {
+  ddi.setDownloadPipeline(true);
+}
+
+/* The whole download path with the pipeline against the stand-in server */
+static void pipelinedDeployment() {
+  DdiServer server;
+  CHECK(server.start());
+  TestDevice device(server, "device1");
+  device.boot(enablePipeline);
+  device.runFor(60000);
+  server.deploy("device1", 1048576 + 1234);
+  CHECK(device.runUntilRestart(3600000));
+  CHECK(server.getLastFeedback("device1").finished == "success");
+  CHECK(readImage(device) == server.getArtifact("device1"));
+}
+
+int main(int argc, char **argv) {
+  size_t size = argc > 1 ? strtoul(argv[1], NULL, 10) : 2 * 1048576;
+  unsigned long networkTime = argc > 2 ? strtoul(argv[2], NULL, 10) : 1000;
+  unsigned long flashTime = argc > 3 ? strtoul(argv[3], NULL, 10) : 1000;
+  std::vector<uint8_t> image = makeImage(size);
+  double direct = writeImage("flash_direct", false, image, networkTime, flashTime);
+  double pipelined = writeImage("flash_pipelined", true, image, networkTime, flashTime);
+  /* Overlapping both halves saves a good part of the smaller one */
+  CHECK(pipelined < direct * 0.8);
+  writeFailure(image);
+  abortWrite(image);
+  pipelinedDeployment();
+  return testResult();
+}
@@ -0,0 +1,125 @@
+/**
+
+   @file bench_poll.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "HawkbitTest.h"
+
+/* Cost of the steady state: a day of polls every five minutes against an
+   unchanged controller resource, answered with 304 Not Modified (etag) or
+   with the full body that the client recognizes by its hash (hash), and
+   against a resource that changes with every poll and is parsed each time
+   (changed). The bytes are counted by the server, the CPU time is that of
+   the client thread */
+
+static const unsigned long DAY = 86400000;
+static const unsigned long POLL = 300000;
+
+struct PollResult {
+  unsigned long polls;
+  unsigned long notModified;
+  double bytesOut;
+  double bytesIn;
+  double cpuUs;
+};
+
+static DdiServer *pollServer;
+static unsigned long lastPolls;
+
+static bool polled(TestDevice &device) {
+  return pollServer->getStats().polls > lastPolls;
+}
+
+static PollResult runDay(DdiServer &server, const char *controllerId, bool etag, bool changing) {
+  PollResult result;
+  DdiServer::Stats stats;
+  double cpuStart;
+  char values[256];
+  server.setETag(etag);
+  server.setPollingSleep("00:05:00");
+  TestDevice device(server, controllerId);
+  device.boot();
+  device.runFor(2 * POLL);
+  server.resetStats();
+  cpuStart = cpuMs();
+  if (changing) {
+    /* Change the resource after every poll, as many polls as in a day */
+    pollServer = &server;
+    for (lastPolls = 0; lastPolls < DAY / POLL; lastPolls++) {
+      server.setPollingSleep(lastPolls % 2 ? "00:05:00" : "00:04:59");
+      device.runFor(2 * POLL, polled);
+    }
+  } else {
+    device.runFor(DAY);
+  }
+  result.cpuUs = (cpuMs() - cpuStart) * 1000.0;
+  stats = server.getStats();
+  result.polls = stats.polls;
+  result.notModified = stats.notModified;
+  if (result.polls > 0) {
+    result.bytesOut = (double)stats.bytesOut / result.polls;
+    result.bytesIn = (double)stats.bytesIn / result.polls;
+    result.cpuUs /= result.polls;
+  }
+  snprintf(values, sizeof(values),
+           "\"polls\":%lu,\"notModified\":%lu,\"bytesOutPerPoll\":%.1f,\"bytesInPerPoll\":%.1f,\"cpuUsPerPoll\":%.1f",
+           result.polls, result.notModified, result.bytesOut, result.bytesIn, result.cpuUs);
+  printResult(changing ? "poll_changed" : (etag ? "poll_etag" : "poll_hash"), values);
+  return result;
+}
+
+int main() {
+  DdiServer server;
+  PollResult etag;
+  PollResult hash;
+  PollResult changed;
+  CHECK(server.start());
+
+  etag = runDay(server, "device1", true, false);
+  hash = runDay(server, "device2", false, false);
+  changed = runDay(server, "device3", true, true);
+
+  CHECK(etag.polls >= DAY / POLL * 9 / 10);
+  CHECK(etag.notModified >= etag.polls - 1);
+  CHECK_EQUAL(0, hash.notModified);
+  CHECK_EQUAL(0, changed.notModified);
+  CHECK(etag.bytesOut < changed.bytesOut / 2);
+  /* Without ETag the body is still sent, only its parsing is saved */
+  CHECK(hash.bytesOut > etag.bytesOut * 1.5);
+  CHECK(hash.cpuUs < changed.cpuUs);
+
+  /* A deployment is still noticed after a day of cached polls */
+  {
+    server.setETag(true);
+    server.setPollingSleep("00:05:00");
+    TestDevice device(server, "device4");
+    device.boot();
+    device.runFor(DAY / 4);
+    server.resetStats();
+    server.deploy("device4", 65536);
+    CHECK(device.runUntilRestart(2 * POLL));
+    CHECK(server.getStats().deploymentBase >= 1);
+    CHECK(server.getLastFeedback("device4").finished == "success");
+  }
+  return testResult();
+}
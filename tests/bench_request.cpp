@@ -0,0 +1,193 @@
+/**
+
+   @file bench_request.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include <HawkbitHttp.h>
+#include "HawkbitTest.h"
+
+/* Request assembly of sendRequest() with HawkbitRequestWriter against the
+   former createHeaders() and printf to the transport. Both write the same
+   bytes to a sink that counts the write calls, on TLS each of them may be
+   a record of its own. The former body came from serializeJson() token by
+   token, here it is a single print, which favours the old code */
+
+class CountingPrint : public Print
+{
+  public:
+    size_t write(uint8_t data) override {
+      return this->write(&data, 1);
+    }
+
+    size_t write(const uint8_t *buffer, size_t size) override {
+      this->writes++;
+      this->bytes += size;
+      if (this->capture) {
+        this->text.append((const char *)buffer, size);
+      }
+      return size;
+    }
+
+    unsigned long writes = 0;
+    unsigned long bytes = 0;
+    bool capture = false;
+    std::string text;
+};
+
+struct Request {
+  const char *name;
+  const char *method;
+  const char *path;
+  const char *extraHeaders;
+  const char *body;
+};
+
+static const char *TENANT = "0d1c3f0e-27a4-4d8e-9c4a-12a3b4c5d6e7";
+static const char *CONTROLLER = "esp32-30aea4123456";
+static const char *SERVER = "device.eu-central.bosch-iot-rollouts.com";
+static const char *TOKEN = "5d8e9a1bc4f2437e8b6a0c9d1e2f3a4b";
+static const char *FEEDBACK =
+  "{\"id\":\"1742\",\"time\":\"20261016T120000\",\"status\":{\"execution\":\"proceeding\","
+  "\"result\":{\"finished\":\"none\",\"progress\":{\"cnt\":42,\"of\":100}},\"details\":[\"Downloaded 42%\"]}}";
+
+static const Request requests[] = {
+  { "poll", "GET", "", "If-None-Match: \"5f8b3c2a\"\r\n", NULL },
+  { "feedback", "POST", "/deploymentBase/1742/feedback", NULL, FEEDBACK },
+};
+
+static char headers[1024];
+
+/* createHeaders() and the prints of sendRequest() before the request writer */
+static void sendOld(Print &out, const Request &request) {
+  char path[256];
+  size_t length;
+  snprintf(path, sizeof(path), "/%s/controller/v1/%s%s", TENANT, CONTROLLER, request.path);
+  snprintf(headers, sizeof(headers), "Host: %s\r\n", SERVER);
+  length = strnlen(headers, sizeof(headers));
+  snprintf(headers + length, sizeof(headers) - length, "Authorization: %s %s\r\n", "TargetToken", TOKEN);
+  length = strnlen(headers, sizeof(headers));
+  snprintf(headers + length, sizeof(headers) - length, "Accept: %s\r\n", "application/hal+json");
+  length = strnlen(headers, sizeof(headers));
+  snprintf(headers + length, sizeof(headers) - length, "Connection: %s\r\n", "keep-alive");
+  out.printf("%s %s%.*s HTTP/1.1\r\n", request.method, path[0] == '/' ? "" : "/", (int)strcspn(path, "#"), path);
+  out.print(headers);
+  if (request.extraHeaders != NULL) {
+    out.print(request.extraHeaders);
+  }
+  if (request.body != NULL) {
+    out.println("Content-Type: application/json");
+    out.printf("Content-Length: %d\r\n", (int)strlen(request.body));
+  }
+  out.println();
+  if (request.body != NULL) {
+    out.print(request.body);
+  }
+}
+
+/* What sendRequest() does now, the base path and Authorization header are
+   prepared in begin() */
+static void sendNew(Print &out, const Request &request, const String &basePath, const String &authorization) {
+  HawkbitRequestWriter writer(&out);
+  size_t bodyLength = 0;
+  writer.add(request.method);
+  writer.add(" ");
+  writer.add(basePath.c_str(), basePath.length());
+  writer.add(CONTROLLER);
+  writer.add(request.path);
+  writer.add(" HTTP/1.1\r\nHost: ");
+  writer.add(SERVER);
+  writer.add("\r\n");
+  writer.add(authorization.c_str(), authorization.length());
+  writer.add("Accept: ");
+  writer.add("application/hal+json");
+  writer.add("\r\n");
+  writer.add("Connection: keep-alive\r\n");
+  if (request.extraHeaders != NULL) {
+    writer.add(request.extraHeaders);
+  }
+  if (request.body != NULL) {
+    bodyLength = strlen(request.body);
+    writer.add("Content-Type: application/json\r\nContent-Length: ");
+    writer.addNumber(bodyLength);
+    writer.add("\r\n");
+  }
+  writer.add("\r\n");
+  if (request.body != NULL) {
+    writer.add(request.body, bodyLength);
+  }
+  writer.finish();
+}
+
+int main(int argc, char **argv) {
+  unsigned long iterations = argc > 1 ? strtoul(argv[1], NULL, 10) : 200000;
+  String basePath = String("/") + TENANT + "/controller/v1/";
+  String authorization = String("Authorization: TargetToken ") + TOKEN + "\r\n";
+  char values[512];
+  for (const Request &request : requests) {
+    CountingPrint oldSink;
+    CountingPrint newSink;
+    HeapStats oldHeap;
+    HeapStats newHeap;
+    double oldNs;
+    double newNs;
+    double start;
+
+    oldSink.capture = true;
+    newSink.capture = true;
+    sendOld(oldSink, request);
+    sendNew(newSink, request, basePath, authorization);
+    CHECK(oldSink.text == newSink.text);
+    oldSink = CountingPrint();
+    newSink = CountingPrint();
+
+    heapTrackingStart();
+    start = wallMs();
+    for (unsigned long i = 0; i < iterations; i++) {
+      sendOld(oldSink, request);
+    }
+    oldNs = (wallMs() - start) * 1e6 / iterations;
+    oldHeap = heapTrackingStop();
+
+    heapTrackingStart();
+    start = wallMs();
+    for (unsigned long i = 0; i < iterations; i++) {
+      sendNew(newSink, request, basePath, authorization);
+    }
+    newNs = (wallMs() - start) * 1e6 / iterations;
+    newHeap = heapTrackingStop();
+
+    snprintf(values, sizeof(values),
+             "\"bytes\":%lu,\"oldNs\":%.1f,\"newNs\":%.1f,\"oldWrites\":%.1f,\"newWrites\":%.1f,"
+             "\"oldAllocations\":%.1f,\"newAllocations\":%.1f",
+             newSink.bytes / iterations, oldNs, newNs, (double)oldSink.writes / iterations,
+             (double)newSink.writes / iterations, (double)oldHeap.allocations / iterations,
+             (double)newHeap.allocations / iterations);
+    printResult(request.name, values);
+    CHECK_EQUAL(oldSink.bytes, newSink.bytes);
+    CHECK_EQUAL(1, newSink.writes / iterations);
+    CHECK_EQUAL(0, newHeap.allocations);
+    CHECK(newSink.writes < oldSink.writes);
+    CHECK(newNs < oldNs);
+  }
+  return testResult();
+}
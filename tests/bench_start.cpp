@@ -0,0 +1,156 @@
+/**
+
+   @file bench_start.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "HawkbitTest.h"
+
+/* Cold against warm start. A warm start reboots with the storage of the
+   running device, a cold start with the storage cleared, like a first boot
+   or a device without storage. Measured are the requests and bytes until
+   the first useful request and the simulated time it takes: the resumed
+   artifact download in the middle of a deployment, the next poll of an
+   idle device. The bytes sent by the server leave out the artifact */
+
+static DdiServer *server;
+
+static void clearStorage(TestDevice &device) {
+  const char *keys[] = { "controller", "download", "feedback", "configdata" };
+  for (const char *key : keys) {
+    device.storage.remove(key);
+  }
+}
+
+static bool halfDownloaded(TestDevice &device) {
+  return server->getStats().downloadBytes >= 1048576;
+}
+
+static bool downloading(TestDevice &device) {
+  return server->getStats().downloads > 0;
+}
+
+/* The poll was counted and the client has nothing left to send, so the
+   requests that follow the poll are in the stats as well */
+static bool polledAndIdle(TestDevice &device) {
+  return server->getStats().polls > 0 && device.ddi().getWorkState() == HB_STATE_IDLE &&
+         device.ddi().getSleepTime() > 0;
+}
+
+static char configData[] = "{\"hwRevision\":\"2\",\"serial\":\"0042\"}";
+
+static void setConfigData(HawkbitDdi &ddi) {
+  ddi.setConfigData(configData);
+}
+
+static void printStart(const char *name, bool warm, unsigned long simMs, double ms, const DdiServer::Stats &before,
+                       unsigned long extra, const char *extraName) {
+  char values[256];
+  snprintf(values, sizeof(values),
+           "\"start\":\"%s\",\"simMs\":%lu,\"wallMs\":%.1f,\"requestsBefore\":%lu,\"bytesOut\":%lu,\"bytesIn\":%lu,\"%s\":%lu",
+           warm ? "warm" : "cold", simMs, ms, before.requests, before.bytesOut - before.downloadBytes, before.bytesIn,
+           extraName, extra);
+  printResult(name, values);
+}
+
+/* Reboot in the middle of a 2 MB download, until the artifact is requested
+   again. Returns the artifact bytes sent after the reboot */
+static unsigned long download(bool warm) {
+  TestDevice device(*server, warm ? "warm" : "cold");
+  DdiServer::Stats before;
+  unsigned long simStart;
+  double start;
+  server->setRateLimit(262144);
+  device.boot();
+  device.runFor(60000);
+  server->deploy(device.controllerId, 2097152);
+  server->resetStats();
+  CHECK(device.runFor(600000, halfDownloaded));
+  if (!warm) {
+    clearStorage(device);
+  }
+  /* Reset before begin(), which may already send the first request */
+  server->setRateLimit(0);
+  server->resetStats();
+  simStart = device.platform.millis();
+  start = wallMs();
+  device.reboot();
+  CHECK(device.runFor(600000, downloading));
+  before = server->getStats();
+  before.requests--;
+  printStart("start_download", warm, device.platform.millis() - simStart, wallMs() - start, before,
+             before.deploymentBase, "deploymentBase");
+  CHECK(device.runUntilRestart(600000));
+  CHECK(server->getLastFeedback(device.controllerId).finished == "success");
+  return server->getStats().downloadBytes;
+}
+
+/* Reboot an idle device with config data, until its next poll */
+static DdiServer::Stats idle(bool warm) {
+  TestDevice device(*server, warm ? "idle-warm" : "idle-cold");
+  DdiServer::Stats before;
+  DdiServer::Stats stats;
+  unsigned long simStart;
+  double start;
+  device.boot(setConfigData);
+  device.runFor(3600000);
+  if (!warm) {
+    clearStorage(device);
+  }
+  server->resetStats();
+  simStart = device.platform.millis();
+  start = wallMs();
+  device.reboot();
+  CHECK(device.runFor(600000, polledAndIdle));
+  stats = server->getStats();
+  before = stats;
+  before.requests -= stats.polls;
+  printStart("start_idle", warm, device.platform.millis() - simStart, wallMs() - start, before,
+             stats.notModified, "notModified");
+  return stats;
+}
+
+int main() {
+  DdiServer ddiServer;
+  unsigned long warmBytes;
+  unsigned long coldBytes;
+  DdiServer::Stats warmIdle;
+  DdiServer::Stats coldIdle;
+  server = &ddiServer;
+  CHECK(ddiServer.start());
+  ddiServer.setConfigDataRequested(true);
+
+  warmBytes = download(true);
+  coldBytes = download(false);
+  /* The warm start continues the download, the cold one starts over */
+  CHECK(warmBytes <= 1048576 + 65536);
+  CHECK(coldBytes >= 2097152);
+
+  warmIdle = idle(true);
+  coldIdle = idle(false);
+  CHECK_EQUAL(0, warmIdle.configData);
+  CHECK_EQUAL(1, warmIdle.notModified);
+  CHECK_EQUAL(1, coldIdle.configData);
+  CHECK_EQUAL(0, coldIdle.notModified);
+  CHECK(warmIdle.bytesOut < coldIdle.bytesOut);
+  return testResult();
+}
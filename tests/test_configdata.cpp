@@ -0,0 +1,148 @@
+/**
+
+   @file test_configdata.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include <HawkbitConfigData.h>
+#include <string.h>
+#include "HawkbitTest.h"
+
+/* HawkbitConfigDataTracker on its own and a simulated week of a device
+   whose controller resource always asks for config data. The device reboots
+   after the second and the fifth day and changes one attribute on the
+   fourth. The number and
+   size of the PUTs are compared with uploading whenever the server asks */
+
+static const unsigned long DAY = 86400000;
+
+static HB_CONFIGDATA_CHANGE compare(HawkbitConfigDataTracker &tracker, const char *scope, const char *data) {
+  return tracker.compare(scope, data, strlen(data));
+}
+
+static void acknowledge(HawkbitConfigDataTracker &tracker, const char *scope, const char *data) {
+  tracker.acknowledge(scope, data, strlen(data));
+}
+
+static void testTracker() {
+  TestDirectory directory;
+  HawkbitFileStorage storage(directory.file("").c_str());
+  HawkbitConfigDataTracker tracker;
+  HawkbitConfigDataTracker rebooted;
+  HawkbitConfigDataTracker nested;
+  std::string many = "{";
+  const char *data = "{\"hwRevision\":\"2\",\"site\":\"hall 3\"}";
+
+  tracker.begin(&storage);
+  CHECK_EQUAL(HB_CONFIGDATA_REPLACED, compare(tracker, "device1", data));
+  CHECK(tracker.changed("site", "hall 3"));
+  acknowledge(tracker, "device1", data);
+  CHECK_EQUAL(HB_CONFIGDATA_UNCHANGED, compare(tracker, "device1", data));
+  CHECK_EQUAL(HB_CONFIGDATA_REPLACED, compare(tracker, "device2", data));
+  CHECK_EQUAL(HB_CONFIGDATA_CHANGED, compare(tracker, "device1", "{\"hwRevision\":\"2\",\"site\":\"hall 4\"}"));
+  CHECK_EQUAL(HB_CONFIGDATA_CHANGED, compare(tracker, "device1", "{\"hwRevision\":\"2\",\"site\":\"hall 3\",\"floor\":\"1\"}"));
+  CHECK_EQUAL(HB_CONFIGDATA_REPLACED, compare(tracker, "device1", "{\"site\":\"hall 3\"}"));
+  CHECK(!tracker.changed("hwRevision", "2"));
+  CHECK(tracker.changed("site", "hall 4"));
+  CHECK(tracker.changed("floor", "1"));
+
+  /* The acknowledged state survives a reboot */
+  rebooted.begin(&storage);
+  CHECK_EQUAL(HB_CONFIGDATA_UNCHANGED, compare(rebooted, "device1", data));
+  CHECK(!rebooted.changed("site", "hall 3"));
+  storage.remove("configdata");
+  rebooted.begin(&storage);
+  CHECK_EQUAL(HB_CONFIGDATA_REPLACED, compare(rebooted, "device1", data));
+
+  /* Nested or too many attributes are only known as a whole */
+  nested.begin(NULL);
+  acknowledge(nested, "device1", "{\"net\":{\"ip\":\"10.0.0.2\"}}");
+  CHECK_EQUAL(HB_CONFIGDATA_UNCHANGED, compare(nested, "device1", "{\"net\":{\"ip\":\"10.0.0.2\"}}"));
+  CHECK_EQUAL(HB_CONFIGDATA_REPLACED, compare(nested, "device1", "{\"net\":{\"ip\":\"10.0.0.3\"}}"));
+  for (int i = 0; i <= HB_CONFIGDATA_KEYS; i++) {
+    many += std::string(i > 0 ? "," : "") + "\"key" + std::to_string(i) + "\":\"" + std::to_string(i) + "\"";
+  }
+  many += "}";
+  acknowledge(nested, "device1", many.c_str());
+  CHECK_EQUAL(HB_CONFIGDATA_UNCHANGED, compare(nested, "device1", many.c_str()));
+  many.replace(many.find("\"1\""), 3, "\"x\"");
+  CHECK_EQUAL(HB_CONFIGDATA_REPLACED, compare(nested, "device1", many.c_str()));
+}
+
+static char configData[] = "{\"hwRevision\":\"2\",\"serial\":\"0042\",\"site\":\"hall 3\",\"firmware\":\"1.4.2\"}";
+static char changedData[] = "{\"hwRevision\":\"2\",\"serial\":\"0042\",\"site\":\"hall 4\",\"firmware\":\"1.4.2\"}";
+static char *current = configData;
+
+static void setConfigData(HawkbitDdi &ddi) {
+  ddi.setConfigData(current);
+}
+
+static void simulateWeek() {
+  DdiServer server;
+  DdiServer::Stats stats;
+  std::vector<std::string> puts;
+  unsigned long bodyBytes = 0;
+  char values[256];
+  CHECK(server.start());
+  server.setConfigDataRequested(true);
+  TestDevice device(server, "device1");
+  device.boot(setConfigData);
+  for (int day = 0; day < 7; day++) {
+    if (day == 3) {
+      current = changedData;
+      device.ddi().setConfigData(current);
+    }
+    device.runFor(DAY);
+    if (day == 1 || day == 4) {
+      device.reboot();
+    }
+  }
+  stats = server.getStats();
+  puts = server.getConfigData();
+  for (const std::string &body : puts) {
+    bodyBytes += body.size();
+  }
+  snprintf(values, sizeof(values),
+           "\"polls\":%lu,\"puts\":%lu,\"putBodyBytes\":%lu,\"askedPuts\":%lu,\"askedBodyBytes\":%lu",
+           stats.polls, stats.configData, bodyBytes, stats.polls, stats.polls * (unsigned long)puts.front().size());
+  printResult("configdata_week", values);
+
+  /* The first upload, one merge of the change and a refresh after each day
+     without reboot while the server keeps asking */
+  CHECK(stats.configData >= 2 && stats.configData <= 7);
+  CHECK(stats.polls > 200 * stats.configData);
+  CHECK(puts.front().find("\"mode\":\"replace\"") != std::string::npos);
+  CHECK(puts.front().find("\"serial\":\"0042\"") != std::string::npos);
+  bool merged = false;
+  for (const std::string &body : puts) {
+    if (body.find("\"hall 4\"") != std::string::npos && body.find("\"serial\"") == std::string::npos) {
+      merged = true;
+    }
+  }
+  CHECK(merged);
+}
+
+int main() {
+  testTracker();
+  simulateWeek();
+  return testResult();
+}
@@ -0,0 +1,176 @@
+/**
+
+   @file test_download.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include <sys/stat.h>
+#include <unistd.h>
+#include "HawkbitTest.h"
+
+/* Downloads over connections that are cut at random offsets, servers that
+   ignore or misreport ranges and a flash that cannot be started */
+
+static bool downloading(TestDevice &device) {
+  return device.ddi().getStats().downloadBytes > 0;
+}
+
+/* Each deployment either installs the exact artifact or fails after
+   HB_DOWNLOAD_MAX_ATTEMPTS cuts, it never activates a broken image. The
+   device restarts after the action is closed either way */
+static void testRandomCuts(bool ranges) {
+  unsigned long installed = 0;
+  unsigned long cuts = 0;
+  for (unsigned int seed = 1; seed <= 16; seed++) {
+    DdiServer server;
+    CHECK(server.start());
+    TestDevice device(server, "device1");
+    server.setSeed(seed);
+    server.setDownloadCuts(0.5);
+    server.setRangeSupport(ranges);
+    device.boot();
+    device.runFor(60000);
+    server.deploy("device1", 524288 + seed);
+    device.runFor(3600000);
+    cuts += server.getStats().downloadCuts;
+    if (server.getLastFeedback("device1").finished == "success") {
+      installed++;
+      CHECK_EQUAL(1, device.platform.getRestarts());
+      CHECK(readImage(device) == server.getArtifact("device1"));
+    } else {
+      CHECK(server.getLastFeedback("device1").finished == "failure");
+      CHECK(!device.flash.isFinished());
+      CHECK(server.getStats().downloadCuts >= HB_DOWNLOAD_MAX_ATTEMPTS);
+    }
+  }
+  CHECK(installed > 0);
+  CHECK(cuts > 0);
+  printResult(ranges ? "random_cuts" : "random_cuts_no_ranges",
+              "\"deployments\":16,\"installed\":" + std::to_string(installed) + ",\"cuts\":" + std::to_string(cuts));
+}
+
+/* A cut download continues from storage after a reboot */
+static void testCutAndReboot() {
+  DdiServer server;
+  CHECK(server.start());
+  TestDevice device(server, "device1");
+  server.setSeed(3);
+  server.setDownloadCuts(1);
+  server.setRateLimit(1048576);
+  device.boot();
+  device.runFor(60000);
+  server.deploy("device1", 1048576);
+  CHECK(device.runFor(600000, downloading));
+  server.setDownloadCuts(0);
+  device.runFor(1000);
+  device.reboot();
+  CHECK(device.runUntilRestart(600000));
+  CHECK(server.getLastFeedback("device1").finished == "success");
+  CHECK(readImage(device) == server.getArtifact("device1"));
+  CHECK(server.getStats().downloadBytes < 2 * 1048576);
+}
+
+static void enableProgress(HawkbitDdi &ddi) {
+  ddi.setProgressFeedback(true);
+  ddi.setKeepAlive(true);
+}
+
+/* A range of another artifact size fails the action instead of mixing two
+   artifacts in one image */
+static void testWrongRangeTotal() {
+  DdiServer server;
+  CHECK(server.start());
+  TestDevice device(server, "device1");
+  server.setRangeTotal(1048577);
+  device.boot(enableProgress);
+  device.runFor(60000);
+  server.deploy("device1", 1048576);
+  device.runFor(600000);
+  CHECK(server.isClosed("device1"));
+  CHECK(server.getLastFeedback("device1").finished == "failure");
+  CHECK_EQUAL(1, server.getStats().downloads);
+  CHECK(!device.flash.isFinished());
+}
+
+/* Make the image path of the device a non-empty directory, so opening the
+   image fails and abort() cannot remove it */
+static void blockImage(TestDevice &device) {
+  std::string path = device.directory.file("image.bin");
+  unlink(path.c_str());
+  CHECK_EQUAL(0, mkdir(path.c_str(), 0700));
+  CHECK_EQUAL(0, mkdir((path + "/blocked").c_str(), 0700));
+}
+
+static void unblockImage(TestDevice &device) {
+  std::string path = device.directory.file("image.bin");
+  rmdir((path + "/blocked").c_str());
+  rmdir(path.c_str());
+}
+
+static void testFlashBeginFails() {
+  DdiServer server;
+  CHECK(server.start());
+  TestDevice device(server, "device1");
+  device.boot();
+  device.runFor(60000);
+  blockImage(device);
+  server.deploy("device1", 262144);
+  device.runFor(600000);
+  CHECK(server.isClosed("device1"));
+  CHECK(server.getLastFeedback("device1").finished == "failure");
+  CHECK_EQUAL(0, server.getStats().downloads);
+  CHECK(!device.flash.isFinished());
+  unblockImage(device);
+}
+
+/* The server ignores the range of the retry, the image cannot be opened
+   again for the download from the start */
+static void testFlashRestartFails() {
+  DdiServer server;
+  CHECK(server.start());
+  TestDevice device(server, "device1");
+  server.setSeed(3);
+  server.setDownloadCuts(1);
+  server.setRangeSupport(false);
+  device.boot();
+  device.runFor(60000);
+  server.deploy("device1", 1048576);
+  CHECK(device.runFor(600000, downloading));
+  blockImage(device);
+  device.runFor(600000);
+  CHECK(server.isClosed("device1"));
+  CHECK(server.getLastFeedback("device1").finished == "failure");
+  CHECK_EQUAL(2, server.getStats().downloads);
+  CHECK(!device.flash.isFinished());
+  unblockImage(device);
+}
+
+int main() {
+  testRandomCuts(true);
+  testRandomCuts(false);
+  testCutAndReboot();
+  testWrongRangeTotal();
+  testFlashBeginFails();
+  testFlashRestartFails();
+  return testResult();
+}
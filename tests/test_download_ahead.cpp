@@ -0,0 +1,177 @@
+/**
+
+   @file test_download_ahead.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "HawkbitTest.h"
+
+/* Deployments downloaded ahead and installed on approval: state transitions,
+   polls while waiting and the time from the approval to the reboot */
+
+static bool downloaded(TestDevice &device) {
+  return device.ddi().isUpdateDownloaded();
+}
+
+static void enableDownloadAhead(HawkbitDdi &ddi) {
+  ddi.setDownloadAhead(true);
+}
+
+static bool hasFeedback(DdiServer &server, const char *execution) {
+  for (const DdiServer::Feedback &feedback : server.getFeedback()) {
+    if (feedback.execution == execution) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void testApproval() {
+  DdiServer server;
+  CHECK(server.start());
+  TestDevice device(server, "device1");
+  unsigned long approved;
+  server.deploy("device1", 100000, "attempt", "forced");
+  device.boot(enableDownloadAhead);
+  CHECK(device.runFor(600000, downloaded));
+  CHECK(hasFeedback(server, "downloaded"));
+  CHECK_EQUAL(0, device.platform.getRestarts());
+  /* Waiting for the approval only polls */
+  device.runFor(1000);
+  CHECK(device.ddi().getSleepTime() > 0);
+  server.resetStats();
+  device.runFor(3600000);
+  CHECK(device.ddi().isUpdateDownloaded());
+  CHECK(server.getStats().polls >= 10 && server.getStats().polls <= 13);
+  CHECK_EQUAL(0, server.getStats().downloads);
+  CHECK_EQUAL(0, server.getStats().feedback);
+  /* The approved update is installed right away */
+  device.ddi().installUpdate();
+  CHECK_EQUAL(0, device.ddi().getSleepTime());
+  approved = device.platform.millis();
+  CHECK(device.runUntilRestart(600000));
+  CHECK(device.platform.millis() - approved < 1000);
+  CHECK(server.isClosed("device1"));
+  CHECK(server.getLastFeedback("device1").finished == "success");
+  CHECK(readImage(device) == server.getArtifact("device1"));
+}
+
+static void testForcedLater() {
+  DdiServer server;
+  CHECK(server.start());
+  TestDevice device(server, "device1");
+  unsigned long forced;
+  server.deploy("device1", 100000, "attempt", "forced");
+  device.boot(enableDownloadAhead);
+  CHECK(device.runFor(600000, downloaded));
+  server.resetStats();
+  server.setUpdateMode("device1", "forced");
+  forced = device.platform.millis();
+  /* Installed at the next poll without downloading again */
+  CHECK(device.runUntilRestart(3600000));
+  /* The longest poll interval the scheduler makes from the server's five
+     minutes, plus the real time the requests take under load */
+  CHECK(device.platform.millis() - forced <= 300000UL * (100 + HB_POLL_JITTER_PERCENT) / 100 + 10000);
+  CHECK_EQUAL(0, server.getStats().downloads);
+  CHECK(readImage(device) == server.getArtifact("device1"));
+}
+
+static void testReplaced() {
+  DdiServer server;
+  CHECK(server.start());
+  TestDevice device(server, "device1");
+  int actionId;
+  server.deploy("device1", 100000, "attempt", "forced");
+  device.boot(enableDownloadAhead);
+  CHECK(device.runFor(600000, downloaded));
+  /* A new action with another artifact replaces the downloaded one */
+  actionId = server.deploy("device1", 80000, "attempt", "forced");
+  server.resetStats();
+  device.runFor(600000);
+  CHECK_EQUAL(1, server.getStats().downloads);
+  CHECK(device.ddi().isUpdateDownloaded());
+  device.ddi().installUpdate();
+  CHECK(device.runUntilRestart(600000));
+  CHECK_EQUAL(actionId, server.getLastFeedback("device1").actionId);
+  CHECK(readImage(device) == server.getArtifact("device1"));
+}
+
+static TestDirectory gatewayDirectory;
+static HawkbitFileFlashSink sinkA(gatewayDirectory.file("a.bin").c_str());
+static HawkbitFileFlashSink sinkB(gatewayDirectory.file("b.bin").c_str());
+static t_hb_controller controllers[2];
+
+static void enableGateway(HawkbitDdi &ddi) {
+  memset((void *)controllers, 0, sizeof(controllers));
+  controllers[0].controllerId = "deviceA";
+  controllers[0].sink = &sinkA;
+  controllers[1].controllerId = "deviceB";
+  controllers[1].sink = &sinkB;
+  ddi.setGateway(controllers, 2);
+  ddi.setDownloadAhead(true);
+}
+
+static std::vector<uint8_t> readFile(const std::string &path) {
+  std::vector<uint8_t> data;
+  FILE *file = fopen(path.c_str(), "rb");
+  int c;
+  while (file != NULL && (c = fgetc(file)) != EOF) {
+    data.push_back((uint8_t)c);
+  }
+  if (file != NULL) {
+    fclose(file);
+  }
+  return data;
+}
+
+static void testGateway() {
+  DdiServer server;
+  CHECK(server.start());
+  TestDevice device(server, "gateway");
+  server.deploy("deviceA", 100000, "attempt", "forced");
+  device.boot(enableGateway);
+  CHECK(device.runFor(600000, downloaded));
+  /* The other controller is still polled, its action waits */
+  server.deploy("deviceB", 50000, "forced", "forced");
+  server.resetStats();
+  device.runFor(1800000);
+  CHECK(device.ddi().isUpdateDownloaded());
+  CHECK(server.getStats().polls >= 10);
+  CHECK_EQUAL(0, server.getStats().downloads);
+  CHECK(!server.isClosed("deviceB"));
+  device.ddi().installUpdate();
+  device.runFor(1800000);
+  CHECK(server.isClosed("deviceA"));
+  CHECK(server.getLastFeedback("deviceA").finished == "success");
+  CHECK(readFile(gatewayDirectory.file("a.bin")) == server.getArtifact("deviceA"));
+  CHECK(server.isClosed("deviceB"));
+  CHECK(server.getLastFeedback("deviceB").finished == "success");
+  CHECK(readFile(gatewayDirectory.file("b.bin")) == server.getArtifact("deviceB"));
+}
+
+int main() {
+  testApproval();
+  testForcedLater();
+  testReplaced();
+  testGateway();
+  return testResult();
+}
@@ -0,0 +1,231 @@
+/**
+
+   @file test_feedback.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include <map>
+#include "HawkbitTest.h"
+
+/* Delivery of the queued feedback to a server that loses or rejects it */
+
+/* Storage in memory that counts the writes */
+class MemoryStorage : public HawkbitStorage
+{
+  public:
+    unsigned long writes = 0;
+
+    size_t load(const char *key, void *data, size_t len) override {
+      std::map<std::string, std::string>::iterator value = this->_values.find(key);
+      if (value == this->_values.end()) {
+        return 0;
+      }
+      len = std::min(len, value->second.size());
+      memcpy(data, value->second.data(), len);
+      return len;
+    }
+
+    bool save(const char *key, const void *data, size_t len) override {
+      this->writes++;
+      this->_values[key].assign((const char *)data, len);
+      return true;
+    }
+
+    void remove(const char *key) override {
+      this->writes++;
+      this->_values.erase(key);
+    }
+
+  private:
+    std::map<std::string, std::string> _values;
+};
+
+static void testQueue() {
+  MemoryStorage storage;
+  HawkbitFeedbackQueue queue;
+  HawkbitFeedbackQueue restored;
+  queue.begin(&storage);
+  /* Newer actions that overflow the queue do not evict the final result */
+  queue.push(1, HB_EX_CLOSED, HB_RES_SUCCESS, 0, 0, 0, true);
+  for (int actionId = 2; actionId < 2 + 2 * HB_FEEDBACK_QUEUE_SIZE; actionId++) {
+    queue.push(actionId, HB_EX_PROCEEDING, HB_RES_NONE);
+  }
+  CHECK(queue.contains(1));
+  CHECK_EQUAL(1, queue.peek()->actionId);
+  queue.pop();
+  /* The progress reports of a download are not written to storage */
+  storage.writes = 0;
+  for (uint32_t bytes = 1000; bytes <= 100000; bytes += 1000) {
+    queue.push(100, HB_EX_PROCEEDING, HB_RES_NONE, bytes, 100000);
+  }
+  CHECK(queue.contains(100));
+  CHECK_EQUAL(0, storage.writes);
+  restored.begin(&storage);
+  CHECK(!restored.contains(1));
+  CHECK(!restored.contains(100));
+  CHECK(restored.contains(2 + 2 * HB_FEEDBACK_QUEUE_SIZE - 1));
+  /* A rejected final result is given up after its attempts, other feedback
+     at once */
+  queue.push(200, HB_EX_CLOSED, HB_RES_FAILURE, 0, 0, 0, true);
+  while (queue.peek()->actionId != 200) {
+    CHECK(!queue.retry());
+    queue.pop();
+  }
+  for (int i = 1; i < HB_FEEDBACK_FINAL_ATTEMPTS; i++) {
+    CHECK(queue.retry());
+  }
+  CHECK(!queue.retry());
+}
+
+static void testRejected() {
+  DdiServer server;
+  CHECK(server.start());
+  TestDevice device(server, "device1");
+  /* E.g. the action was deleted on the server meanwhile */
+  server.setFeedbackLoss(1.0, 404);
+  server.deploy("device1", 50000);
+  device.boot();
+  CHECK(device.runUntilRestart(2 * 3600000));
+  /* Each feedback is posted once and then dropped, the final one only after
+     its attempts */
+  CHECK(server.getStats().feedback >= HB_FEEDBACK_FINAL_ATTEMPTS);
+  CHECK(server.getStats().feedback <= 2 + HB_FEEDBACK_FINAL_ATTEMPTS);
+  CHECK_EQUAL(server.getStats().feedback, server.getStats().feedbackLost);
+  CHECK(readImage(device) == server.getArtifact("device1"));
+}
+
+/* The restart waits until the server accepts the final result */
+static void testFinalHeld() {
+  DdiServer server;
+  CHECK(server.start());
+  TestDevice device(server, "device1");
+  server.setFeedbackLoss(1.0, 404);
+  server.deploy("device1", 50000);
+  device.boot();
+  device.runFor(HB_POLL_STARTUP_JITTER + 600000);
+  CHECK_EQUAL(0, device.platform.getRestarts());
+  CHECK(!server.isClosed("device1"));
+  server.setFeedbackLoss(0);
+  CHECK(device.runUntilRestart(3600000));
+  CHECK(server.isClosed("device1"));
+  CHECK(server.getLastFeedback("device1").finished == "success");
+}
+
+static void testLossy(int status) {
+  DdiServer server;
+  char values[96];
+  CHECK(server.start());
+  TestDevice device(server, "device1");
+  server.setSeed(7);
+  server.setFeedbackLoss(0.7, status);
+  server.deploy("device1", 50000);
+  device.boot();
+  CHECK(device.runUntilRestart(86400000));
+  CHECK(server.getStats().feedbackLost > 0);
+  /* The closing feedback is retried until it arrives */
+  CHECK(server.isClosed("device1"));
+  CHECK(server.getLastFeedback("device1").finished == "success");
+  CHECK(readImage(device) == server.getArtifact("device1"));
+  snprintf(values, sizeof(values), "\"status\":%d,\"feedback\":%lu,\"feedbackLost\":%lu", status,
+           server.getStats().feedback, server.getStats().feedbackLost);
+  printResult("feedback_lossy", values);
+}
+
+static bool downloaded(TestDevice &device) {
+  return device.ddi().isUpdateDownloaded();
+}
+
+static void enableDownloadAhead(HawkbitDdi &ddi) {
+  ddi.setDownloadAhead(true);
+}
+
+static void testCancelWithoutStopId() {
+  DdiServer server;
+  CHECK(server.start());
+  TestDevice device(server, "device1");
+  server.setCancelStopId(false);
+  server.deploy("device1", 50000, "attempt", "forced");
+  device.boot(enableDownloadAhead);
+  CHECK(device.runFor(3600000, downloaded));
+  server.cancel("device1");
+  /* The cancel cannot be matched to the action, the image is kept */
+  device.runFor(3600000);
+  CHECK(server.getStats().cancelAction > 0);
+  CHECK(device.ddi().isUpdateDownloaded());
+  for (const DdiServer::Feedback &feedback : server.getFeedback()) {
+    CHECK_EQUAL(1, feedback.actionId);
+  }
+}
+
+static void enableProgress(HawkbitDdi &ddi) {
+  ddi.setProgressFeedback(true);
+}
+
+static void enableProgressKeepAlive(HawkbitDdi &ddi) {
+  ddi.setProgressFeedback(true);
+  ddi.setKeepAlive(true);
+}
+
+/* The download is split where progress reports are due, at 256 KB/s into
+   2.5 MB segments after the first one. Without keep-alive each request opens
+   its own connection */
+static void testProgress(bool keepAlive) {
+  DdiServer server;
+  std::vector<DdiServer::Feedback> feedback;
+  int progress = 0;
+  CHECK(server.start());
+  TestDevice device(server, "device1");
+  server.setRateLimit(262144);
+  device.boot(keepAlive ? enableProgressKeepAlive : enableProgress);
+  device.runFor(60000);
+  server.deploy("device1", 3 * 1048576);
+  server.resetStats();
+  CHECK(device.runUntilRestart(600000));
+  CHECK(readImage(device) == server.getArtifact("device1"));
+  feedback = server.getFeedback();
+  for (size_t i = 0; i < feedback.size(); i++) {
+    if (feedback[i].execution == "proceeding" && feedback[i].progress > 0) {
+      progress++;
+    }
+  }
+  CHECK_EQUAL(3, server.getStats().downloads);
+  CHECK_EQUAL(2, progress);
+  if (keepAlive) {
+    CHECK(server.getStats().connections < server.getStats().requests);
+  } else {
+    CHECK_EQUAL(server.getStats().requests, server.getStats().connections);
+  }
+}
+
+int main() {
+  testQueue();
+  testRejected();
+  testFinalHeld();
+  testLossy(503);
+  testLossy(429);
+  /* Connection closed without a response */
+  testLossy(0);
+  testCancelWithoutStopId();
+  testProgress(true);
+  testProgress(false);
+  return testResult();
+}
@@ -0,0 +1,169 @@
+/**
+
+   @file test_gateway.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include <algorithm>
+#include "HawkbitTest.h"
+
+/* A gateway serving many controllers: conditional polls and config data per
+   controller, and the memory it takes, printed as JSON */
+
+#define CONTROLLERS 300
+
+static std::vector<std::string> controllerIds;
+static t_hb_controller controllers[CONTROLLERS];
+static size_t controllerCount;
+static char configData[] = "{\"hwRevision\":\"2\",\"site\":\"hall 3\"}";
+
+static void enableGateway(HawkbitDdi &ddi) {
+  memset((void *)controllers, 0, sizeof(controllers));
+  for (size_t i = 0; i < controllerCount; i++) {
+    controllers[i].controllerId = controllerIds[i].c_str();
+  }
+  ddi.setGateway(controllers, controllerCount);
+  ddi.setConfigData(configData);
+}
+
+static void enableGatewayKeepAlive(HawkbitDdi &ddi) {
+  enableGateway(ddi);
+  ddi.setKeepAlive(true);
+}
+
+static void enableGatewayAhead(HawkbitDdi &ddi) {
+  enableGateway(ddi);
+  ddi.setDownloadAhead(true);
+}
+
+static void testManyControllers() {
+  DdiServer server;
+  CHECK(server.start());
+  TestDevice device(server, "gateway");
+  HeapStats heap;
+  DdiServer::Stats stats;
+  char values[256];
+  controllerCount = CONTROLLERS;
+  server.setConfigDataRequested(true);
+  device.boot(enableGateway);
+  /* Steady state, the first connection also loads the resolver of libc */
+  heapTrackingStart();
+  device.runFor(3600000);
+  heap = heapTrackingStop();
+  stats = server.getStats();
+  /* Each controller is polled every 5 minutes, only the first poll and the
+     config data are sent in full */
+  CHECK(stats.polls >= 11 * CONTROLLERS);
+  CHECK(stats.notModified >= stats.polls - CONTROLLERS);
+  CHECK_EQUAL(CONTROLLERS, stats.configData);
+  snprintf(values, sizeof(values),
+           "\"controllers\":%d,\"controllerBytes\":%zu,\"ddiBytes\":%zu,\"allocations\":%lu,\"peakHeap\":%ld,"
+           "\"polls\":%lu,\"notModified\":%lu,\"configData\":%lu,\"bytesIn\":%lu,\"bytesOut\":%lu",
+           CONTROLLERS, sizeof(controllers), sizeof(HawkbitDdi), heap.allocations, heap.peak, stats.polls,
+           stats.notModified, stats.configData, stats.bytesIn, stats.bytesOut);
+  printResult("gateway_hour", values);
+  /* A deployment for one of them is noticed despite the cached validators */
+  server.deploy(controllerIds[150], 20000);
+  device.runFor(600000);
+  CHECK(server.isClosed(controllerIds[150]));
+  CHECK(server.getLastFeedback(controllerIds[150]).finished == "success");
+}
+
+static bool downloaded(TestDevice &device) {
+  return device.ddi().isUpdateDownloaded();
+}
+
+static void testLinksOfWaitingAction() {
+  DdiServer server;
+  CHECK(server.start());
+  TestDevice device(server, "gateway");
+  controllerCount = 2;
+  server.deploy(controllerIds[0], 20000, "attempt", "forced");
+  device.boot(enableGatewayAhead);
+  CHECK(device.runFor(600000, downloaded));
+  server.resetStats();
+  device.runFor(1800000);
+  /* The other controller uses its validators, the one with the action needs
+     the links and fetches the whole resource */
+  CHECK(server.getStats().notModified > 0);
+  CHECK(server.getStats().notModified < server.getStats().polls);
+  CHECK(device.ddi().isUpdateDownloaded());
+  server.setUpdateMode(controllerIds[0], "forced");
+  device.runFor(1800000);
+  CHECK(server.isClosed(controllerIds[0]));
+  CHECK(server.getLastFeedback(controllerIds[0]).finished == "success");
+  CHECK(readImage(device) == server.getArtifact(controllerIds[0]));
+}
+
+static void testSharedConnection() {
+  DdiServer server;
+  CHECK(server.start());
+  TestDevice device(server, "gateway");
+  DdiServer::Stats stats;
+  char values[128];
+  controllerCount = 50;
+  device.boot(enableGatewayKeepAlive);
+  device.runFor(3600000);
+  stats = server.getStats();
+  /* All controllers are polled in one go over one connection, about twelve
+     rounds an hour */
+  CHECK(stats.polls >= 11 * controllerCount);
+  CHECK(stats.connections <= 16);
+  snprintf(values, sizeof(values), "\"controllers\":%zu,\"polls\":%lu,\"connections\":%lu",
+           controllerCount, stats.polls, stats.connections);
+  printResult("gateway_keepalive", values);
+}
+
+static void testConfigDataForEveryController() {
+  DdiServer server;
+  CHECK(server.start());
+  TestDevice device(server, "gateway");
+  std::vector<std::string> received;
+  controllerCount = 20;
+  /* Not asked for by the server, sent once to each controller */
+  device.boot(enableGateway);
+  device.runFor(HB_POLL_STARTUP_JITTER + 60000);
+  received = server.getConfigDataControllers();
+  std::sort(received.begin(), received.end());
+  CHECK_EQUAL(controllerCount, received.size());
+  for (size_t i = 0; i < received.size() && i < controllerCount; i++) {
+    CHECK(received[i] == controllerIds[i]);
+  }
+  /* A change goes to all of them again */
+  server.resetStats();
+  device.ddi().setConfigData((char *)"{\"hwRevision\":\"3\"}");
+  device.runFor(60000);
+  CHECK_EQUAL(controllerCount, server.getConfigDataControllers().size());
+}
+
+int main() {
+  char id[16];
+  for (int i = 0; i < CONTROLLERS; i++) {
+    snprintf(id, sizeof(id), "device%03d", i);
+    controllerIds.push_back(id);
+  }
+  testManyControllers();
+  testLinksOfWaitingAction();
+  testSharedConnection();
+  testConfigDataForEveryController();
+  return testResult();
+}
@@ -0,0 +1,80 @@
+/**
+
+   @file test_host.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "HawkbitTest.h"
+
+/* Smoke test of the host build: a forced deployment over plain HTTP and a
+   poll over TLS against the stand-in server */
+
+static void testStorage() {
+  TestDirectory directory;
+  HawkbitFileStorage storage(directory.file("storage").c_str());
+  uint32_t value = 0x12345678;
+  uint32_t loaded = 0;
+  CHECK(storage.save("key", &value, sizeof(value)));
+  CHECK_EQUAL(sizeof(loaded), storage.load("key", &loaded, sizeof(loaded)));
+  CHECK_EQUAL(value, loaded);
+  CHECK_EQUAL(0, storage.load("key", &loaded, 2));
+  storage.remove("key");
+  CHECK_EQUAL(0, storage.load("key", &loaded, sizeof(loaded)));
+}
+
+static void testForcedDeployment() {
+  DdiServer server;
+  CHECK(server.start());
+  TestDevice device(server, "device1");
+  server.deploy("device1", 200000);
+  device.boot();
+  CHECK(device.runUntilRestart(120000));
+  CHECK_EQUAL(1, device.platform.getRestarts());
+  CHECK(readImage(device) == server.getArtifact("device1"));
+  CHECK_EQUAL(200000, device.flash.getImageSize());
+  CHECK(server.isClosed("device1"));
+  CHECK(server.getLastFeedback("device1").finished == "success");
+  /* After the reboot the device only polls */
+  device.reboot();
+  server.resetStats();
+  device.runFor(HB_POLL_STARTUP_JITTER + 60000);
+  CHECK_EQUAL(0, device.platform.getRestarts() - 1);
+  CHECK_EQUAL(0, server.getStats().downloads);
+  CHECK(server.getStats().polls > 0);
+}
+
+static void testTls() {
+  DdiServer server;
+  CHECK(server.start(true));
+  TestDevice device(server, "device1");
+  device.boot();
+  device.runFor(HB_POLL_STARTUP_JITTER + 1000);
+  CHECK(server.getStats().tlsHandshakes > 0);
+  CHECK(server.getStats().polls > 0);
+}
+
+int main() {
+  testStorage();
+  testForcedDeployment();
+  testTls();
+  return testResult();
+}
@@ -0,0 +1,131 @@
+/**
+
+   @file test_keepalive.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "HawkbitTest.h"
+
+/* Keep-alive against servers that end connections: Connection: close,
+   Keep-Alive: max and kept-alive connections closed while a request is on its
+   way. The connections and requests of one deployment are counted */
+
+static void enableKeepAlive(HawkbitDdi &ddi) {
+  ddi.setKeepAlive(true);
+}
+
+static unsigned long failedRequests(TestDevice &device) {
+  unsigned long failures = 0;
+  for (int i = HB_REQ_POLL; i < HB_REQ_MAX; i++) {
+    failures += device.ddi().getStats().requests[i].failures;
+  }
+  return failures;
+}
+
+/* One deployment of an idle device from the poll to the restart */
+static DdiServer::Stats deployment(DdiServer &server, TestDevice &device) {
+  device.boot(enableKeepAlive);
+  device.runFor(HB_POLL_STARTUP_JITTER + 60000);
+  server.deploy(device.controllerId, 100000);
+  server.resetStats();
+  CHECK(device.runUntilRestart(600000));
+  CHECK(server.getLastFeedback(device.controllerId).finished == "success");
+  CHECK(readImage(device) == server.getArtifact(device.controllerId));
+  CHECK_EQUAL(0, failedRequests(device));
+  return server.getStats();
+}
+
+static void testReused() {
+  DdiServer server;
+  DdiServer::Stats stats;
+  CHECK(server.start());
+  TestDevice device(server, "device1");
+  stats = deployment(server, device);
+  CHECK(stats.requests >= 4);
+  CHECK_EQUAL(1, stats.connections);
+}
+
+/* The client opens a new connection for each request */
+static void testConnectionClose() {
+  DdiServer server;
+  DdiServer::Stats stats;
+  CHECK(server.start());
+  TestDevice device(server, "device1");
+  server.setKeepAlive(false);
+  stats = deployment(server, device);
+  CHECK(stats.requests >= 4);
+  CHECK_EQUAL(stats.requests, stats.connections);
+}
+
+/* max=1 announces the last request the server takes, so the client does not
+   send another one on the connection */
+static void testKeepAliveMax() {
+  DdiServer server;
+  DdiServer::Stats stats;
+  CHECK(server.start());
+  TestDevice device(server, "device1");
+  server.setKeepAliveMax(2);
+  stats = deployment(server, device);
+  CHECK_EQUAL(stats.requests, stats.connections);
+  /* With max=2 after the first request, the second one ends it */
+  server.setKeepAliveMax(3);
+  stats = deployment(server, device);
+  CHECK(stats.requests >= 4);
+  CHECK_EQUAL((stats.requests + 1) / 2, stats.connections);
+  CHECK_EQUAL(0, stats.requestsDropped);
+}
+
+/* The server closes the kept-alive connection once as the next request
+   arrives, the request is sent again on a new connection */
+static void testReusedClosedOnce() {
+  DdiServer server;
+  DdiServer::Stats stats;
+  CHECK(server.start());
+  TestDevice device(server, "device1");
+  server.setDropReused(1);
+  stats = deployment(server, device);
+  CHECK_EQUAL(1, stats.requestsDropped);
+  CHECK_EQUAL(2, stats.connections);
+}
+
+/* Every reused connection is closed, each request is retried exactly once
+   and succeeds on the new connection */
+static void testReusedClosedAlways() {
+  DdiServer server;
+  DdiServer::Stats stats;
+  CHECK(server.start());
+  TestDevice device(server, "device1");
+  server.setDropReused((unsigned long)-1);
+  stats = deployment(server, device);
+  CHECK(stats.requestsDropped >= 3);
+  CHECK_EQUAL(stats.requestsDropped + 1, stats.connections);
+  CHECK_EQUAL(2 * stats.requestsDropped + 1, stats.requests);
+}
+
+int main() {
+  testReused();
+  testConnectionClose();
+  testKeepAliveMax();
+  testReusedClosedOnce();
+  testReusedClosedAlways();
+  return testResult();
+}
@@ -0,0 +1,151 @@
+/**
+
+   @file test_links.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include <HawkbitLinks.h>
+#include <map>
+#include <random>
+#include "HawkbitTest.h"
+
+/* HawkbitLinkStore against a map of strings, and the footprint of the links
+   on this host: the size of the store and of HawkbitDdi and the heap of a
+   deployment. The four href buffers it replaced took 2560 bytes */
+
+static const size_t OLD_LINK_BUFFERS = 512 + 512 + 512 + 1024;
+
+static std::string base(const std::string &controllerId) {
+  return "https://device.eu-central.bosch-iot-rollouts.com/0d1c3f0e-27a4-4d8e-9c4a-12a3b4c5d6e7/controller/v1/" + controllerId;
+}
+
+static std::string link(HawkbitLinkStore &store, HB_LINK link) {
+  char buffer[HB_LINK_STORE_SIZE + 1];
+  store.copy(link, buffer, sizeof(buffer));
+  return buffer;
+}
+
+static void testTypical() {
+  HawkbitLinkStore store;
+  std::string controller = base("esp32-30aea4123456");
+  std::string hrefs[HB_LINK_MAX] = {
+    controller + "/configData",
+    controller + "/deploymentBase/1742?c=-2129030598",
+    controller + "/cancelAction/1743",
+    "https://cdn.eu-central.bosch-iot-rollouts.com/0d1c3f0e-27a4-4d8e-9c4a-12a3b4c5d6e7/controller/v1/esp32-30aea4123456/softwaremodules/912/artifacts/firmware-1.4.2.bin",
+  };
+  char values[256];
+  size_t total = 0;
+  HeapStats heap;
+  char buffer[HB_LINK_STORE_SIZE + 1];
+  heapTrackingStart();
+  for (int i = 0; i < HB_LINK_MAX; i++) {
+    CHECK(store.set((HB_LINK)i, hrefs[i].c_str()));
+    CHECK_EQUAL(hrefs[i].length(), store.copy((HB_LINK)i, buffer, sizeof(buffer)));
+    total += hrefs[i].length();
+  }
+  heap = heapTrackingStop();
+  CHECK_EQUAL(0, heap.allocations);
+  for (int i = 0; i < HB_LINK_MAX; i++) {
+    CHECK(link(store, (HB_LINK)i) == hrefs[i]);
+  }
+  CHECK(store.getUsed() < total * 2 / 3);
+  snprintf(values, sizeof(values), "\"linkBytes\":%zu,\"storeUsed\":%zu,\"storeSize\":%d,\"sizeofStore\":%zu,\"oldBuffers\":%zu",
+           total, store.getUsed(), HB_LINK_STORE_SIZE, sizeof(HawkbitLinkStore), OLD_LINK_BUFFERS);
+  printResult("links_typical", values);
+
+  /* A link that does not fit leaves the others alone */
+  CHECK(!store.set(HB_LINK_DOWNLOAD, std::string(HB_LINK_STORE_SIZE, 'x').c_str()));
+  CHECK(!store.isSet(HB_LINK_DOWNLOAD));
+  CHECK(link(store, HB_LINK_DEPLOYMENTBASE) == hrefs[HB_LINK_DEPLOYMENTBASE]);
+  CHECK(link(store, HB_LINK_CONFIGDATA) == hrefs[HB_LINK_CONFIGDATA]);
+  /* A buffer that is too small gets an empty string */
+  char small[16] = "x";
+  CHECK_EQUAL(0, store.copy(HB_LINK_CONFIGDATA, small, sizeof(small)));
+  CHECK_EQUAL(0, small[0]);
+  for (int i = 0; i < HB_LINK_MAX; i++) {
+    store.clear((HB_LINK)i);
+  }
+  CHECK_EQUAL(0, store.getUsed());
+}
+
+/* Random sets and clears, compared with a map after each step */
+static void testRandom() {
+  std::mt19937 random(17);
+  std::map<int, std::string> expected;
+  HawkbitLinkStore store;
+  const char *suffixes[] = { "/configData", "/deploymentBase/", "/cancelAction/", "/softwaremodules/" };
+  for (int step = 0; step < 20000; step++) {
+    int i = random() % HB_LINK_MAX;
+    if (random() % 3 == 0) {
+      store.clear((HB_LINK)i);
+      expected.erase(i);
+    } else {
+      std::string href = base(random() % 8 == 0 ? "other" : "device") + suffixes[i] + std::to_string(random() % 100000);
+      href += std::string(random() % 200, 'a' + i);
+      if (store.set((HB_LINK)i, href.c_str())) {
+        expected[i] = href;
+      } else {
+        expected.erase(i);
+      }
+    }
+    for (int j = 0; j < HB_LINK_MAX; j++) {
+      std::string want = expected.count(j) ? expected[j] : "";
+      if (!CHECK(link(store, (HB_LINK)j) == want)) {
+        return;
+      }
+      CHECK(store.isSet((HB_LINK)j) == !want.empty());
+    }
+    CHECK(store.getUsed() <= HB_LINK_STORE_SIZE);
+  }
+}
+
+/* The whole client on this host, the server sends links of about 70 bytes */
+static void testDeployment() {
+  DdiServer server;
+  char values[256];
+  HeapStats heap;
+  CHECK(server.start());
+  TestDevice device(server, "device1");
+  device.boot();
+  device.runFor(60000);
+  server.deploy("device1", 262144);
+  heapTrackingStart();
+  CHECK(device.runUntilRestart(1800000));
+  heap = heapTrackingStop();
+  CHECK(server.getLastFeedback("device1").finished == "success");
+  snprintf(values, sizeof(values), "\"sizeofDdi\":%zu,\"sizeofStore\":%zu,\"allocations\":%lu,\"peakHeap\":%ld",
+           sizeof(HawkbitDdi), sizeof(HawkbitLinkStore), heap.allocations, heap.peak);
+  printResult("links_deployment", values);
+  /* Limits on this host to notice growth, 4856 and 9504 bytes at the time */
+  CHECK(sizeof(HawkbitDdi) < 6144);
+  CHECK(heap.peak < 16384);
+}
+
+int main() {
+  CHECK(sizeof(HawkbitLinkStore) <= HB_LINK_STORE_SIZE + 32);
+  CHECK(sizeof(HawkbitLinkStore) < OLD_LINK_BUFFERS / 3);
+  testTypical();
+  testRandom();
+  testDeployment();
+  return testResult();
+}
@@ -0,0 +1,132 @@
+/**
+
+   @file test_sleep.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "HawkbitTest.h"
+#include <unistd.h>
+
+/* A day of deep sleep cycles on the simulated clock: every wake up is a new
+   HawkbitDdi resuming from the retained state. Prints the time awake, i.e.
+   with the radio on, and the traffic per day */
+
+static t_hb_retained_state retained;
+
+static void useRetainedState(HawkbitDdi &ddi) {
+  ddi.setRetainedState(&retained);
+}
+
+typedef struct {
+  unsigned long wakeUps;
+  unsigned long awakeMs;
+} t_day;
+
+/* Run until the device may sleep, then sleep. Returns the time awake */
+static unsigned long wakeCycle(TestDevice &device, bool wakeUp) {
+  unsigned long start = device.platform.millis();
+  unsigned long sleepTime = 0;
+  unsigned long awake;
+  double started = wallMs();
+  if (wakeUp) {
+    device.boot(useRetainedState);
+  }
+  while (wallMs() - started < 10000) {
+    device.ddi().work();
+    if (device.ddi().getWorkState() != HB_STATE_IDLE) {
+      usleep(200);
+      continue;
+    }
+    sleepTime = device.ddi().prepareSleep(&retained);
+    if (sleepTime > 0) {
+      break;
+    }
+    device.platform.advance(20);
+  }
+  CHECK(sleepTime > 0);
+  awake = device.platform.millis() - start;
+  device.platform.advance(sleepTime);
+  return awake;
+}
+
+static t_day simulateDay(DdiServer &server, TestDevice &device) {
+  t_day day = { 0, 0 };
+  unsigned long end;
+  retained = t_hb_retained_state();
+  device.boot(useRetainedState);
+  /* Power on, sleep until the first poll is done */
+  wakeCycle(device, false);
+  while (server.getStats().polls == 0) {
+    wakeCycle(device, true);
+  }
+  server.resetStats();
+  end = device.platform.millis() + 86400000UL;
+  while ((long)(end - device.platform.millis()) > 0) {
+    day.awakeMs += wakeCycle(device, true);
+    day.wakeUps++;
+  }
+  return day;
+}
+
+static void testDay(bool etag) {
+  DdiServer server;
+  CHECK(server.start());
+  server.setETag(etag);
+  server.setPollingSleep("00:15:00");
+  TestDevice device(server, "device1");
+  t_day day = simulateDay(server, device);
+  DdiServer::Stats stats = server.getStats();
+  char values[256];
+  /* One poll per wake up, each answered from the cached links */
+  CHECK(day.wakeUps >= 86 && day.wakeUps <= 96);
+  CHECK_EQUAL(day.wakeUps, stats.polls);
+  if (etag) {
+    CHECK_EQUAL(stats.polls, stats.notModified);
+  }
+  CHECK_EQUAL(0, stats.configData);
+  snprintf(values, sizeof(values), "\"etag\":%s,\"wakeUps\":%lu,\"awakeMs\":%lu,\"notModified\":%lu,\"bytesIn\":%lu,\"bytesOut\":%lu",
+           etag ? "true" : "false", day.wakeUps, day.awakeMs, stats.notModified, stats.bytesIn, stats.bytesOut);
+  printResult("sleep_day", values);
+}
+
+static void testDeploymentAfterWakeUp() {
+  DdiServer server;
+  CHECK(server.start());
+  TestDevice device(server, "device1");
+  retained = t_hb_retained_state();
+  device.boot(useRetainedState);
+  wakeCycle(device, false);
+  wakeCycle(device, true);
+  /* The changed resource is fetched again despite the cached validators */
+  server.deploy("device1", 20000);
+  device.boot(useRetainedState);
+  device.runFor(60000);
+  CHECK_EQUAL(1, device.platform.getRestarts());
+  CHECK(readImage(device) == server.getArtifact("device1"));
+}
+
+int main() {
+  testDay(true);
+  testDay(false);
+  testDeploymentAfterWakeUp();
+  return testResult();
+}
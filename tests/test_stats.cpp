@@ -0,0 +1,131 @@
+/**
+
+   @file test_stats.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include <string.h>
+#include "HawkbitTest.h"
+
+/* The statistics against what the server saw. Built as test_stats and, with
+   the library compiled at HB_STATS 0, as test_stats_off, which checks that
+   they are all zero. Both print the size of a HawkbitDdi and the CPU time
+   per poll, so the cost of the statistics can be compared */
+
+class StringPrint : public Print
+{
+  public:
+    size_t write(uint8_t data) override {
+      this->text += (char)data;
+      return 1;
+    }
+
+    std::string text;
+};
+
+static char configData[] = "{\"hwRevision\":\"2\"}";
+
+static void statsInConfigData(HawkbitDdi &ddi) {
+  ddi.setConfigData(configData);
+  ddi.setStatsInConfigData(true);
+}
+
+static void testRequests(DdiServer &server) {
+  DdiServer::Stats seen;
+  t_hb_stats stats;
+  unsigned long bytesOut = 0;
+  unsigned long bytesIn = 0;
+  unsigned long failures = 0;
+  StringPrint json;
+  TestDevice device(server, "device1");
+  server.resetStats();
+  server.setSeed(1);
+  server.setFeedbackLoss(0.5, 500);
+  device.boot(statsInConfigData);
+  device.runFor(1800000);
+  server.deploy("device1", 262144);
+  CHECK(device.runUntilRestart(1800000));
+  server.setFeedbackLoss(0);
+  CHECK(server.getLastFeedback("device1").finished == "success");
+  seen = server.getStats();
+  stats = device.ddi().getStats();
+  for (int i = HB_REQ_NONE + 1; i < HB_REQ_MAX; i++) {
+    bytesOut += stats.requests[i].bytesOut;
+    bytesIn += stats.requests[i].bytesIn;
+    failures += stats.requests[i].failures;
+  }
+  device.ddi().printStats(json);
+#if HB_STATS
+  CHECK_EQUAL(seen.polls, stats.requests[HB_REQ_POLL].count);
+  CHECK_EQUAL(seen.configData, stats.requests[HB_REQ_CONFIGDATA].count);
+  CHECK_EQUAL(seen.deploymentBase, stats.requests[HB_REQ_DEPLOYMENTBASE].count);
+  CHECK_EQUAL(seen.feedback, stats.requests[HB_REQ_FEEDBACK].count);
+  CHECK_EQUAL(seen.downloads, stats.requests[HB_REQ_DOWNLOAD].count);
+  CHECK_EQUAL(seen.feedbackLost, failures);
+  CHECK(failures > 0);
+  CHECK_EQUAL(seen.bytesIn, bytesOut);
+  CHECK_EQUAL(seen.bytesOut, bytesIn);
+  CHECK_EQUAL(262144, stats.downloadBytes);
+  CHECK(stats.requests[HB_REQ_DOWNLOAD].bytesIn > stats.downloadBytes);
+  CHECK(server.getConfigData().back().find("\"hbRequests\":") != std::string::npos);
+  CHECK(json.text.find("\"downloadBytes\":262144,") != std::string::npos);
+  device.ddi().resetStats();
+  CHECK_EQUAL(0, device.ddi().getStats().requests[HB_REQ_POLL].count);
+#else
+  t_hb_stats none;
+  memset(&none, 0, sizeof(none));
+  CHECK(memcmp(&stats, &none, sizeof(stats)) == 0);
+  CHECK(server.getConfigData().back().find("\"hbRequests\":") == std::string::npos);
+  CHECK(json.text.find("\"downloadBytes\":0,") != std::string::npos);
+#endif
+  CHECK(json.text.find("\"poll\":{\"count\":") != std::string::npos);
+}
+
+/* A day of polls, the work the statistics add to each request */
+static void benchPolls(DdiServer &server) {
+  char values[256];
+  double cpuStart;
+  unsigned long polls;
+  HeapStats heap;
+  TestDevice device(server, "device2");
+  device.boot();
+  device.runFor(600000);
+  server.resetStats();
+  cpuStart = cpuMs();
+  heapTrackingStart();
+  device.runFor(86400000);
+  heap = heapTrackingStop();
+  polls = server.getStats().polls;
+  CHECK(polls > 0);
+  snprintf(values, sizeof(values), "\"stats\":%d,\"sizeofDdi\":%zu,\"sizeofStats\":%zu,\"polls\":%lu,\"cpuUsPerPoll\":%.1f,\"allocations\":%lu",
+           HB_STATS, sizeof(HawkbitDdi), HB_STATS ? sizeof(t_hb_stats) : 0, polls,
+           (cpuMs() - cpuStart) * 1000.0 / (polls > 0 ? polls : 1), heap.allocations);
+  printResult("stats", values);
+}
+
+int main() {
+  DdiServer server;
+  CHECK(server.start());
+  testRequests(server);
+  benchPolls(server);
+  return testResult();
+}
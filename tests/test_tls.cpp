@@ -0,0 +1,99 @@
+/**
+
+   @file test_tls.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "HawkbitTest.h"
+
+/* TLS session resumption of the host transport with the session cache of
+   HawkbitDdi, against the stand-in server with a self-signed CA */
+
+static void testCache() {
+  HawkbitSessionCache cache;
+  const uint8_t *data;
+  size_t len;
+  uint8_t session[3] = { 1, 2, 3 };
+  std::string longName(200, 'h');
+  longName += ".example.com";
+  /* Host names of any length are cached */
+  cache.store(longName.c_str(), 443, session, sizeof(session));
+  CHECK(cache.lookup(longName.c_str(), 443, &data, &len));
+  CHECK_EQUAL(sizeof(session), len);
+  CHECK(!cache.lookup(longName.c_str(), 8443, &data, &len));
+  longName[10] = 'x';
+  CHECK(!cache.lookup(longName.c_str(), 443, &data, &len));
+  /* The least recently used host is replaced */
+  cache.store("a.example.com", 443, session, sizeof(session));
+  CHECK(cache.lookup("a.example.com", 443, &data, &len));
+  cache.store("b.example.com", 443, session, sizeof(session));
+  CHECK(cache.lookup("a.example.com", 443, &data, &len));
+  CHECK(cache.lookup("b.example.com", 443, &data, &len));
+  cache.invalidate("a.example.com", 443);
+  CHECK(!cache.lookup("a.example.com", 443, &data, &len));
+}
+
+static void testResumption(int maxVersion) {
+  DdiServer server;
+  server.setMaxTlsVersion(maxVersion);
+  CHECK(server.start(true));
+  TestDevice device(server, "device1");
+  device.boot();
+  /* Twelve polls, each on a new connection */
+  device.runFor(3600000);
+  DdiServer::Stats stats = server.getStats();
+  CHECK(stats.polls >= 12);
+  CHECK_EQUAL(stats.connections, stats.tlsHandshakes);
+  /* Only the first handshake is a full one */
+  CHECK_EQUAL(stats.tlsHandshakes - 1, stats.tlsResumed);
+  CHECK_EQUAL(stats.tlsResumed, device.ddi().getTlsSessionHits());
+  CHECK_EQUAL(1, device.ddi().getTlsSessionMisses());
+  char values[128];
+  snprintf(values, sizeof(values), "\"version\":\"%s\",\"handshakes\":%lu,\"resumed\":%lu,\"connectMs\":%lu",
+           maxVersion == TLS1_2_VERSION ? "1.2" : "1.3", stats.tlsHandshakes, stats.tlsResumed,
+           device.ddi().getStats().requests[HB_REQ_POLL].connectTime);
+  printResult("tls_resumption", values);
+}
+
+static void testUntrusted() {
+  DdiServer server;
+  DdiServer other;
+  CHECK(server.start(true));
+  CHECK(other.start(true));
+  HawkbitLinuxTransport untrusted;
+  HawkbitLinuxTransport trusted;
+  /* A server certificate of another CA is refused */
+  untrusted.setCACert(other.getCACert().c_str());
+  CHECK(!untrusted.connect(server.getHost().c_str(), server.getPort()));
+  trusted.setCACert(server.getCACert().c_str());
+  CHECK(trusted.connect(server.getHost().c_str(), server.getPort()));
+  CHECK(trusted.connect("localhost", server.getPort()));
+  trusted.stop();
+}
+
+int main() {
+  testCache();
+  testResumption(TLS1_2_VERSION);
+  testResumption(TLS1_3_VERSION);
+  testUntrusted();
+  return testResult();
+}
@@ -0,0 +1,90 @@
+/**
+
+   @file test_work.cpp
+   @date 16.10.2026
+   @author Sven Ebenfeld
+
+   Copyright (c) 2019 Sven Ebenfeld. All rights reserved.
+   This file is part of the ESP32 Hawkbit Updater Arduino Library.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with this library; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "HawkbitTest.h"
+
+/* Longest single work() call while the server is slow to send the bodies
+   and during a download, printed as JSON */
+
+static void report(const char *scenario, TestDevice &device) {
+  char values[160];
+  snprintf(values, sizeof(values), "\"scenario\":\"%s\",\"maxWorkMs\":%.3f,\"workCalls\":%lu", scenario,
+           device.maxWorkTime, device.workCalls);
+  printResult("work_time", values);
+}
+
+static void testSlowPolls(bool etag) {
+  DdiServer server;
+  CHECK(server.start());
+  TestDevice device(server, "device1");
+  server.setETag(etag);
+  server.setBodyPause(300);
+  device.boot();
+  device.runFor(1800000);
+  CHECK(server.getStats().polls >= 6);
+  CHECK(device.ddi().getStats().requests[HB_REQ_POLL].failures == 0);
+  CHECK(device.maxWorkTime < 100);
+  report(etag ? "slow_poll_etag" : "slow_poll", device);
+}
+
+static void testSlowDeployment() {
+  DdiServer server;
+  CHECK(server.start());
+  TestDevice device(server, "device1");
+  server.setBodyPause(300);
+  server.deploy("device1", 1048576);
+  device.boot();
+  CHECK(device.runUntilRestart(600000));
+  CHECK(server.getLastFeedback("device1").finished == "success");
+  CHECK(readImage(device) == server.getArtifact("device1"));
+  /* The download is written in pieces within the work budget */
+  CHECK(device.maxWorkTime < 100);
+  report("slow_deployment", device);
+}
+
+static void testTruncatedBody() {
+  DdiServer server;
+  CHECK(server.start());
+  TestDevice device(server, "device1");
+  /* The pause exceeds the response timeout, the poll fails */
+  server.setBodyPause(HB_RESPONSE_TIMEOUT + 1000);
+  device.boot();
+  device.runFor(HB_POLL_STARTUP_JITTER + 20000);
+  /* Retried after the backoff, not parsed from the first part */
+  CHECK(server.getStats().polls >= 2);
+  CHECK_EQUAL(0, server.getStats().notModified);
+  CHECK(device.maxWorkTime < 100);
+  server.setBodyPause(0);
+  device.runFor(3600000);
+  CHECK(server.getStats().notModified > 0);
+}
+
+int main() {
+  testSlowPolls(true);
+  testSlowPolls(false);
+  testSlowDeployment();
+  testTruncatedBody();
+  return testResult();
+}